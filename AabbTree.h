@@ -0,0 +1,529 @@
+#pragma once
+
+#include "Frustum.h"
+#include "GameState.h"
+#include "MemoryTracker.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// --- Dynamic AABB tree ---
+// A bounding volume hierarchy over boxes that move, updated in place rather than rebuilt.
+// Leaves store fat bounds: the tight box grown by a margin and stretched along the last
+// displacement, so a proxy only leaves its leaf (remove plus reinsert) once it outruns
+// that slack. Insertion walks down by the surface-area cost of the enlarged parents, and
+// every node on the way back up is AVL-rotated when one child is two levels taller than
+// the other, which keeps the height logarithmic whatever order proxies arrive in.
+//
+// When nearly everything moves every frame there is also a batch path: setBounds() only
+// rewrites leaves, and one refit() pass recomputes every parent bottom-up. That never
+// changes the topology, so quality drifts until rebuild() builds it again top-down.
+class DynamicAabbTree {
+public:
+    static const int nullNode = -1;
+    static const int maxDepth = 64; // Query stack; AVL balance keeps 100k leaves under 30
+    static constexpr float predictionSteps = 4.0f; // Fat boxes reach this many displacements ahead
+
+    explicit DynamicAabbTree(float margin = 0.5f) : margin(margin) {}
+
+    void reserve(int proxies) { nodes.reserve((size_t)proxies * 2); }
+
+    int createProxy(const glm::vec3& lo, const glm::vec3& hi, int userData) {
+        int leaf = allocateNode();
+        Node& n = nodes[leaf];
+        n.lo = lo - glm::vec3(margin);
+        n.hi = hi + glm::vec3(margin);
+        n.userData = userData;
+        n.height = 0;
+        insertLeaf(leaf);
+        proxies++;
+        return leaf;
+    }
+
+    void destroyProxy(int proxy) {
+        removeLeaf(proxy);
+        freeNode(proxy);
+        proxies--;
+    }
+
+    // Returns true when the proxy had to be reinserted. The displacement since the last
+    // move stretches the fat box ahead of the proxy, so steady motion rarely reinserts.
+    bool moveProxy(int proxy, const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& displacement) {
+        Node& n = nodes[proxy];
+        if (contains(n.lo, n.hi, lo, hi)) {
+            // Still inside; only reinsert if the fat box has become far too large for it
+            glm::vec3 ahead = displacement * float(predictionSteps); // A copy: glm takes scalars by reference
+            glm::vec3 hugeLo = lo - glm::vec3(5.0f * margin) + glm::min(ahead, glm::vec3(0.0f));
+            glm::vec3 hugeHi = hi + glm::vec3(5.0f * margin) + glm::max(ahead, glm::vec3(0.0f));
+            if (contains(hugeLo, hugeHi, n.lo, n.hi)) return false;
+        }
+        removeLeaf(proxy);
+        fatten(proxy, lo, hi, displacement);
+        insertLeaf(proxy);
+        reinsertions++;
+        return true;
+    }
+
+    // Batch path: rewrites the leaf only; call refit() once after the whole batch
+    void setBounds(int proxy, const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& displacement) {
+        Node& n = nodes[proxy];
+        if (!contains(n.lo, n.hi, lo, hi)) fatten(proxy, lo, hi, displacement);
+    }
+
+    void refit() {
+        if (root != nullNode) refitNode(root);
+    }
+
+    // Replaces the contents with count static boxes, built top-down in one go; proxy i
+    // gets user data i. boundsOf(i, lo, hi) fills box i.
+    template <typename BoundsOf>
+    void build(int count, BoundsOf boundsOf) {
+        nodes.clear();
+        nodes.reserve((size_t)count * 2);
+        root = freeList = nullNode;
+        proxies = 0;
+        for (int i = 0; i < count; ++i) {
+            int leaf = allocateNode();
+            glm::vec3 lo, hi;
+            boundsOf(i, lo, hi);
+            nodes[leaf].lo = lo - glm::vec3(margin);
+            nodes[leaf].hi = hi + glm::vec3(margin);
+            nodes[leaf].userData = i;
+            nodes[leaf].height = 0;
+            proxies++;
+        }
+        rebuild();
+    }
+
+    // Builds the whole hierarchy again by median splits; proxy ids stay valid
+    void rebuild() {
+        std::vector<int> leaves;
+        leaves.reserve(proxies);
+        for (int i = 0; i < (int)nodes.size(); ++i) {
+            if (nodes[i].height == 0) leaves.push_back(i);
+            else if (nodes[i].height > 0) freeNode(i);
+        }
+        root = leaves.empty() ? nullNode : buildRange(leaves, 0, (int)leaves.size());
+        if (root != nullNode) nodes[root].parent = nullNode;
+    }
+
+    // Visits every proxy whose fat box overlaps [lo, hi]
+    template <typename Visit>
+    void query(const glm::vec3& lo, const glm::vec3& hi, Visit visit) const {
+        traverse([&](const Node& n) { return overlaps(n.lo, n.hi, lo, hi); }, visit);
+    }
+
+    // Visits every proxy whose fat box is at least partly inside the frustum
+    template <typename Visit>
+    void query(const Frustum& frustum, Visit visit) const {
+        traverse([&](const Node& n) { return frustum.containsBox(n.lo, n.hi); }, visit);
+    }
+
+    // Same over several views in one traversal; visit(proxy, mask of the views it reaches)
+    template <typename Visit>
+    void query(const ViewSet& views, Visit visit) const {
+        auto leaf = [&](int proxy) { visit(proxy, views.boxMask(nodes[proxy].lo, nodes[proxy].hi)); };
+        traverse([&](const Node& n) { return views.boxMask(n.lo, n.hi) != 0; }, leaf);
+    }
+
+    // Visits proxies whose fat box the ray enters before maxDistance, roughly nearest
+    // subtree first. visit(proxy) returns the distance to clip the ray to from then on:
+    // the exact hit distance to find the nearest hit, maxDistance to ignore the proxy.
+    template <typename Visit>
+    void raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Visit visit) const {
+        if (root == nullNode) return;
+        glm::vec3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        int stack[maxDepth];
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            int index = stack[--top];
+            const Node& n = nodes[index];
+            float entry;
+            if (!rayBox(origin, inverse, n.lo, n.hi, maxDistance, entry)) continue;
+            if (n.height == 0) { maxDistance = std::min(maxDistance, visit(index)); continue; }
+            if (top + 2 > maxDepth) continue;
+            float entry1, entry2;
+            bool hit1 = rayBox(origin, inverse, nodes[n.child1].lo, nodes[n.child1].hi, maxDistance, entry1);
+            bool hit2 = rayBox(origin, inverse, nodes[n.child2].lo, nodes[n.child2].hi, maxDistance, entry2);
+            // The nearer child goes on top of the stack, so it clips the ray first
+            if (hit1 && hit2 && entry1 < entry2) { stack[top++] = n.child2; stack[top++] = n.child1; }
+            else {
+                if (hit1) stack[top++] = n.child1;
+                if (hit2) stack[top++] = n.child2;
+            }
+        }
+    }
+
+    int userData(int proxy) const { return nodes[proxy].userData; }
+    glm::vec3 fatLo(int proxy) const { return nodes[proxy].lo; }
+    glm::vec3 fatHi(int proxy) const { return nodes[proxy].hi; }
+    int proxyCount() const { return proxies; }
+    int height() const { return root == nullNode ? 0 : nodes[root].height; }
+    // Proxies that left their fat box since the last call
+    int takeReinsertions() { int n = reinsertions; reinsertions = 0; return n; }
+
+    // Sum of internal node surface areas over the root's; lower means cheaper queries
+    float cost() const {
+        if (root == nullNode) return 0.0f;
+        float sum = 0.0f;
+        for (const Node& n : nodes) if (n.height > 0) sum += area(n.lo, n.hi);
+        return sum / area(nodes[root].lo, nodes[root].hi);
+    }
+
+private:
+    struct Node {
+        glm::vec3 lo, hi;
+        int parent = nullNode;   // Next free node while on the free list
+        int child1 = nullNode, child2 = nullNode;
+        int height = -1;         // 0 for leaves, -1 while free
+        int userData = 0;
+    };
+
+    static bool contains(const glm::vec3& outerLo, const glm::vec3& outerHi, const glm::vec3& lo, const glm::vec3& hi) {
+        return outerLo.x <= lo.x && outerLo.y <= lo.y && outerLo.z <= lo.z && hi.x <= outerHi.x && hi.y <= outerHi.y && hi.z <= outerHi.z;
+    }
+    static bool overlaps(const glm::vec3& aLo, const glm::vec3& aHi, const glm::vec3& bLo, const glm::vec3& bHi) {
+        return aLo.x <= bHi.x && aLo.y <= bHi.y && aLo.z <= bHi.z && bLo.x <= aHi.x && bLo.y <= aHi.y && bLo.z <= aHi.z;
+    }
+    static float area(const glm::vec3& lo, const glm::vec3& hi) {
+        glm::vec3 d = hi - lo;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+    static float unionArea(const Node& a, const Node& b) { return area(glm::min(a.lo, b.lo), glm::max(a.hi, b.hi)); }
+
+    // Slab test; entry is where the ray enters the box (0 when it starts inside)
+    static bool rayBox(const glm::vec3& origin, const glm::vec3& inverse, const glm::vec3& lo, const glm::vec3& hi, float maxDistance, float& entry) {
+        glm::vec3 t0 = (lo - origin) * inverse, t1 = (hi - origin) * inverse;
+        glm::vec3 nearT = glm::min(t0, t1), farT = glm::max(t0, t1);
+        entry = std::max(std::max(nearT.x, nearT.y), std::max(nearT.z, 0.0f));
+        float exit = std::min(std::min(farT.x, farT.y), std::min(farT.z, maxDistance));
+        return entry <= exit;
+    }
+
+    template <typename Enter, typename Visit>
+    void traverse(Enter enter, Visit& visit) const {
+        if (root == nullNode) return;
+        int stack[maxDepth];
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            int index = stack[--top];
+            const Node& n = nodes[index];
+            if (!enter(n)) continue;
+            if (n.height == 0) { visit(index); continue; }
+            if (top + 2 > maxDepth) continue;
+            stack[top++] = n.child1;
+            stack[top++] = n.child2;
+        }
+    }
+
+    void fatten(int proxy, const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& displacement) {
+        Node& n = nodes[proxy];
+        glm::vec3 ahead = displacement * float(predictionSteps);
+        n.lo = lo - glm::vec3(margin) + glm::min(ahead, glm::vec3(0.0f));
+        n.hi = hi + glm::vec3(margin) + glm::max(ahead, glm::vec3(0.0f));
+    }
+
+    int allocateNode() {
+        if (freeList == nullNode) {
+            nodes.push_back(Node());
+            return (int)nodes.size() - 1;
+        }
+        int index = freeList;
+        freeList = nodes[index].parent;
+        nodes[index] = Node();
+        return index;
+    }
+
+    void freeNode(int index) {
+        nodes[index].height = -1;
+        nodes[index].parent = freeList;
+        freeList = index;
+    }
+
+    void insertLeaf(int leaf) {
+        if (root == nullNode) {
+            root = leaf;
+            nodes[leaf].parent = nullNode;
+            return;
+        }
+        // Descend while splitting off here would cost more than pushing the leaf into a child
+        int index = root;
+        while (nodes[index].height > 0) {
+            const Node& n = nodes[index];
+            float combined = unionArea(n, nodes[leaf]);
+            float cost = 2.0f * combined;
+            float inheritance = 2.0f * (combined - area(n.lo, n.hi));
+            auto descendCost = [&](int child) {
+                const Node& c = nodes[child];
+                float enlarged = unionArea(c, nodes[leaf]);
+                return (c.height == 0 ? enlarged : enlarged - area(c.lo, c.hi)) + inheritance;
+            };
+            float cost1 = descendCost(n.child1), cost2 = descendCost(n.child2);
+            if (cost < cost1 && cost < cost2) break;
+            index = cost1 < cost2 ? n.child1 : n.child2;
+        }
+
+        int sibling = index;
+        int oldParent = nodes[sibling].parent;
+        int newParent = allocateNode();
+        Node& p = nodes[newParent];
+        p.parent = oldParent;
+        p.lo = glm::min(nodes[sibling].lo, nodes[leaf].lo);
+        p.hi = glm::max(nodes[sibling].hi, nodes[leaf].hi);
+        p.height = nodes[sibling].height + 1;
+        p.child1 = sibling;
+        p.child2 = leaf;
+        if (oldParent != nullNode) {
+            if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+            else nodes[oldParent].child2 = newParent;
+        }
+        else root = newParent;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+        fixUpwards(newParent);
+    }
+
+    void removeLeaf(int leaf) {
+        if (leaf == root) { root = nullNode; return; }
+        int parent = nodes[leaf].parent;
+        int grandParent = nodes[parent].parent;
+        int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+        if (grandParent != nullNode) {
+            if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+            else nodes[grandParent].child2 = sibling;
+            nodes[sibling].parent = grandParent;
+            freeNode(parent);
+            fixUpwards(grandParent);
+        }
+        else {
+            root = sibling;
+            nodes[sibling].parent = nullNode;
+            freeNode(parent);
+        }
+    }
+
+    // Rebalances and refits every node from index up to the root
+    void fixUpwards(int index) {
+        while (index != nullNode) {
+            index = balance(index);
+            Node& n = nodes[index];
+            n.height = 1 + std::max(nodes[n.child1].height, nodes[n.child2].height);
+            n.lo = glm::min(nodes[n.child1].lo, nodes[n.child2].lo);
+            n.hi = glm::max(nodes[n.child1].hi, nodes[n.child2].hi);
+            index = n.parent;
+        }
+    }
+
+    // If one child of a is two or more levels taller, rotates it up to take a's place
+    // and returns the new subtree root
+    int balance(int a) {
+        Node& A = nodes[a];
+        if (A.height < 2) return a;
+        int b = A.child1, c = A.child2;
+        int heightDifference = nodes[c].height - nodes[b].height;
+        if (heightDifference > 1) return rotateUp(a, c, false);
+        if (heightDifference < -1) return rotateUp(a, b, true);
+        return a;
+    }
+
+    // up is a child of a; its taller child stays with it and the shorter one moves to a,
+    // in place of up (which was a's child1 when upWasFirst)
+    int rotateUp(int a, int up, bool upWasFirst) {
+        Node& A = nodes[a];
+        Node& U = nodes[up];
+        int f = U.child1, g = U.child2;
+        U.child1 = a;
+        U.parent = A.parent;
+        A.parent = up;
+        if (U.parent != nullNode) {
+            if (nodes[U.parent].child1 == a) nodes[U.parent].child1 = up;
+            else nodes[U.parent].child2 = up;
+        }
+        else root = up;
+
+        int keep = nodes[f].height > nodes[g].height ? f : g;
+        int give = keep == f ? g : f;
+        U.child2 = keep;
+        if (upWasFirst) A.child1 = give; else A.child2 = give;
+        nodes[give].parent = a;
+        int other = upWasFirst ? A.child2 : A.child1;
+        A.lo = glm::min(nodes[other].lo, nodes[give].lo);
+        A.hi = glm::max(nodes[other].hi, nodes[give].hi);
+        A.height = 1 + std::max(nodes[other].height, nodes[give].height);
+        U.lo = glm::min(A.lo, nodes[keep].lo);
+        U.hi = glm::max(A.hi, nodes[keep].hi);
+        U.height = 1 + std::max(A.height, nodes[keep].height);
+        return up;
+    }
+
+    void refitNode(int index) {
+        Node& n = nodes[index];
+        if (n.height == 0) return;
+        refitNode(n.child1);
+        refitNode(n.child2);
+        n.lo = glm::min(nodes[n.child1].lo, nodes[n.child2].lo);
+        n.hi = glm::max(nodes[n.child1].hi, nodes[n.child2].hi);
+    }
+
+    // Splits at the median centre along the widest axis of the range's centres
+    int buildRange(std::vector<int>& leaves, int begin, int end) {
+        if (end - begin == 1) return leaves[begin];
+        glm::vec3 lo(1e30f), hi(-1e30f);
+        for (int i = begin; i < end; ++i) {
+            glm::vec3 center = (nodes[leaves[i]].lo + nodes[leaves[i]].hi) * 0.5f;
+            lo = glm::min(lo, center); hi = glm::max(hi, center);
+        }
+        glm::vec3 extent = hi - lo;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        int middle = (begin + end) / 2;
+        std::nth_element(leaves.begin() + begin, leaves.begin() + middle, leaves.begin() + end, [&](int a, int b) {
+            return nodes[a].lo[axis] + nodes[a].hi[axis] < nodes[b].lo[axis] + nodes[b].hi[axis];
+        });
+        int child1 = buildRange(leaves, begin, middle);
+        int child2 = buildRange(leaves, middle, end);
+        int parent = allocateNode();
+        Node& p = nodes[parent];
+        p.child1 = child1;
+        p.child2 = child2;
+        p.lo = glm::min(nodes[child1].lo, nodes[child2].lo);
+        p.hi = glm::max(nodes[child1].hi, nodes[child2].hi);
+        p.height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[child1].parent = nodes[child2].parent = parent;
+        return parent;
+    }
+
+    TrackedVector<Node, MemTag::Scene> nodes;
+    int root = nullNode;
+    int freeList = nullNode;
+    int proxies = 0;
+    int reinsertions = 0;
+    float margin;
+};
+
+// --- Entity tree ---
+// Airships, parcels and houses of a GameState in one DynamicAabbTree, so culling, the
+// parcel-vs-house broadphase and picking all query the same structure. sync() diffs the
+// state against the proxies it made last time, which also covers rewinds, quickloads and
+// network snapshots replacing the state wholesale.
+enum class EntityKind : int { Airship, Parcel, House };
+
+class EntityTree {
+public:
+    EntityTree() {
+        aabbs.reserve(GameState::maxAirships + GameState::maxParcels + GameState::maxTargets);
+        std::fill(airshipProxy, airshipProxy + GameState::maxAirships, DynamicAabbTree::nullNode);
+        std::fill(parcelProxy, parcelProxy + GameState::maxParcels, DynamicAabbTree::nullNode);
+        std::fill(houseProxy, houseProxy + GameState::maxTargets, DynamicAabbTree::nullNode);
+    }
+
+    void sync(const GameState& state) {
+        for (int i = 0; i < GameState::maxAirships; ++i) {
+            const Airship& a = state.airships[i];
+            syncProxy(airshipProxy[i], airshipLast[i], a.active, a.position, EntityKind::Airship, i);
+        }
+        for (int i = 0; i < GameState::maxParcels; ++i) {
+            bool active = i < state.parcelCount && state.parcels[i].active;
+            syncProxy(parcelProxy[i], parcelLast[i], active, state.parcels[i].position, EntityKind::Parcel, i);
+        }
+        // Houses never move; they are only redone when a different village is loaded.
+        // Destroyed ones stay in the tree and callers check Target::active.
+        bool sameHouses = state.targetCount == houses;
+        for (int i = 0; i < houses && sameHouses; ++i) sameHouses = houseAt[i] == state.targets[i].position;
+        if (!sameHouses) {
+            for (int i = 0; i < houses; ++i) aabbs.destroyProxy(houseProxy[i]);
+            houses = state.targetCount;
+            for (int i = 0; i < houses; ++i) {
+                glm::vec3 lo, hi;
+                bounds(EntityKind::House, state.targets[i].position, lo, hi);
+                houseAt[i] = state.targets[i].position;
+                houseProxy[i] = aabbs.createProxy(lo, hi, pack(EntityKind::House, i));
+            }
+        }
+    }
+
+    // Tight bounds: balloon and gondola, the parcel cube, house body and roof
+    static void bounds(EntityKind kind, const glm::vec3& position, glm::vec3& lo, glm::vec3& hi) {
+        switch (kind) {
+        case EntityKind::Airship: lo = position - glm::vec3(3.0f, 4.0f, 5.0f); hi = position + glm::vec3(3.0f, 3.0f, 5.0f); break;
+        case EntityKind::Parcel: lo = position - glm::vec3(0.5f); hi = position + glm::vec3(0.5f); break;
+        default: lo = position - glm::vec3(3.5f, 2.0f, 3.5f); hi = position + glm::vec3(3.5f, 5.0f, 3.5f); break;
+        }
+    }
+
+    // Calls visit(index, mask) for every entity of that kind whose box reaches into any
+    // of the views, with the mask of those it does
+    template <typename Visit>
+    void visible(const ViewSet& views, EntityKind kind, Visit visit) const {
+        aabbs.query(views, [&](int proxy, uint8_t mask) {
+            int data = aabbs.userData(proxy);
+            if (kindOf(data) == kind) visit(indexOf(data), mask);
+        });
+    }
+
+    // Calls visit(index) for every house whose box overlaps [lo, hi], destroyed ones included
+    template <typename Visit>
+    void housesNear(const glm::vec3& lo, const glm::vec3& hi, Visit visit) const {
+        aabbs.query(lo, hi, [&](int proxy) {
+            int data = aabbs.userData(proxy);
+            if (kindOf(data) == EntityKind::House) visit(indexOf(data));
+        });
+    }
+
+    // Nearest standing entity whose tight box the ray hits within maxDistance
+    bool pick(const GameState& state, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, EntityKind& kind, int& index, float& distance) const {
+        bool found = false;
+        glm::vec3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        aabbs.raycast(origin, direction, maxDistance, [&](int proxy) {
+            int data = aabbs.userData(proxy);
+            EntityKind k = kindOf(data);
+            int i = indexOf(data);
+            glm::vec3 position = k == EntityKind::Airship ? state.airships[i].position : k == EntityKind::Parcel ? state.parcels[i].position : state.targets[i].position;
+            if (k == EntityKind::House && !state.targets[i].active) return maxDistance;
+            glm::vec3 lo, hi, t0, t1;
+            bounds(k, position, lo, hi);
+            t0 = (lo - origin) * inverse; t1 = (hi - origin) * inverse;
+            glm::vec3 nearT = glm::min(t0, t1), farT = glm::max(t0, t1);
+            float entry = std::max(std::max(nearT.x, nearT.y), std::max(nearT.z, 0.0f));
+            float exit = std::min(std::min(farT.x, farT.y), std::min(farT.z, maxDistance));
+            if (entry > exit) return maxDistance;
+            found = true; kind = k; index = i; distance = entry;
+            maxDistance = entry;
+            return entry;
+        });
+        return found;
+    }
+
+    const DynamicAabbTree& tree() const { return aabbs; }
+    DynamicAabbTree& tree() { return aabbs; }
+
+    static int pack(EntityKind kind, int index) { return ((int)kind << 24) | index; }
+    static EntityKind kindOf(int data) { return (EntityKind)(data >> 24); }
+    static int indexOf(int data) { return data & 0xFFFFFF; }
+
+private:
+    void syncProxy(int& proxy, glm::vec3& last, bool active, const glm::vec3& position, EntityKind kind, int index) {
+        if (!active) {
+            if (proxy != DynamicAabbTree::nullNode) { aabbs.destroyProxy(proxy); proxy = DynamicAabbTree::nullNode; }
+            return;
+        }
+        glm::vec3 lo, hi;
+        bounds(kind, position, lo, hi);
+        if (proxy == DynamicAabbTree::nullNode) proxy = aabbs.createProxy(lo, hi, pack(kind, index));
+        else if (position != last) aabbs.moveProxy(proxy, lo, hi, position - last);
+        last = position;
+    }
+
+    DynamicAabbTree aabbs;
+    int airshipProxy[GameState::maxAirships];
+    int parcelProxy[GameState::maxParcels];
+    int houseProxy[GameState::maxTargets];
+    glm::vec3 airshipLast[GameState::maxAirships];
+    glm::vec3 parcelLast[GameState::maxParcels];
+    glm::vec3 houseAt[GameState::maxTargets];
+    int houses = 0;
+};
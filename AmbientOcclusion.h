@@ -0,0 +1,212 @@
+#pragma once
+
+#include "AabbTree.h"
+#include "CommandRecorder.h"
+#include "EventLog.h"
+
+#include <SFML/System.hpp>
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// --- Baked ambient occlusion ---
+// Per-vertex occlusion for static geometry, computed at load: every vertex casts a fixed
+// cosine-weighted fan of short rays against the occluder triangles (in a DynamicAabbTree
+// built once, top-down) and against the ground height, which is ray-marched so that
+// heightfield terrain does not have to be triangulated. Vertices are split across the
+// command recorder's workers. Results are cached per mesh in a file keyed by a hash of
+// the occluders, the ground and the mesh itself, so later launches skip the rays.
+class OcclusionBaker {
+public:
+    static const int raysPerVertex = 32;
+    static const int groundSteps = 8;
+    static constexpr float maxDistance = 6.0f; // Contact shading only; open sky is 1
+
+    // Ground height at (x, z), called from several threads; groundKey identifies the
+    // terrain (seed or heightmap hash) for the cache
+    void setGround(std::function<float(float, float)> heightAt, uint64_t groundKey) {
+        ground = heightAt;
+        groundHash = groundKey;
+    }
+
+    // Triangles of a scene-layout mesh, transformed by model
+    void addOccluder(const float* vertices, size_t floatCount, const unsigned int* indices, size_t indexCount, const glm::mat4& model) {
+        (void)floatCount;
+        for (size_t i = 0; i < indexCount; ++i) {
+            const float* v = vertices + (size_t)indices[i] * floatsPerVertex;
+            corners.push_back(glm::vec3(model * glm::vec4(v[0], v[1], v[2], 1.0f)));
+        }
+    }
+
+    // Call once every occluder has been added
+    void build() {
+        triangles.build((int)(corners.size() / 3), [&](int i, glm::vec3& lo, glm::vec3& hi) {
+            const glm::vec3* c = &corners[(size_t)i * 3];
+            lo = glm::min(c[0], glm::min(c[1], c[2]));
+            hi = glm::max(c[0], glm::max(c[1], c[2]));
+        });
+        sceneHash = hashBytes(14695981039346656037ull, corners.data(), corners.size() * sizeof(glm::vec3));
+        int settings[] = { raysPerVertex, groundSteps, (int)(maxDistance * 100.0f) };
+        sceneHash = hashBytes(sceneHash, settings, sizeof(settings));
+        sceneHash = hashBytes(sceneHash, &groundHash, sizeof(groundHash));
+    }
+
+    // Occlusion for every vertex of a scene-layout mesh under model, 1 meaning unoccluded
+    std::vector<float> bakeMesh(const float* vertices, size_t floatCount, const glm::mat4& model, CommandRecorder& workers) {
+        std::vector<glm::vec3> positions, normals;
+        glm::mat3 rotation(model);
+        for (size_t v = 0; v + floatsPerVertex <= floatCount; v += floatsPerVertex) {
+            positions.push_back(glm::vec3(model * glm::vec4(vertices[v], vertices[v + 1], vertices[v + 2], 1.0f)));
+            normals.push_back(rotation * glm::vec3(vertices[v + 3], vertices[v + 4], vertices[v + 5]));
+        }
+        return bake(positions, normals, workers);
+    }
+
+    // World-space points and normals, for geometry displaced on the GPU like the terrain
+    std::vector<float> bake(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, CommandRecorder& workers) {
+        uint64_t key = hashBytes(sceneHash, positions.data(), positions.size() * sizeof(glm::vec3));
+        key = hashBytes(key, normals.data(), normals.size() * sizeof(glm::vec3));
+        std::vector<uint8_t>& levels = cache[key];
+        used[key] = true;
+        if (levels.size() == positions.size()) cachedCount += (int)levels.size();
+        else {
+            sf::Clock timer;
+            levels.assign(positions.size(), 255);
+            const int chunk = 256;
+            auto bakeChunk = [&](int c) {
+                int end = std::min((int)positions.size(), (c + 1) * chunk);
+                for (int i = c * chunk; i < end; ++i) levels[i] = (uint8_t)(occlusionAt(positions[i], normals[i], (uint32_t)i) * 255.0f + 0.5f);
+            };
+            workers.run(bakeChunk, ((int)positions.size() + chunk - 1) / chunk);
+            bakedCount += (int)positions.size();
+            bakeMs += timer.getElapsedTime().asSeconds() * 1000.0f;
+            dirty = true;
+        }
+        std::vector<float> result(levels.size());
+        for (size_t i = 0; i < levels.size(); ++i) result[i] = levels[i] / 255.0f;
+        return result;
+    }
+
+    // --- Cache: "AOC1", then (key, count, count levels) per mesh ---
+    void loadCache(const char* path) {
+        cachePath = path;
+        FILE* f = fopen(path, "rb");
+        if (!f) return;
+        char magic[4];
+        if (fread(magic, 4, 1, f) == 1 && memcmp(magic, cacheMagic, 4) == 0) {
+            uint64_t key;
+            uint32_t count;
+            while (fread(&key, sizeof(key), 1, f) == 1 && fread(&count, sizeof(count), 1, f) == 1) {
+                std::vector<uint8_t>& levels = cache[key];
+                levels.resize(count);
+                if (count > 0 && fread(levels.data(), count, 1, f) != 1) { cache.erase(key); break; }
+            }
+        }
+        fclose(f);
+    }
+
+    // Writes the meshes baked or looked up this run; entries for other scenes are dropped
+    void saveCache() {
+        if (cachePath.empty() || (!dirty && used.size() == cache.size())) return;
+        FILE* f = fopen(cachePath.c_str(), "wb");
+        if (!f) { EventLog::instance().warning("Could not write occlusion cache " + cachePath); return; }
+        fwrite(cacheMagic, 4, 1, f);
+        for (const auto& it : cache) {
+            if (!used.count(it.first)) continue;
+            uint32_t count = (uint32_t)it.second.size();
+            fwrite(&it.first, sizeof(it.first), 1, f);
+            fwrite(&count, sizeof(count), 1, f);
+            fwrite(it.second.data(), count, 1, f);
+        }
+        fclose(f);
+        dirty = false;
+    }
+
+    int triangleCount() const { return (int)(corners.size() / 3); }
+    int bakedVertices() const { return bakedCount; }
+    int cachedVertices() const { return cachedCount; }
+    float bakeTimeMs() const { return bakeMs; }
+
+    static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) { hash ^= bytes[i]; hash *= 1099511628211ull; } // FNV-1a
+        return hash;
+    }
+
+private:
+    static const int floatsPerVertex = 14;
+    static constexpr const char* cacheMagic = "AOC1";
+
+    // Fraction of a cosine-weighted hemisphere that reaches maxDistance unblocked. The
+    // directions are a Fibonacci spiral on the disk lifted to the hemisphere (Malley), spun
+    // by a per-vertex angle so neighbouring vertices do not band.
+    float occlusionAt(const glm::vec3& position, const glm::vec3& normal, uint32_t seed) const {
+        glm::vec3 n = glm::normalize(normal);
+        glm::vec3 tangent = glm::normalize(glm::cross(std::fabs(n.y) < 0.99f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0), n));
+        glm::vec3 bitangent = glm::cross(n, tangent);
+        glm::vec3 origin = position + n * 0.05f;
+        float spin = ((seed * 2654435761u) >> 8) * (6.2831853f / 16777216.0f);
+        int open = 0;
+        for (int r = 0; r < raysPerVertex; ++r) {
+            float u = (r + 0.5f) / raysPerVertex;
+            float radius = std::sqrt(u), angle = r * 2.3999632f + spin;
+            glm::vec3 direction = tangent * (radius * std::cos(angle)) + bitangent * (radius * std::sin(angle)) + n * std::sqrt(1.0f - u);
+            if (!blocked(origin, direction)) open++;
+        }
+        return (float)open / raysPerVertex;
+    }
+
+    bool blocked(const glm::vec3& origin, const glm::vec3& direction) const {
+        const float distance = maxDistance;
+        if (ground) {
+            for (int s = 1; s <= groundSteps; ++s) {
+                glm::vec3 p = origin + direction * (distance * s / groundSteps);
+                if (p.y < ground(p.x, p.z) - 0.1f) return true;
+            }
+        }
+        bool hit = false;
+        triangles.raycast(origin, direction, distance, [&](int proxy) {
+            const glm::vec3* c = &corners[(size_t)proxy * 3];
+            float t;
+            if (!rayTriangle(origin, direction, c[0], c[1], c[2], t) || t > distance) return distance;
+            hit = true;
+            return -1.0f; // Any hit will do; a negative clip ends the traversal
+        });
+        return hit;
+    }
+
+    // Möller–Trumbore, two-sided
+    static bool rayTriangle(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t) {
+        glm::vec3 e1 = b - a, e2 = c - a;
+        glm::vec3 p = glm::cross(direction, e2);
+        float det = glm::dot(e1, p);
+        if (std::fabs(det) < 1e-8f) return false;
+        float inverse = 1.0f / det;
+        glm::vec3 s = origin - a;
+        float u = glm::dot(s, p) * inverse;
+        if (u < 0.0f || u > 1.0f) return false;
+        glm::vec3 q = glm::cross(s, e1);
+        float v = glm::dot(direction, q) * inverse;
+        if (v < 0.0f || u + v > 1.0f) return false;
+        t = glm::dot(e2, q) * inverse;
+        return t > 1e-3f;
+    }
+
+    std::vector<glm::vec3> corners; // Three per occluder triangle, in world space
+    DynamicAabbTree triangles{ 0.0f };
+    std::function<float(float, float)> ground;
+    uint64_t groundHash = 0, sceneHash = 0;
+    std::map<uint64_t, std::vector<uint8_t>> cache;
+    std::map<uint64_t, bool> used;
+    std::string cachePath;
+    bool dirty = false;
+    int bakedCount = 0, cachedCount = 0;
+    float bakeMs = 0.0f;
+};
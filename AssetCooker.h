@@ -0,0 +1,318 @@
+#pragma once
+
+#include "CommandRecorder.h"
+#include "CookedTexture.h"
+#include "EventLog.h"
+#include "MeshTopology.h"
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// --- Asset cooker ---
+// Turns source JPGs and generated meshes into what loading uses directly: BC1 textures
+// and single-channel heightmaps with their mips (see CookedTexture.h), and meshes with
+// cache-optimised indices and vertices in fetch order. Each output in cooked/ is named
+// by a hash of its input (the source file's bytes, or the generator and its parameters)
+// and of the cooker version, so only changed inputs cook again. Textures cook on the
+// workers, one job each; meshes cook the first time they are generated.
+//
+// --cook cooks everything the scene loads, deletes outputs nothing uses any more and
+// exits; a normal launch cooks whatever is missing the same way before loading.
+class AssetCooker {
+public:
+    static const uint32_t version = 1; // Bump when an output format or an algorithm changes
+
+    struct TextureSource {
+        const char* path;
+        CookedFormat format;
+    };
+
+    void setDirectory(const std::string& path) { directory = path; }
+
+    // Makes sure every source has a current output, cooking the missing ones in parallel
+    void cookTextures(const TextureSource* sources, int count, CommandRecorder& workers) {
+        ensureDirectory();
+        sf::Clock timer;
+        std::vector<std::string> errors(count);
+        std::vector<uint64_t> keys(count, 0);
+        std::vector<uint8_t> cooked(count, 0); // Not vector<bool>: the workers write neighbouring entries
+        auto cookOne = [&](int i) {
+            std::vector<uint8_t> bytes;
+            if (!readFile(sources[i].path, bytes)) { errors[i] = std::string("Missing texture source ") + sources[i].path; return; }
+            keys[i] = textureKey(bytes, sources[i].format);
+            if (fileExists(outputPath(keys[i], "ctx"))) return;
+            // Identical sources share a key, so each job writes under its own temporary name
+            std::string file = outputPath(keys[i], "ctx");
+            if (!cookTexture(bytes, sources[i].path, sources[i].format, file, file + "." + std::to_string(i) + ".tmp", errors[i])) { keys[i] = 0; return; }
+            cooked[i] = 1;
+        };
+        workers.run(cookOne, count);
+        int cookedCount = 0;
+        for (int i = 0; i < count; ++i) {
+            if (!errors[i].empty()) EventLog::instance().error(errors[i]);
+            if (keys[i]) textureKeys[textureKeyName(sources[i].path, sources[i].format)] = keys[i];
+            cookedCount += cooked[i] ? 1 : 0;
+        }
+        char line[160];
+        snprintf(line, sizeof(line), "Assets: %d of %d textures cooked in %.0f ms, the rest up to date", cookedCount, count, timer.getElapsedTime().asSeconds() * 1000.0f);
+        EventLog::instance().info(line);
+    }
+
+    // The cooked texture for a source; cooks it here if cookTextures did not cover it
+    bool loadTexture(const char* path, CookedFormat format, CookedTexture& out) {
+        auto it = textureKeys.find(textureKeyName(path, format));
+        uint64_t key = it != textureKeys.end() ? it->second : 0;
+        if (!key) {
+            std::vector<uint8_t> bytes;
+            if (!readFile(path, bytes)) { EventLog::instance().error(std::string("Missing texture source ") + path); return false; }
+            key = textureKey(bytes, format);
+            std::string error;
+            ensureDirectory();
+            std::string file = outputPath(key, "ctx");
+            if (!fileExists(file) && !cookTexture(bytes, path, format, file, file + ".tmp", error)) {
+                EventLog::instance().error(error);
+                return false;
+            }
+            textureKeys[textureKeyName(path, format)] = key;
+        }
+        std::string file = outputPath(key, "ctx");
+        if (!readTexture(file, out)) { EventLog::instance().error("Corrupt cooked texture " + file + " for " + path); return false; }
+        used.insert(file);
+        return true;
+    }
+
+    // --- Meshes: the generator's name and parameters make the key ---
+    static uint64_t meshKey(const char* generator, std::initializer_list<float> params) {
+        uint64_t key = hashBytes(14695981039346656037ull, generator, strlen(generator));
+        for (float p : params) key = hashBytes(key, &p, sizeof(p));
+        uint32_t cooker = version;
+        return hashBytes(key, &cooker, sizeof(cooker));
+    }
+
+    template <typename Vertices, typename Indices>
+    bool loadMesh(uint64_t key, Vertices& vertices, Indices& indices, PrimitiveTopology& topology) {
+        std::string file = outputPath(key, "cms");
+        FILE* f = fopen(file.c_str(), "rb");
+        if (!f) return false;
+        fseek(f, 0, SEEK_END);
+        long fileSize = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        char magic[4];
+        uint32_t form = 0, floatCount = 0, indexCount = 0;
+        bool ok = fread(magic, 4, 1, f) == 1 && memcmp(magic, meshMagic, 4) == 0
+            && fread(&form, sizeof(form), 1, f) == 1 && fread(&floatCount, sizeof(floatCount), 1, f) == 1 && fread(&indexCount, sizeof(indexCount), 1, f) == 1;
+        // The counts must describe whole vertices and exactly the rest of the file
+        ok = ok && (form == (uint32_t)PrimitiveTopology::Triangles || form == (uint32_t)PrimitiveTopology::TriangleStrip)
+            && floatCount > 0 && floatCount % floatsPerVertex == 0
+            && 16 + ((uint64_t)floatCount + indexCount) * 4 == (uint64_t)fileSize;
+        std::vector<float> v(ok ? floatCount : 0);
+        std::vector<unsigned int> i(ok ? indexCount : 0);
+        ok = ok && fread(v.data(), v.size() * sizeof(float), 1, f) == 1 && (i.empty() || fread(i.data(), i.size() * sizeof(unsigned int), 1, f) == 1);
+        fclose(f);
+        unsigned int vertexCount = floatCount / floatsPerVertex;
+        for (size_t n = 0; ok && n < i.size(); ++n) ok = i[n] < vertexCount || i[n] == primitiveRestartIndex;
+        if (!ok) { EventLog::instance().warning("Corrupt cooked mesh " + file + ", cooking it again"); return false; }
+        vertices.assign(v.begin(), v.end());
+        indices.assign(i.begin(), i.end());
+        topology = (PrimitiveTopology)form;
+        used.insert(file);
+        return true;
+    }
+
+    // Optimises a freshly generated mesh in place (index order for the post-transform
+    // cache, then vertex order for fetches) and writes it for the next launches
+    template <typename Vertices, typename Indices>
+    void storeMesh(uint64_t key, Vertices& vertices, Indices& indices, PrimitiveTopology topology) {
+        std::vector<float> v(vertices.begin(), vertices.end());
+        std::vector<unsigned int> i(indices.begin(), indices.end());
+        if (topology == PrimitiveTopology::Triangles) mesh_topology::optimizeVertexCache(i, (int)(v.size() / floatsPerVertex));
+        mesh_topology::optimizeVertexFetch(v, floatsPerVertex, i);
+        vertices.assign(v.begin(), v.end());
+        indices.assign(i.begin(), i.end());
+
+        ensureDirectory();
+        std::string file = outputPath(key, "cms");
+        std::string temporary = file + ".tmp";
+        FILE* f = fopen(temporary.c_str(), "wb");
+        if (!f) { EventLog::instance().warning("Could not write " + temporary); return; }
+        uint32_t form = (uint32_t)topology, floatCount = (uint32_t)v.size(), indexCount = (uint32_t)i.size();
+        fwrite(meshMagic, 4, 1, f);
+        fwrite(&form, sizeof(form), 1, f); fwrite(&floatCount, sizeof(floatCount), 1, f); fwrite(&indexCount, sizeof(indexCount), 1, f);
+        if (!v.empty()) fwrite(v.data(), v.size() * sizeof(float), 1, f);
+        if (!i.empty()) fwrite(i.data(), i.size() * sizeof(unsigned int), 1, f);
+        fclose(f);
+        if (publish(temporary, file)) used.insert(file);
+        meshesCooked++;
+    }
+
+    // Adds this run's outputs to cooked/manifest.txt. With prune, the outputs listed there
+    // that this run did not use are deleted instead of kept.
+    void finish(bool prune) {
+        std::string manifest = directory + "/manifest.txt";
+        std::set<std::string> listed;
+        if (FILE* f = fopen(manifest.c_str(), "r")) {
+            char name[512];
+            while (fscanf(f, " %511s", name) == 1) listed.insert(name);
+            fclose(f);
+        }
+        int removed = 0;
+        std::set<std::string> keep(used);
+        for (const std::string& file : listed) {
+            if (used.count(file)) continue;
+            if (prune) removed += remove(file.c_str()) == 0 ? 1 : 0;
+            else keep.insert(file);
+        }
+        if (keep == listed && !prune) return;
+        ensureDirectory();
+        FILE* f = fopen(manifest.c_str(), "w");
+        if (!f) { EventLog::instance().warning("Could not write " + manifest); return; }
+        for (const std::string& file : keep) fprintf(f, "%s\n", file.c_str());
+        fclose(f);
+        if (prune) {
+            char line[160];
+            snprintf(line, sizeof(line), "Assets: %d outputs in use, %d meshes cooked, %d stale outputs removed", (int)used.size(), meshesCooked, removed);
+            EventLog::instance().info(line);
+        }
+    }
+
+private:
+    static constexpr const char* textureMagic = "CTX1";
+    static constexpr const char* meshMagic = "CMS1";
+    static const int floatsPerVertex = 14;
+
+    static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) { hash ^= bytes[i]; hash *= 1099511628211ull; } // FNV-1a
+        return hash;
+    }
+
+    // The source's bytes, the output format and the cooker version
+    static uint64_t textureKey(const std::vector<uint8_t>& bytes, CookedFormat format) {
+        uint64_t key = hashBytes(14695981039346656037ull, bytes.data(), bytes.size());
+        uint32_t settings[2] = { version, (uint32_t)format };
+        return hashBytes(key, settings, sizeof(settings));
+    }
+
+    static std::string textureKeyName(const char* path, CookedFormat format) {
+        return std::string(path) + (format == CookedFormat::R8 ? "#r8" : "#bc1");
+    }
+
+    std::string outputPath(uint64_t key, const char* extension) const {
+        char name[40];
+        snprintf(name, sizeof(name), "/%016llx.%s", (unsigned long long)key, extension);
+        return directory + name;
+    }
+
+    void ensureDirectory() const {
+#ifdef _WIN32
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);
+#endif
+    }
+
+    static bool fileExists(const std::string& path) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (f) fclose(f);
+        return f != nullptr;
+    }
+
+    static bool readFile(const char* path, std::vector<uint8_t>& bytes) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        bytes.resize(size > 0 ? (size_t)size : 0);
+        bool ok = size > 0 && fread(bytes.data(), bytes.size(), 1, f) == 1;
+        fclose(f);
+        return ok;
+    }
+
+    // Written under a temporary name first, so a second instance never reads half a file
+    static bool publish(const std::string& temporary, const std::string& file) {
+        remove(file.c_str());
+        if (rename(temporary.c_str(), file.c_str()) == 0) return true;
+        remove(temporary.c_str());
+        return false;
+    }
+
+    // Decodes the JPEG once and writes every mip level; runs on a worker
+    static bool cookTexture(const std::vector<uint8_t>& bytes, const char* source, CookedFormat format, const std::string& file, const std::string& temporary, std::string& error) {
+        sf::Image image;
+        if (!image.loadFromMemory(bytes.data(), bytes.size())) { error = std::string("Could not decode texture source ") + source; return false; }
+        CookedTexture texture;
+        texture.format = format;
+        texture.width = (int)image.getSize().x; texture.height = (int)image.getSize().y;
+        int channels = format == CookedFormat::R8 ? 1 : 4;
+        std::vector<uint8_t> level((size_t)texture.width * texture.height * channels);
+        const uint8_t* rgba = image.getPixelsPtr();
+        if (channels == 4) memcpy(level.data(), rgba, level.size());
+        else for (size_t i = 0; i < level.size(); ++i) level[i] = rgba[i * 4]; // Heights are the red channel
+        int levels = CookedTexture::levelCount(texture.width, texture.height);
+        for (int l = 0; l < levels; ++l) {
+            int w = texture.levelWidth(l), h = texture.levelHeight(l);
+            if (l > 0) level = texture_cook::downsample(level.data(), texture.levelWidth(l - 1), texture.levelHeight(l - 1), channels);
+            texture.levels.push_back(format == CookedFormat::BC1 ? texture_cook::encodeBC1(level.data(), w, h) : level);
+        }
+        if (writeTexture(file, temporary, texture)) return true;
+        error = "Could not write " + file;
+        return false;
+    }
+
+    // "CTX1", format, width, height, level count, then every level's bytes
+    static bool writeTexture(const std::string& file, const std::string& temporary, const CookedTexture& texture) {
+        FILE* f = fopen(temporary.c_str(), "wb");
+        if (!f) return false;
+        uint32_t header[4] = { (uint32_t)texture.format, (uint32_t)texture.width, (uint32_t)texture.height, (uint32_t)texture.levels.size() };
+        bool ok = fwrite(textureMagic, 4, 1, f) == 1 && fwrite(header, sizeof(header), 1, f) == 1;
+        for (const std::vector<uint8_t>& level : texture.levels) ok = ok && fwrite(level.data(), level.size(), 1, f) == 1;
+        ok = fclose(f) == 0 && ok;
+        if (!ok) { remove(temporary.c_str()); return false; }
+        return publish(temporary, file);
+    }
+
+    static bool readTexture(const std::string& file, CookedTexture& texture) {
+        FILE* f = fopen(file.c_str(), "rb");
+        if (!f) return false;
+        char magic[4];
+        uint32_t header[4];
+        bool ok = fread(magic, 4, 1, f) == 1 && memcmp(magic, textureMagic, 4) == 0 && fread(header, sizeof(header), 1, f) == 1;
+        if (ok) {
+            texture.format = (CookedFormat)header[0];
+            texture.width = (int)header[1]; texture.height = (int)header[2];
+            ok = (texture.format == CookedFormat::BC1 || texture.format == CookedFormat::R8) && texture.width > 0 && texture.height > 0
+                && (int)header[3] == CookedTexture::levelCount(texture.width, texture.height);
+        }
+        texture.levels.clear();
+        for (int l = 0; ok && l < (int)header[3]; ++l) {
+            texture.levels.push_back(std::vector<uint8_t>(CookedTexture::levelBytes(texture.format, texture.levelWidth(l), texture.levelHeight(l))));
+            ok = fread(texture.levels.back().data(), texture.levels.back().size(), 1, f) == 1;
+        }
+        fclose(f);
+        return ok;
+    }
+
+    std::string directory = "cooked";
+    std::unordered_map<std::string, uint64_t> textureKeys; // Source and format to key, from cookTextures
+    std::set<std::string> used;
+    int meshesCooked = 0;
+};
+
+inline AssetCooker& assetCooker() {
+    static AssetCooker cooker;
+    return cooker;
+}
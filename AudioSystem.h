@@ -0,0 +1,254 @@
+#pragma once
+
+#include "EventLog.h"
+#include "MemoryTracker.h"
+
+#include <SFML/Audio.hpp>
+#include <SFML/System.hpp>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// --- Spatial audio ---
+// Emitters ask for sound every frame (engines, falling parcels) or fire one-shots
+// (impacts, hits); each request is a virtual voice. update() ranks them by how loud
+// they would be at the listener and only the top few own one of the fixed real
+// voices, so thousands of emitters cost a sort, not thousands of sources. Virtual
+// voices keep their play position and resume at the right offset when they win a
+// voice back. With a null output no SFML audio object is ever created (they would
+// open the device), but voice selection runs exactly the same.
+
+enum class SoundId : uint8_t { EngineHum, ParcelWhoosh, ImpactThud, HitChime, Count };
+
+class AudioSystem {
+public:
+    static const int voiceCount = 16;
+    static const int maxLoops = 2048;    // Looping requests per frame
+    static const int maxOneShots = 128;
+    static const int sampleRate = 22050;
+
+    void init(bool nullOutput) {
+        null = nullOutput;
+        for (int i = 0; i < (int)SoundId::Count; ++i) {
+            Bank& bank = banks[i];
+            bank.desc = bankDesc((SoundId)i);
+            synthesize((SoundId)i, bank.samples);
+            bank.duration = (float)bank.samples.size() / sampleRate;
+            MemoryTracker::instance().add(MemTag::Audio, (int64_t)(bank.samples.size() * sizeof(int16_t)));
+        }
+        if (!null) {
+            buffers.resize((int)SoundId::Count);
+            for (int i = 0; i < (int)SoundId::Count; ++i) buffers[i].loadFromSamples(banks[i].samples.data(), banks[i].samples.size(), 1, sampleRate);
+            sounds.resize(voiceCount);
+        }
+        EventLog::instance().info(std::string("Audio: ") + (null ? "null output" : "OpenAL output") + ", " + std::to_string(voiceCount) + " voices");
+    }
+
+    // Looping sound for this frame; emitter must be stable while the sound should continue
+    void loop(SoundId id, uint32_t emitter, const glm::vec3& position) {
+        if (loopCount >= maxLoops) return;
+        // Key 0 marks a free voice, hence the +1
+        loops[loopCount++] = { (((uint32_t)id + 1) << 24) | (emitter & 0xFFFFFF), id, position };
+    }
+
+    void play(SoundId id, const glm::vec3& position) {
+        if (oneShotCount >= maxOneShots) {
+            // Replace the oldest; it has the least left to play
+            int oldest = 0;
+            for (int i = 1; i < oneShotCount; ++i) if (oneShots[i].age > oneShots[oldest].age) oldest = i;
+            oneShots[oldest] = oneShots[--oneShotCount];
+        }
+        oneShots[oneShotCount++] = { oneShotKeyBit | (nextOneShot++ & ~oneShotKeyBit), id, position, 0.0f };
+    }
+
+    void update(const glm::vec3& listenerPos, const glm::vec3& listenerForward, float dt) {
+        sf::Clock timer;
+        time += dt;
+        for (int i = 0; i < oneShotCount;) {
+            oneShots[i].age += dt;
+            if (oneShots[i].age >= banks[(int)oneShots[i].id].duration) oneShots[i] = oneShots[--oneShotCount];
+            else ++i;
+        }
+
+        // --- Virtual voices in range, scored by audibility ---
+        candidateCount = 0;
+        for (int i = 0; i < loopCount; ++i) {
+            const Bank& bank = banks[(int)loops[i].id];
+            // Emitters start at different phases so many engines do not sum in sync
+            float offset = std::fmod(time + (loops[i].key & 0xFFFF) * 0.137f, bank.duration);
+            addCandidate(loops[i].key, loops[i].id, loops[i].position, offset, listenerPos);
+        }
+        for (int i = 0; i < oneShotCount; ++i)
+            addCandidate(oneShots[i].key, oneShots[i].id, oneShots[i].position, oneShots[i].age, listenerPos);
+        int real = std::min(candidateCount, (int)voiceCount);
+        if (candidateCount > real)
+            std::nth_element(candidates, candidates + real, candidates + candidateCount,
+                [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+        // --- Keep voices whose owner is still selected, then hand out the rest ---
+        bool selectedHasVoice[voiceCount] = {};
+        for (int v = 0; v < voiceCount; ++v) {
+            int owner = -1;
+            for (int c = 0; c < real && owner < 0; ++c) if (voices[v].key != 0 && candidates[c].key == voices[v].key) owner = c;
+            if (owner >= 0) { selectedHasVoice[owner] = true; place(v, candidates[owner]); }
+            else if (voices[v].key != 0) { voices[v].key = 0; if (!null) sounds[v].stop(); }
+        }
+        for (int c = 0; c < real; ++c) {
+            if (selectedHasVoice[c]) continue;
+            int v = 0;
+            while (v < voiceCount && voices[v].key != 0) ++v; // One free voice per unplaced candidate is guaranteed
+            assert(v < voiceCount);
+            if (v == voiceCount) break;
+            start(v, candidates[c]);
+        }
+        if (!null) {
+            sf::Listener::setPosition(listenerPos.x, listenerPos.y, listenerPos.z);
+            sf::Listener::setDirection(listenerForward.x, listenerForward.y, listenerForward.z);
+        }
+
+        realCount = real;
+        virtualCount = loopCount + oneShotCount - real;
+        loopCount = 0;
+        lastUpdateMs = timer.getElapsedTime().asMicroseconds() / 1000.0f;
+    }
+
+    int realVoices() const { return realCount; }
+    int virtualVoices() const { return virtualCount; } // Requested but not heard, including out of range
+    float updateMs() const { return lastUpdateMs; }
+
+private:
+    struct BankDesc {
+        float priority;
+        float volume;      // 0-100, as SFML takes it
+        float minDistance; // Full volume inside this
+        float maxDistance; // Culled outside this
+        bool looping;
+    };
+
+    struct Bank {
+        BankDesc desc;
+        std::vector<int16_t> samples; // Decoded mono PCM, kept for the null output too
+        float duration = 0.0f;
+    };
+
+    struct LoopRequest { uint32_t key; SoundId id; glm::vec3 position; };
+    struct OneShot { uint32_t key; SoundId id; glm::vec3 position; float age; };
+    struct Candidate { uint32_t key; SoundId id; glm::vec3 position; float offset; float score; };
+    struct Voice { uint32_t key = 0; }; // 0 is free
+
+    static BankDesc bankDesc(SoundId id) {
+        switch (id) {
+        case SoundId::EngineHum: return { 1.0f, 60.0f, 10.0f, 120.0f, true };
+        case SoundId::ParcelWhoosh: return { 0.6f, 50.0f, 4.0f, 60.0f, true };
+        case SoundId::ImpactThud: return { 0.8f, 80.0f, 6.0f, 100.0f, false };
+        case SoundId::HitChime: return { 2.0f, 100.0f, 15.0f, 250.0f, false }; // Gameplay feedback wins over ambience
+        default: return { 0.0f, 0.0f, 1.0f, 1.0f, false };
+        }
+    }
+
+    void addCandidate(uint32_t key, SoundId id, const glm::vec3& position, float offset, const glm::vec3& listenerPos) {
+        const BankDesc& desc = banks[(int)id].desc;
+        float distance = glm::length(position - listenerPos);
+        if (distance > desc.maxDistance) return;
+        // Same inverse-distance curve OpenAL applies with attenuation 1
+        float gain = desc.minDistance / (desc.minDistance + std::max(0.0f, distance - desc.minDistance));
+        candidates[candidateCount++] = { key, id, position, offset, desc.priority * desc.volume * gain };
+    }
+
+    void start(int v, const Candidate& c) {
+        voices[v].key = c.key;
+        if (null) return;
+        const Bank& bank = banks[(int)c.id];
+        sf::Sound& sound = sounds[v];
+        sound.setBuffer(buffers[(int)c.id]);
+        sound.setLoop(bank.desc.looping);
+        sound.setVolume(bank.desc.volume);
+        sound.setMinDistance(bank.desc.minDistance);
+        sound.setAttenuation(1.0f);
+        sound.setPosition(c.position.x, c.position.y, c.position.z);
+        sound.play();
+        sound.setPlayingOffset(sf::seconds(c.offset));
+    }
+
+    void place(int v, const Candidate& c) {
+        if (!null) sounds[v].setPosition(c.position.x, c.position.y, c.position.z);
+    }
+
+    // No audio assets ship with the game, so the banks are generated once at load
+    static void synthesize(SoundId id, std::vector<int16_t>& out) {
+        const float pi = 3.14159265f;
+        std::mt19937 rng(1 + (int)id);
+        std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+        std::vector<float> wave;
+        switch (id) {
+        case SoundId::EngineHum:
+            // Whole cycles of every component in one second, so the loop is seamless
+            wave.resize(sampleRate);
+            for (size_t i = 0; i < wave.size(); ++i) {
+                float t = (float)i / sampleRate;
+                float tone = 0.5f * std::sin(2 * pi * 55 * t) + 0.3f * std::sin(2 * pi * 110 * t) + 0.15f * std::sin(2 * pi * 165 * t);
+                wave[i] = tone * (0.85f + 0.15f * std::sin(2 * pi * 4 * t));
+            }
+            break;
+        case SoundId::ParcelWhoosh: {
+            // Low-passed noise with a cutoff that swells once per loop
+            wave.resize(sampleRate * 2);
+            float y = 0.0f;
+            for (size_t i = 0; i < wave.size(); ++i) {
+                float t = (float)i / sampleRate;
+                float k = 0.05f + 0.1f * (0.5f + 0.5f * std::sin(pi * t));
+                y += k * (noise(rng) - y);
+                wave[i] = y * 3.0f;
+            }
+            break;
+        }
+        case SoundId::ImpactThud:
+            wave.resize(sampleRate * 2 / 5);
+            for (size_t i = 0; i < wave.size(); ++i) {
+                float t = (float)i / sampleRate;
+                float phase = 2 * pi * (40 * t + 50 * (1 - std::exp(-t * 10)) / 10); // 90 Hz sliding down to 40 Hz
+                wave[i] = std::sin(phase) * std::exp(-t * 12) + 0.3f * noise(rng) * std::exp(-t * 40);
+            }
+            break;
+        case SoundId::HitChime:
+            wave.resize(sampleRate * 3 / 2);
+            for (size_t i = 0; i < wave.size(); ++i) {
+                float t = (float)i / sampleRate;
+                wave[i] = 0.5f * std::sin(2 * pi * 880 * t) * std::exp(-t * 3) + 0.3f * std::sin(2 * pi * 1320 * t) * std::exp(-t * 4)
+                    + 0.2f * std::sin(2 * pi * 1760 * t) * std::exp(-t * 6) + 0.1f * std::sin(2 * pi * 2640 * t) * std::exp(-t * 9);
+            }
+            break;
+        default:
+            break;
+        }
+        float peak = 1e-6f;
+        for (float s : wave) peak = std::max(peak, std::fabs(s));
+        out.resize(wave.size());
+        for (size_t i = 0; i < wave.size(); ++i) out[i] = (int16_t)(wave[i] / peak * 0.8f * 32767.0f);
+    }
+
+    static const uint32_t oneShotKeyBit = 0x80000000u;
+
+    bool null = true;
+    float time = 0.0f;
+    Bank banks[(int)SoundId::Count];
+    // Only created for a real output, since constructing either opens the OpenAL device.
+    // Sounds are declared after their buffers so they are destroyed first.
+    std::vector<sf::SoundBuffer> buffers;
+    std::vector<sf::Sound> sounds;
+    Voice voices[voiceCount];
+    LoopRequest loops[maxLoops];
+    int loopCount = 0;
+    OneShot oneShots[maxOneShots];
+    int oneShotCount = 0;
+    uint32_t nextOneShot = 1;
+    Candidate candidates[maxLoops + maxOneShots];
+    int candidateCount = 0;
+    int realCount = 0, virtualCount = 0;
+    float lastUpdateMs = 0.0f;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- Parallel command recording ---
+// Runs one job per scene partition on persistent worker threads and returns once all
+// of them finished. The calling thread takes jobs as well, and jobs are passed without
+// type erasure on the heap, so a frame's batch does not allocate. A job must only
+// write to its own partition's CommandList.
+class CommandRecorder {
+public:
+    explicit CommandRecorder(int workerCount) {
+        for (int i = 0; i < workerCount; ++i) workers.emplace_back(&CommandRecorder::workerLoop, this);
+    }
+
+    ~CommandRecorder() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quitting = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+    // Calls job(i) for i in [0, count); inline on this thread when parallel is false
+    template <typename Job>
+    void run(Job& job, int count, bool parallel = true) {
+        if (!parallel || workers.empty()) {
+            for (int i = 0; i < count; ++i) job(i);
+            return;
+        }
+        {
+            // A worker that woke late for the previous batch must leave before the counters reset
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return busy == 0; });
+            context = &job;
+            invoke = [](void* ctx, int i) { (*static_cast<Job*>(ctx))(i); };
+            jobCount = count;
+            nextJob.store(0);
+            remaining.store(count);
+            generation++;
+        }
+        wake.notify_all();
+        runJobs();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return remaining.load() == 0; });
+    }
+
+    int workerCount() const { return (int)workers.size(); }
+
+    // Leaves a core for the render thread and one for the rest of the process
+    static int defaultWorkerCount() {
+        int cores = (int)std::thread::hardware_concurrency();
+        return std::max(1, std::min(3, cores - 2));
+    }
+
+private:
+    void workerLoop() {
+        unsigned int seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return quitting || generation != seen; });
+                if (quitting) return;
+                seen = generation;
+                busy++;
+            }
+            runJobs();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) done.notify_all();
+        }
+    }
+
+    void runJobs() {
+        int i;
+        while ((i = nextJob.fetch_add(1)) < jobCount) {
+            invoke(context, i);
+            if (remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    void* context = nullptr;
+    void (*invoke)(void*, int) = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextJob{ 0 };
+    std::atomic<int> remaining{ 0 };
+    unsigned int generation = 0;
+    int busy = 0; // Workers inside runJobs
+    bool quitting = false;
+};
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "EventLog.h"
+#include "GameState.h"
+#include "Network.h"
+
+#include <SFML/Network.hpp>
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+// --- Control socket ---
+// Lets scripts drive a running game from outside, for repeatable performance scenarios:
+// one text command per line on a 127.0.0.1 TCP connection, one reply line per command
+// ("ok", "error ..." or the answer). Polled from the frame loop without blocking, so
+// every command lands between two ticks, in the order it arrived.
+//
+//   hold [forward|back|left|right|up|down ...]  buttons held until the next hold; none releases
+//   drop                                        one parcel from the player's airship
+//   spawn x y z                                 a parcel at a position
+//   aim on|off|toggle                           the aim camera
+//   teleport x y z                              the player's airship
+//   camera x y z tx ty tz | camera follow       a fixed camera looking at a point, or back to the airship
+//   stats | score                               the last finished frame's numbers
+//
+// Coordinates must be finite and within netWorldHalfExtent of the origin on every axis.
+enum class ControlOp { Hold, Drop, Spawn, Aim, Teleport, Camera, CameraFollow, Stats, Score };
+
+struct ControlCommand {
+    ControlOp op = ControlOp::Stats;
+    uint8_t buttons = 0;   // Hold
+    int aim = -1;          // Aim: 0 off, 1 on, -1 toggle
+    glm::vec3 position = glm::vec3(0.0f); // Spawn, Teleport, Camera
+    glm::vec3 target = glm::vec3(0.0f);   // Camera
+};
+
+class ControlServer {
+public:
+    static const int maxClients = 4;
+    static const int maxLine = 256;
+    static const int maxReply = 256;
+
+    ~ControlServer() { stop(); }
+
+    bool start(unsigned short port) {
+        listener.setBlocking(false);
+        if (listener.listen(port, sf::IpAddress::LocalHost) != sf::Socket::Done) return false;
+        listening = true;
+        return true;
+    }
+
+    void stop() {
+        if (!listening) return;
+        for (Client& c : clients) if (c.socket) c.socket->disconnect();
+        listener.close();
+        listening = false;
+    }
+
+    // Accepts connections and reads what has arrived; apply(command, reply, replySize) runs
+    // for each complete command, with the reply preset to "ok". Call once per tick.
+    template <typename Apply>
+    void poll(Apply apply) {
+        if (!listening) return;
+        accept();
+        char buffer[512];
+        for (Client& c : clients) {
+            if (!c.socket) continue;
+            std::size_t received = 0;
+            sf::Socket::Status status;
+            while ((status = c.socket->receive(buffer, sizeof(buffer), received)) == sf::Socket::Done) {
+                for (std::size_t i = 0; i < received && c.socket; ++i) {
+                    char ch = buffer[i];
+                    if (ch == '\r') continue;
+                    if (ch != '\n') {
+                        if (c.length < maxLine - 1) c.line[c.length++] = ch;
+                        else c.overflow = true;
+                        continue;
+                    }
+                    c.line[c.length] = '\0';
+                    char reply[maxReply];
+                    ControlCommand command;
+                    if (c.overflow) snprintf(reply, sizeof(reply), "error line longer than %d", maxLine - 1);
+                    else if (parse(c.line, command, reply, sizeof(reply))) {
+                        snprintf(reply, sizeof(reply), "ok");
+                        apply(command, reply, sizeof(reply));
+                    }
+                    c.length = 0; c.overflow = false;
+                    if (reply[0]) send(c, reply); // Blank lines get no reply
+                }
+                if (!c.socket) break;
+            }
+            if (c.socket && status == sf::Socket::Disconnected) drop(c);
+        }
+    }
+
+private:
+    struct Client {
+        std::unique_ptr<sf::TcpSocket> socket;
+        char line[maxLine];
+        int length = 0;
+        bool overflow = false;
+    };
+
+    void accept() {
+        for (;;) {
+            if (!incoming) incoming.reset(new sf::TcpSocket); // Kept across polls: most find nobody waiting
+            if (listener.accept(*incoming) != sf::Socket::Done) return;
+            Client* free = nullptr;
+            for (Client& c : clients) if (!c.socket) { free = &c; break; }
+            if (!free) {
+                const char full[] = "error too many control connections\n";
+                incoming->send(full, sizeof(full) - 1);
+                incoming->disconnect();
+                continue;
+            }
+            incoming->setBlocking(false);
+            free->socket = std::move(incoming);
+            free->length = 0; free->overflow = false;
+            EventLog::instance().info("Control connection from " + free->socket->getRemoteAddress().toString());
+        }
+    }
+
+    void drop(Client& c) {
+        c.socket->disconnect();
+        c.socket.reset();
+        EventLog::instance().info("Control connection closed");
+    }
+
+    void send(Client& c, const char* text) {
+        char out[maxReply + 1];
+        int length = snprintf(out, sizeof(out), "%s\n", text);
+        std::size_t sent = 0, offset = 0;
+        // Replies are short; a full socket buffer only means a client that stopped reading
+        for (int tries = 0; offset < (std::size_t)length && tries < 100; ++tries) {
+            sf::Socket::Status status = c.socket->send(out + offset, length - offset, sent);
+            offset += sent;
+            if (status == sf::Socket::Disconnected || status == sf::Socket::Error) break;
+        }
+        if (offset < (std::size_t)length) drop(c);
+    }
+
+    // Fills command, or the reply with an error and returns false
+    static bool parse(const char* line, ControlCommand& command, char* reply, size_t size) {
+        char word[32] = "";
+        int consumed = 0;
+        if (sscanf(line, " %31s%n", word, &consumed) != 1) { reply[0] = '\0'; return false; }
+        const char* rest = line + consumed;
+        float v[6];
+        if (!strcmp(word, "hold")) {
+            command.op = ControlOp::Hold;
+            char name[32];
+            int n = 0;
+            while (sscanf(rest, " %31s%n", name, &n) == 1) {
+                rest += n;
+                if (!strcmp(name, "forward")) command.buttons |= InputForward;
+                else if (!strcmp(name, "back")) command.buttons |= InputBack;
+                else if (!strcmp(name, "left")) command.buttons |= InputLeft;
+                else if (!strcmp(name, "right")) command.buttons |= InputRight;
+                else if (!strcmp(name, "up")) command.buttons |= InputUp;
+                else if (!strcmp(name, "down")) command.buttons |= InputDown;
+                else if (strcmp(name, "none")) { snprintf(reply, size, "error unknown button %s", name); return false; }
+            }
+        }
+        else if (!strcmp(word, "drop")) command.op = ControlOp::Drop;
+        else if (!strcmp(word, "spawn") || !strcmp(word, "teleport")) {
+            command.op = word[0] == 's' ? ControlOp::Spawn : ControlOp::Teleport;
+            if (sscanf(rest, "%f %f %f", &v[0], &v[1], &v[2]) != 3) { snprintf(reply, size, "error usage: %s x y z", word); return false; }
+            if (!inWorld(v, 3, reply, size)) return false;
+            command.position = glm::vec3(v[0], v[1], v[2]);
+        }
+        else if (!strcmp(word, "aim")) {
+            command.op = ControlOp::Aim;
+            char mode[16] = "toggle";
+            sscanf(rest, " %15s", mode);
+            if (!strcmp(mode, "on")) command.aim = 1;
+            else if (!strcmp(mode, "off")) command.aim = 0;
+            else if (strcmp(mode, "toggle")) { snprintf(reply, size, "error usage: aim on|off|toggle"); return false; }
+        }
+        else if (!strcmp(word, "camera")) {
+            char mode[16] = "";
+            if (sscanf(rest, " %15s", mode) == 1 && !strcmp(mode, "follow")) command.op = ControlOp::CameraFollow;
+            else if (sscanf(rest, "%f %f %f %f %f %f", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) == 6) {
+                if (!inWorld(v, 6, reply, size)) return false;
+                command.op = ControlOp::Camera;
+                command.position = glm::vec3(v[0], v[1], v[2]);
+                command.target = glm::vec3(v[3], v[4], v[5]);
+                if (command.position == command.target) { snprintf(reply, size, "error camera position and target are the same"); return false; }
+            }
+            else { snprintf(reply, size, "error usage: camera x y z tx ty tz | camera follow"); return false; }
+        }
+        else if (!strcmp(word, "stats")) command.op = ControlOp::Stats;
+        else if (!strcmp(word, "score")) command.op = ControlOp::Score;
+        else { snprintf(reply, size, "error unknown command %s", word); return false; }
+        return true;
+    }
+
+    // sscanf's %f takes nan, inf and 1e30 as readily as a position
+    static bool inWorld(const float* v, int count, char* reply, size_t size) {
+        for (int i = 0; i < count; ++i) {
+            if (std::isfinite(v[i]) && std::fabs(v[i]) <= netWorldHalfExtent) continue;
+            snprintf(reply, size, "error coordinates must be finite and within %.0f of the origin", netWorldHalfExtent);
+            return false;
+        }
+        return true;
+    }
+
+    sf::TcpListener listener;
+    std::unique_ptr<sf::TcpSocket> incoming;
+    Client clients[maxClients];
+    bool listening = false;
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// --- Cooked textures ---
+// What the asset cooker writes and the render device uploads as is: BC1 (DXT1) blocks for
+// colour textures, one byte per texel for heightmaps, each with its whole mip chain down
+// to 1x1 so nothing is decoded or filtered at load.
+enum class CookedFormat : uint32_t { BC1 = 1, R8 = 2 };
+
+struct CookedTexture {
+    CookedFormat format = CookedFormat::BC1;
+    int width = 0, height = 0;
+    std::vector<std::vector<uint8_t>> levels; // Largest first
+
+    int levelWidth(int level) const { return std::max(1, width >> level); }
+    int levelHeight(int level) const { return std::max(1, height >> level); }
+
+    static size_t levelBytes(CookedFormat format, int width, int height) {
+        if (format == CookedFormat::BC1) return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 8;
+        return (size_t)width * height;
+    }
+    static int levelCount(int width, int height) {
+        int levels = 1;
+        while (width > 1 || height > 1) { width = std::max(1, width / 2); height = std::max(1, height / 2); levels++; }
+        return levels;
+    }
+};
+
+namespace texture_cook {
+
+// 2x2 box filter to the next mip level; an odd last row or column is averaged with itself
+inline std::vector<uint8_t> downsample(const uint8_t* texels, int width, int height, int channels) {
+    int w = std::max(1, width / 2), h = std::max(1, height / 2);
+    std::vector<uint8_t> out((size_t)w * h * channels);
+    for (int y = 0; y < h; ++y) {
+        int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < w; ++x) {
+            int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < channels; ++c) {
+                int sum = texels[((size_t)y0 * width + x0) * channels + c] + texels[((size_t)y0 * width + x1) * channels + c]
+                    + texels[((size_t)y1 * width + x0) * channels + c] + texels[((size_t)y1 * width + x1) * channels + c];
+                out[((size_t)y * w + x) * channels + c] = (uint8_t)((sum + 2) / 4);
+            }
+        }
+    }
+    return out;
+}
+
+inline uint16_t packRgb565(const float* rgb) {
+    int r = std::min(31, std::max(0, (int)std::lround(rgb[0] * 31.0f / 255.0f)));
+    int g = std::min(63, std::max(0, (int)std::lround(rgb[1] * 63.0f / 255.0f)));
+    int b = std::min(31, std::max(0, (int)std::lround(rgb[2] * 31.0f / 255.0f)));
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void unpackRgb565(uint16_t packed, int* rgb) {
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    rgb[0] = (r << 3) | (r >> 2); rgb[1] = (g << 2) | (g >> 4); rgb[2] = (b << 3) | (b >> 2);
+}
+
+// The four colours a BC1 block with color0 > color1 selects from
+inline void bc1Palette(uint16_t color0, uint16_t color1, int palette[4][3]) {
+    unpackRgb565(color0, palette[0]);
+    unpackRgb565(color1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+}
+
+// 16 RGBA texels, row by row, into 8 bytes: the endpoints span the colours along their
+// principal axis (slightly inset, so rounding does not overshoot), and every texel takes
+// the nearest of the four palette entries. Always the opaque four-colour mode.
+inline void encodeBC1Block(const uint8_t* texels, uint8_t* out) {
+    float mean[3] = {};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c) mean[c] += texels[i * 4 + c] / 16.0f;
+    float xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+    for (int i = 0; i < 16; ++i) {
+        float d[3] = { texels[i * 4] - mean[0], texels[i * 4 + 1] - mean[1], texels[i * 4 + 2] - mean[2] };
+        xx += d[0] * d[0]; xy += d[0] * d[1]; xz += d[0] * d[2]; yy += d[1] * d[1]; yz += d[1] * d[2]; zz += d[2] * d[2];
+    }
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; ++iteration) { // Power iteration
+        float next[3] = { xx * axis[0] + xy * axis[1] + xz * axis[2], xy * axis[0] + yy * axis[1] + yz * axis[2], xz * axis[0] + yz * axis[1] + zz * axis[2] };
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f) break; // Flat block: any axis does
+        for (int c = 0; c < 3; ++c) axis[c] = next[c] / length;
+    }
+    float lo = 1e30f, hi = -1e30f;
+    for (int i = 0; i < 16; ++i) {
+        float t = (texels[i * 4] - mean[0]) * axis[0] + (texels[i * 4 + 1] - mean[1]) * axis[1] + (texels[i * 4 + 2] - mean[2]) * axis[2];
+        lo = std::min(lo, t); hi = std::max(hi, t);
+    }
+    float inset = (hi - lo) / 16.0f;
+    lo += inset; hi -= inset;
+    float end0[3], end1[3];
+    for (int c = 0; c < 3; ++c) { end0[c] = mean[c] + axis[c] * hi; end1[c] = mean[c] + axis[c] * lo; }
+    uint16_t color0 = packRgb565(end0), color1 = packRgb565(end1);
+    if (color0 < color1) std::swap(color0, color1);
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        bc1Palette(color0, color1, palette);
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestError = 1 << 30;
+            for (int p = 0; p < 4; ++p) {
+                int dr = texels[i * 4] - palette[p][0], dg = texels[i * 4 + 1] - palette[p][1], db = texels[i * 4 + 2] - palette[p][2];
+                int error = dr * dr + dg * dg + db * db;
+                if (error < bestError) { bestError = error; best = p; }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+    out[0] = (uint8_t)(color0 & 0xFF); out[1] = (uint8_t)(color0 >> 8);
+    out[2] = (uint8_t)(color1 & 0xFF); out[3] = (uint8_t)(color1 >> 8);
+    for (int b = 0; b < 4; ++b) out[4 + b] = (uint8_t)(indices >> (8 * b));
+}
+
+// A whole RGBA level; partial blocks at the right and bottom edges repeat the last texel
+inline std::vector<uint8_t> encodeBC1(const uint8_t* rgba, int width, int height) {
+    std::vector<uint8_t> out(CookedTexture::levelBytes(CookedFormat::BC1, width, height));
+    int blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+    uint8_t block[16 * 4];
+    for (int by = 0; by < blocksHigh; ++by)
+        for (int bx = 0; bx < blocksWide; ++bx) {
+            for (int i = 0; i < 16; ++i) {
+                int x = std::min(bx * 4 + i % 4, width - 1), y = std::min(by * 4 + i / 4, height - 1);
+                const uint8_t* texel = rgba + ((size_t)y * width + x) * 4;
+                for (int c = 0; c < 4; ++c) block[i * 4 + c] = texel[c];
+            }
+            encodeBC1Block(block, &out[((size_t)by * blocksWide + bx) * 8]);
+        }
+    return out;
+}
+
+// Back to RGBA, for drivers without S3TC
+inline std::vector<uint8_t> decodeBC1(const uint8_t* blocks, int width, int height) {
+    std::vector<uint8_t> rgba((size_t)width * height * 4);
+    int blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+    for (int by = 0; by < blocksHigh; ++by)
+        for (int bx = 0; bx < blocksWide; ++bx) {
+            const uint8_t* block = blocks + ((size_t)by * blocksWide + bx) * 8;
+            uint16_t color0 = (uint16_t)(block[0] | block[1] << 8), color1 = (uint16_t)(block[2] | block[3] << 8);
+            uint32_t indices = block[4] | block[5] << 8 | block[6] << 16 | (uint32_t)block[7] << 24;
+            int palette[4][3];
+            bc1Palette(color0, color1, palette);
+            if (color0 <= color1) // Three-colour mode; the cooker never writes it, but stay faithful
+                for (int c = 0; c < 3; ++c) { palette[2][c] = (palette[0][c] + palette[1][c]) / 2; palette[3][c] = 0; }
+            for (int i = 0; i < 16; ++i) {
+                int x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                if (x >= width || y >= height) continue;
+                const int* color = palette[(indices >> (2 * i)) & 3];
+                uint8_t* texel = &rgba[((size_t)y * width + x) * 4];
+                texel[0] = (uint8_t)color[0]; texel[1] = (uint8_t)color[1]; texel[2] = (uint8_t)color[2]; texel[3] = 255;
+            }
+        }
+    return rgba;
+}
+
+} // namespace texture_cook
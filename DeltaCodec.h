@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --- XOR/RLE delta codec ---
+// Encodes `cur` against `prev` (both n bytes) as (skip:u16, count:u16, xor bytes...) spans,
+// so bytes that did not change cost nothing. Applying the delta to a copy of `prev`
+// reproduces `cur` exactly, padding bytes included.
+
+inline void encodeXorDelta(const uint8_t* prev, const uint8_t* cur, size_t n, std::vector<uint8_t>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < n) {
+        size_t skip = 0;
+        while (i < n && prev[i] == cur[i] && skip < 0xFFFF) { i++; skip++; }
+        size_t start = i, run = 0;
+        while (i < n && prev[i] != cur[i] && run < 0xFFFF) { i++; run++; }
+        if (i == n && run == 0) break;
+        out.push_back((uint8_t)(skip & 0xFF)); out.push_back((uint8_t)(skip >> 8));
+        out.push_back((uint8_t)(run & 0xFF)); out.push_back((uint8_t)(run >> 8));
+        for (size_t j = 0; j < run; ++j) out.push_back(prev[start + j] ^ cur[start + j]);
+    }
+}
+
+// Returns false if the delta is malformed or would write past n bytes
+inline bool applyXorDelta(const uint8_t* delta, size_t size, uint8_t* state, size_t n) {
+    size_t pos = 0, i = 0;
+    while (i + 4 <= size) {
+        size_t skip = delta[i] | (delta[i + 1] << 8);
+        size_t run = delta[i + 2] | (delta[i + 3] << 8);
+        i += 4; pos += skip;
+        if (pos + run > n || i + run > size) return false;
+        for (size_t j = 0; j < run; ++j) state[pos + j] ^= delta[i + j];
+        i += run; pos += run;
+    }
+    return i == size;
+}
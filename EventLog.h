@@ -0,0 +1,178 @@
+#pragma once
+
+#include "RingBuffer.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// --- Event log ---
+// Structured records are pushed into a lock-free ring and written as JSONL by a
+// background thread, so the frame loop never touches the console or the disk.
+
+enum class EventType : uint8_t { Message, Score, Spawn, FrameStats, Memory };
+enum class LogLevel : uint8_t { Info, Warning, Error };
+
+struct ScoreEvent { int score; float x, y, z; };
+struct SpawnEvent { int spawned; int inFlight; };
+struct FrameStatsEvent { int frames; float avgMs; float maxMs; int parcels; int targets; };
+struct MemoryEvent { const char* tag; long long currentBytes; long long peakBytes; }; // tag must be a string literal
+
+struct EventRecord {
+    EventType type;
+    LogLevel level;
+    double time; // Seconds since the log was created
+    union {
+        ScoreEvent score;
+        SpawnEvent spawn;
+        FrameStatsEvent frame;
+        MemoryEvent memory;
+    };
+    char text[200];
+};
+
+class EventLog {
+public:
+    static EventLog& instance() {
+        static EventLog log;
+        return log;
+    }
+
+    ~EventLog() { stop(); }
+
+    void start(const char* path) {
+        if (running.load()) return;
+        file.open(path, std::ios::out | std::ios::trunc);
+        running.store(true);
+        writer = std::thread(&EventLog::run, this);
+    }
+
+    // Drains everything still queued before returning
+    void stop() {
+        if (!running.exchange(false)) return;
+        writer.join();
+        file.close();
+    }
+
+    void message(LogLevel level, const std::string& text) {
+        EventRecord r = make(EventType::Message, level);
+        size_t n = text.size() < sizeof(r.text) - 1 ? text.size() : sizeof(r.text) - 1;
+        memcpy(r.text, text.data(), n);
+        r.text[n] = '\0';
+        push(r);
+    }
+    void info(const std::string& text) { message(LogLevel::Info, text); }
+    void warning(const std::string& text) { message(LogLevel::Warning, text); }
+    void error(const std::string& text) { message(LogLevel::Error, text); }
+
+    void score(int score, const glm::vec3& pos) {
+        EventRecord r = make(EventType::Score, LogLevel::Info);
+        r.score = { score, pos.x, pos.y, pos.z };
+        push(r);
+    }
+
+    void spawn(int spawned, int inFlight) {
+        EventRecord r = make(EventType::Spawn, LogLevel::Info);
+        r.spawn = { spawned, inFlight };
+        push(r);
+    }
+
+    void frameStats(int frames, float avgMs, float maxMs, int parcels, int targets) {
+        EventRecord r = make(EventType::FrameStats, LogLevel::Info);
+        r.frame = { frames, avgMs, maxMs, parcels, targets };
+        push(r);
+    }
+
+    void memory(const char* tag, long long currentBytes, long long peakBytes) {
+        EventRecord r = make(EventType::Memory, LogLevel::Info);
+        r.memory = { tag, currentBytes, peakBytes };
+        push(r);
+    }
+
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    EventLog() : epoch(std::chrono::steady_clock::now()) {}
+
+    EventRecord make(EventType type, LogLevel level) const {
+        EventRecord r;
+        r.type = type;
+        r.level = level;
+        r.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count();
+        r.text[0] = '\0';
+        return r;
+    }
+
+    void push(const EventRecord& r) {
+        if (!queue.push(r)) dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void run() {
+        EventRecord r;
+        for (;;) {
+            bool stopping = !running.load();
+            bool wrote = false;
+            while (queue.pop(r)) { write(r); wrote = true; }
+            if (wrote) file.flush();
+            if (stopping) break;
+            if (!wrote) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    void write(const EventRecord& r) {
+        static const char* levelNames[] = { "info", "warning", "error" };
+        char line[512];
+        switch (r.type) {
+        case EventType::Message:
+            snprintf(line, sizeof(line), "{\"t\":%.4f,\"type\":\"message\",\"level\":\"%s\",\"text\":\"%s\"}",
+                r.time, levelNames[(int)r.level], escape(r.text).c_str());
+            // Warnings and errors still reach the console, just off the calling thread
+            if (r.level != LogLevel::Info) std::cerr << r.text << "\n";
+            break;
+        case EventType::Score:
+            snprintf(line, sizeof(line), "{\"t\":%.4f,\"type\":\"score\",\"score\":%d,\"pos\":[%.2f,%.2f,%.2f]}",
+                r.time, r.score.score, r.score.x, r.score.y, r.score.z);
+            std::cout << "HIT! Score: " << r.score.score << "\n";
+            break;
+        case EventType::Spawn:
+            snprintf(line, sizeof(line), "{\"t\":%.4f,\"type\":\"spawn\",\"spawned\":%d,\"inFlight\":%d}",
+                r.time, r.spawn.spawned, r.spawn.inFlight);
+            break;
+        case EventType::FrameStats:
+            snprintf(line, sizeof(line), "{\"t\":%.4f,\"type\":\"frame\",\"frames\":%d,\"avgMs\":%.3f,\"maxMs\":%.3f,\"parcels\":%d,\"targets\":%d}",
+                r.time, r.frame.frames, r.frame.avgMs, r.frame.maxMs, r.frame.parcels, r.frame.targets);
+            break;
+        case EventType::Memory:
+            snprintf(line, sizeof(line), "{\"t\":%.4f,\"type\":\"memory\",\"tag\":\"%s\",\"current\":%lld,\"peak\":%lld}",
+                r.time, r.memory.tag, r.memory.currentBytes, r.memory.peakBytes);
+            break;
+        }
+        if (file.is_open()) file << line << '\n';
+    }
+
+    static std::string escape(const char* s) {
+        std::string out;
+        for (; *s; ++s) {
+            unsigned char c = (unsigned char)*s;
+            if (c == '"' || c == '\\') { out += '\\'; out += (char)c; }
+            else if (c == '\n') out += "\\n";
+            else if (c < 0x20) { char buf[8]; snprintf(buf, sizeof(buf), "\\u%04x", c); out += buf; }
+            else out += (char)c;
+        }
+        return out;
+    }
+
+    MpscRing<EventRecord, 4096> queue;
+    std::atomic<bool> running{ false };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::chrono::steady_clock::time_point epoch;
+    std::ofstream file;
+    std::thread writer;
+};
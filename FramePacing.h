@@ -0,0 +1,187 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <SFML/System.hpp>
+#include <SFML/Window.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+// --- Frame pacing and input latency ---
+
+// Sleeps for the bulk of the wait and spins the rest: OS sleeps can overshoot by
+// about a scheduler tick, which is most of the slack a low-latency frame has.
+inline void preciseSleepUntil(const sf::Clock& clock, int64_t targetUs) {
+    const int64_t spinUs = 2000;
+    while (true) {
+        int64_t remaining = targetUs - clock.getElapsedTime().asMicroseconds();
+        if (remaining <= 0) return;
+        if (remaining > spinUs) sf::sleep(sf::microseconds(remaining - spinUs));
+        else std::this_thread::yield();
+    }
+}
+
+// Low-latency pacing: instead of sleeping after present (so the next frame samples
+// input that waited out the sleep), it sleeps before input is read, waking just in
+// time for the predicted work to finish by the frame deadline. Waiting for the GPU
+// after each frame keeps exactly one frame in flight, so the driver cannot queue
+// frames of stale input.
+class FramePacer {
+public:
+    explicit FramePacer(const sf::Clock& clock) : clock(clock) {}
+
+    void setTargetFps(float fps) { periodUs = (int64_t)(1e6f / fps); }
+
+    void waitForFrameStart() {
+        int64_t now = clock.getElapsedTime().asMicroseconds();
+        if (deadlineUs == 0 || now > deadlineUs) deadlineUs = now + periodUs; // Resync after a hitch
+        int64_t wake = deadlineUs - (int64_t)predictedWorkUs - marginUs;
+        preciseSleepUntil(clock, wake);
+        frameStartUs = clock.getElapsedTime().asMicroseconds();
+    }
+
+    // Call right after present
+    void waitForGpu() {
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 ms guard against a lost context
+        glDeleteSync(fence);
+        float work = (float)(clock.getElapsedTime().asMicroseconds() - frameStartUs);
+        // Jumps up at once, decays slowly, so one slow frame does not get a late start twice
+        predictedWorkUs = std::max(work, predictedWorkUs * 0.98f);
+        deadlineUs += periodUs;
+    }
+
+    float predictedWorkMs() const { return predictedWorkUs / 1000.0f; }
+
+private:
+    static const int64_t marginUs = 1000;
+
+    const sf::Clock& clock;
+    int64_t periodUs = 16667;
+    int64_t deadlineUs = 0;
+    int64_t frameStartUs = 0;
+    float predictedWorkUs = 4000.0f;
+};
+
+// Input-to-GPU latency. A probe thread polls the game keys at about 1 kHz and stamps
+// the first change since the last frame read input, so time spent queued before the
+// frame loop looked at the keyboard counts too. Each frame stamps a GPU timestamp
+// query after present; once the result is available it is mapped to the CPU clock and
+// compared with the input time. Scanout adds up to one refresh on top of this.
+class LatencyTracker {
+public:
+    static const int historySize = 120;
+    static const int queriesInFlight = 4;
+
+    explicit LatencyTracker(const sf::Clock& clock) : clock(clock) {}
+    ~LatencyTracker() { stop(); }
+
+    void start() {
+        glGenQueries(queriesInFlight, queries);
+        syncClocks();
+        running.store(true);
+        probe = std::thread(&LatencyTracker::probeLoop, this);
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        probe.join(); // The queries go with the context; it may already be gone here
+    }
+
+    // The frame has read its input; everything pressed so far is attributed to it
+    void inputSampled() { frameInputUs = pendingInputUs.exchange(-1); }
+
+    void framePresented() {
+        if (slots[head].pending) { head = (head + 1) % queriesInFlight; return; } // Ring full: skip measuring this frame
+        glQueryCounter(queries[head], GL_TIMESTAMP);
+        slots[head].pending = true;
+        slots[head].inputUs = frameInputUs;
+        frameInputUs = -1;
+        head = (head + 1) % queriesInFlight;
+    }
+
+    // Collects finished queries without stalling
+    void poll() {
+        int64_t now = clock.getElapsedTime().asMicroseconds();
+        if (now - lastSyncUs > 1000000) syncClocks(); // GPU and CPU clocks drift apart
+        for (int i = 0; i < queriesInFlight; ++i) {
+            Slot& slot = slots[i];
+            if (!slot.pending) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            GLuint64 gpuNs = 0;
+            glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &gpuNs);
+            slot.pending = false;
+            if (slot.inputUs < 0) continue;
+            int64_t doneUs = (int64_t)(gpuNs / 1000) + gpuToCpuUs;
+            record((doneUs - slot.inputUs) / 1000.0f);
+        }
+    }
+
+    float averageMs() const {
+        if (count == 0) return 0.0f;
+        float sum = 0.0f;
+        for (int i = 0; i < count; ++i) sum += history[i];
+        return sum / count;
+    }
+    float maxMs() const {
+        float worst = 0.0f;
+        for (int i = 0; i < count; ++i) worst = std::max(worst, history[i]);
+        return worst;
+    }
+    float lastMs() const { return last; }
+
+private:
+    struct Slot {
+        bool pending = false;
+        int64_t inputUs = -1;
+    };
+
+    void syncClocks() {
+        GLint64 gpuNs = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNs);
+        lastSyncUs = clock.getElapsedTime().asMicroseconds();
+        gpuToCpuUs = lastSyncUs - gpuNs / 1000;
+    }
+
+    void record(float ms) {
+        last = ms;
+        history[next] = ms;
+        next = (next + 1) % historySize;
+        if (count < historySize) count++;
+    }
+
+    void probeLoop() {
+        const sf::Keyboard::Key keys[] = { sf::Keyboard::W, sf::Keyboard::A, sf::Keyboard::S, sf::Keyboard::D, sf::Keyboard::Space, sf::Keyboard::LControl, sf::Keyboard::P };
+        const int keyCount = (int)(sizeof(keys) / sizeof(keys[0]));
+        bool down[keyCount] = {};
+        while (running.load()) {
+            bool changed = false;
+            for (int i = 0; i < keyCount; ++i) {
+                bool pressed = sf::Keyboard::isKeyPressed(keys[i]);
+                if (pressed != down[i]) { down[i] = pressed; changed = true; }
+            }
+            if (changed) {
+                int64_t expected = -1;
+                pendingInputUs.compare_exchange_strong(expected, clock.getElapsedTime().asMicroseconds());
+            }
+            sf::sleep(sf::milliseconds(1));
+        }
+    }
+
+    const sf::Clock& clock;
+    std::thread probe;
+    std::atomic<bool> running{ false };
+    std::atomic<int64_t> pendingInputUs{ -1 }; // Earliest input not yet read by a frame
+    int64_t frameInputUs = -1;
+    GLuint queries[queriesInFlight] = {};
+    Slot slots[queriesInFlight];
+    int head = 0;
+    int64_t gpuToCpuUs = 0, lastSyncUs = 0;
+    float history[historySize] = {};
+    int next = 0, count = 0;
+    float last = 0.0f;
+};
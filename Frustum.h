@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+// --- View frustum ---
+// Planes are extracted from the combined projection * view matrix (Gribb/Hartmann)
+// and normalized, so plane distances are in world units.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    Frustum() : planes() {} // All-zero planes: contains everything
+    explicit Frustum(const glm::mat4& m) {
+        for (int i = 0; i < 3; ++i) {
+            planes[i * 2] = row(m, 3) + row(m, i);
+            planes[i * 2 + 1] = row(m, 3) - row(m, i);
+        }
+        for (auto& p : planes) p = p * (1.0f / glm::length(glm::vec3(p)));
+    }
+
+    bool containsSphere(const glm::vec3& center, float radius) const {
+        for (const auto& p : planes)
+            if (glm::dot(glm::vec3(p), center) + p.w < -radius) return false;
+        return true;
+    }
+
+    bool containsBox(const glm::vec3& lo, const glm::vec3& hi) const {
+        for (const auto& p : planes) {
+            // Test the corner furthest along the plane normal
+            glm::vec3 v(p.x >= 0 ? hi.x : lo.x, p.y >= 0 ? hi.y : lo.y, p.z >= 0 ? hi.z : lo.z);
+            if (glm::dot(glm::vec3(p), v) + p.w < 0) return false;
+        }
+        return true;
+    }
+
+private:
+    static glm::vec4 row(const glm::mat4& m, int r) { return glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]); }
+};
+
+// --- View set ---
+// Views rendered from the same command lists. Each object is culled once against all
+// of them and recorded once, tagged with a mask of the views it reaches (bit i for
+// view i); view 0 is the main view.
+struct ViewSet {
+    static const int maxViews = 2;
+    Frustum frustums[maxViews];
+    int count = 0;
+
+    void clear() { count = 0; }
+    void add(const Frustum& frustum) { frustums[count++] = frustum; }
+
+    uint8_t sphereMask(const glm::vec3& center, float radius) const {
+        uint8_t mask = 0;
+        for (int i = 0; i < count; ++i) if (frustums[i].containsSphere(center, radius)) mask |= 1 << i;
+        return mask;
+    }
+
+    uint8_t boxMask(const glm::vec3& lo, const glm::vec3& hi) const {
+        uint8_t mask = 0;
+        for (int i = 0; i < count; ++i) if (frustums[i].containsBox(lo, hi)) mask |= 1 << i;
+        return mask;
+    }
+};
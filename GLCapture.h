@@ -0,0 +1,1289 @@
+#pragma once
+
+#include "EventLog.h"
+#include "MemoryTracker.h"
+#include "RenderState.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// --- GL capture ---
+// An interception layer over the GL calls the program makes, for measuring driver and
+// submission cost without the game around it. install() swaps glad's function pointers
+// for hooks that forward to the driver and keep a shadow of every buffer, vertex array,
+// texture, framebuffer, program and query (data included), so it has to run before the
+// first resource is created and costs nothing when it is not installed. Between
+// beginFrame() and endFrame() the draw, bind, state, uniform and buffer calls are also
+// encoded into a compact command stream; endFrame() writes it together with the shadows
+// of the objects the frame touched and the state it started from. GLReplay loads such
+// a file, recreates the objects and plays the frame back as often as asked.
+//
+// File: "GLC2", width, height, then programs, buffers, textures, vertex arrays,
+// framebuffers and queries, then the prologue and frame streams. A stream is a list of
+// ops: a GLCaptureOp byte and its arguments, names as recorded (replay maps them).
+
+enum class GLCaptureOp : uint8_t {
+    UseProgram, BindVertexArray, ActiveTexture, BindTexture, BindBuffer, BindBufferBase, BindFramebuffer,
+    Viewport, Clear, ClearColor, Enable, Disable, DepthMask, ColorMask, BlendFunc, PrimitiveRestartIndex, VertexAttrib1f,
+    Uniform1i, Uniform1f, Uniform2i, Uniform2fv, Uniform3fv, UniformMatrix4fv,
+    BufferData, BufferSubData, TexSubImage2D, TextureSubImage2D,
+    DrawElements, DrawElementsInstanced, DrawArrays, BeginQuery, EndQuery, BeginConditionalRender, EndConditionalRender,
+    BlitFramebuffer, Count
+};
+
+inline const char* glCaptureOpName(GLCaptureOp op) {
+    static const char* names[] = {
+        "UseProgram", "BindVertexArray", "ActiveTexture", "BindTexture", "BindBuffer", "BindBufferBase", "BindFramebuffer",
+        "Viewport", "Clear", "ClearColor", "Enable", "Disable", "DepthMask", "ColorMask", "BlendFunc", "PrimitiveRestartIndex", "VertexAttrib1f",
+        "Uniform1i", "Uniform1f", "Uniform2i", "Uniform2fv", "Uniform3fv", "UniformMatrix4fv",
+        "BufferData", "BufferSubData", "TexSubImage2D", "TextureSubImage2D",
+        "DrawElements", "DrawElementsInstanced", "DrawArrays", "BeginQuery", "EndQuery", "BeginConditionalRender", "EndConditionalRender",
+        "BlitFramebuffer" };
+    return (int)op < (int)GLCaptureOp::Count ? names[(int)op] : "?";
+}
+
+// Little-endian scalars and length-prefixed blobs
+struct GLCaptureWriter {
+    std::vector<uint8_t> bytes;
+
+    void raw(const void* data, size_t size) { const uint8_t* p = static_cast<const uint8_t*>(data); bytes.insert(bytes.end(), p, p + size); }
+    void op(GLCaptureOp o) { bytes.push_back((uint8_t)o); }
+    void u8(uint8_t v) { bytes.push_back(v); }
+    void u32(uint32_t v) { raw(&v, 4); }
+    void i32(int32_t v) { raw(&v, 4); }
+    void f32(float v) { raw(&v, 4); }
+    void blob(const void* data, size_t size) { u32((uint32_t)size); if (size) raw(data, size); }
+    void str(const std::string& s) { blob(s.data(), s.size()); }
+};
+
+struct GLCaptureReader {
+    const uint8_t* p = nullptr;
+    const uint8_t* end = nullptr;
+    bool failed = false;
+
+    bool take(void* out, size_t size) {
+        if ((size_t)(end - p) < size) { failed = true; memset(out, 0, size); return false; }
+        memcpy(out, p, size);
+        p += size;
+        return true;
+    }
+    uint8_t u8() { uint8_t v; take(&v, 1); return v; }
+    uint32_t u32() { uint32_t v; take(&v, 4); return v; }
+    int32_t i32() { int32_t v; take(&v, 4); return v; }
+    float f32() { float v; take(&v, 4); return v; }
+    // Points into the file; size 0 gives nullptr
+    const uint8_t* blob(uint32_t& size) {
+        size = u32();
+        if ((size_t)(end - p) < size) { failed = true; size = 0; return nullptr; }
+        const uint8_t* data = size ? p : nullptr;
+        p += size;
+        return data;
+    }
+    std::string str() { uint32_t size; const uint8_t* data = blob(size); return std::string(reinterpret_cast<const char*>(data ? data : p), size); }
+};
+
+class GLCapture {
+public:
+    static const int maxAttribs = 16;
+
+    static GLCapture& instance() {
+        static GLCapture capture;
+        return capture;
+    }
+
+    // Right after gladLoadGL, before anything creates GL objects
+    void install();
+    bool installed() const { return active; }
+
+    // Calls from here to endFrame() are recorded. The state cache is reset so the frame
+    // binds everything it uses instead of relying on binds from earlier frames.
+    void beginFrame(int width, int height) {
+        if (!active) return;
+        FrameAllocationGuard::Exempt exempt;
+        frame.bytes.clear();
+        frame.bytes.reserve(1 << 20);
+        frameWidth = width; frameHeight = height;
+        usedPrograms.clear(); usedVaos.clear(); usedTextures.clear(); usedBuffers.clear(); usedFramebuffers.clear(); usedQueries.clear();
+        // The state the frame starts from, replayed before it
+        startState = context;
+        startBuffers.clear();
+        startTextures.clear();
+        startUniforms.clear();
+        for (const auto& it : programs) startUniforms[it.first] = it.second.uniformValues;
+        glState().invalidate();
+        capturing = true;
+    }
+
+    // Writes the frame and the objects it used; returns false if the file could not be written
+    bool endFrame(const char* path) {
+        if (!capturing) return false;
+        capturing = false;
+        FrameAllocationGuard::Exempt exempt;
+        // Objects reached through the ones bound directly
+        for (uint32_t vao : usedVaos) {
+            auto it = vaos.find(vao);
+            if (it == vaos.end()) continue;
+            if (it->second.elementBuffer) usedBuffers.insert(it->second.elementBuffer);
+            for (int a = 0; a < maxAttribs; ++a) {
+                uint32_t buffer = resolvedAttrib(it->second, a).buffer;
+                if (it->second.attribs[a].enabled && buffer) usedBuffers.insert(buffer);
+            }
+        }
+        for (uint32_t fbo : usedFramebuffers) {
+            auto it = framebuffers.find(fbo);
+            if (it == framebuffers.end()) continue;
+            for (const Attachment& a : it->second.attachments) usedTextures.insert(a.texture);
+        }
+
+        GLCaptureWriter out;
+        out.raw("GLC2", 4);
+        out.i32(frameWidth); out.i32(frameHeight);
+        writePrograms(out);
+        writeBuffers(out);
+        writeTextures(out);
+        writeVaos(out);
+        writeFramebuffers(out);
+        out.u32((uint32_t)usedQueries.size());
+        for (uint32_t q : usedQueries) { out.u32(q); out.u32(queryTargets.count(q) ? queryTargets[q] : GL_ANY_SAMPLES_PASSED); }
+        GLCaptureWriter prologue;
+        writePrologue(prologue);
+        out.blob(prologue.bytes.data(), prologue.bytes.size());
+        out.blob(frame.bytes.data(), frame.bytes.size());
+
+        FILE* f = fopen(path, "wb");
+        if (!f) { EventLog::instance().warning(std::string("Could not write GL capture ") + path); return false; }
+        fwrite(out.bytes.data(), 1, out.bytes.size(), f);
+        fclose(f);
+        char line[200];
+        snprintf(line, sizeof(line), "GL capture: %s, %.1f KB of commands, %.1f MB total, %d programs, %d vertex arrays, %d buffers, %d textures",
+            path, frame.bytes.size() / 1024.0f, out.bytes.size() / 1048576.0f, (int)usedPrograms.size(), (int)usedVaos.size(), (int)usedBuffers.size(), (int)usedTextures.size());
+        EventLog::instance().info(line);
+        return true;
+    }
+
+    bool capturingFrame() const { return capturing; }
+
+private:
+    // --- Shadows of the objects the program creates ---
+    struct Attrib {
+        bool enabled = false;
+        int size = 4;
+        uint32_t type = GL_FLOAT;
+        bool normalized = false;
+        int stride = 0;
+        uint32_t offset = 0;  // Byte offset, relative to the binding's when binding >= 0
+        uint32_t buffer = 0;
+        int binding = -1;     // DSA vertex buffer binding, -1 for glVertexAttribPointer
+        uint32_t divisor = 0;
+    };
+    struct Binding { uint32_t buffer = 0, offset = 0; int stride = 0; };
+    struct Vao {
+        Attrib attribs[maxAttribs];
+        Binding bindings[maxAttribs];
+        uint32_t elementBuffer = 0;
+    };
+    struct Buffer {
+        std::vector<uint8_t> data;
+        uint32_t usage = GL_STATIC_DRAW;
+    };
+    struct Texture {
+        uint32_t target = GL_TEXTURE_2D;
+        int internalFormat = GL_RGBA8, width = 0, height = 0, samples = 0;
+        uint32_t format = GL_RGBA, type = GL_UNSIGNED_BYTE;
+        bool mipmaps = false;
+        int params[4] = { GL_NEAREST_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT, GL_REPEAT }; // Min, mag, wrap s, wrap t
+        std::vector<uint8_t> pixels; // Base level, rows aligned to 4 bytes; empty if never uploaded
+        std::vector<std::vector<uint8_t>> compressedLevels; // Every level instead, if uploaded compressed
+    };
+    struct Attachment { uint32_t point, textarget, texture; };
+    struct Framebuffer {
+        std::vector<Attachment> attachments;
+        std::vector<uint32_t> drawBuffers; // Empty: default; GL_NONE alone: no color
+        uint32_t readBuffer = GL_COLOR_ATTACHMENT0;
+    };
+    struct Program {
+        std::vector<std::pair<uint32_t, std::string>> shaders; // Stage and source, if compiled here
+        uint32_t binaryFormat = 0;
+        std::vector<uint8_t> binary; // If loaded with glProgramBinary
+        std::map<int, std::string> uniformNames;
+        std::map<int, std::vector<uint8_t>> uniformValues; // Encoded as the op that set them
+    };
+    // Context state that outlives a frame and is replayed before it
+    struct ContextState {
+        std::map<uint32_t, bool> caps;
+        uint32_t blend[2] = { GL_ONE, GL_ZERO };
+        uint8_t depthMask = 1, colorMask[4] = { 1, 1, 1, 1 };
+        float clearColor[4] = { 0, 0, 0, 0 };
+        uint32_t restartIndex = 0;
+        bool restartIndexSet = false;
+        std::map<uint32_t, float> genericAttribs;
+    };
+
+    // Driver entry points the hooks forward to
+    struct RealGL {
+        PFNGLGENBUFFERSPROC GenBuffers; PFNGLCREATEBUFFERSPROC CreateBuffers; PFNGLDELETEBUFFERSPROC DeleteBuffers;
+        PFNGLBINDBUFFERPROC BindBuffer; PFNGLBINDBUFFERBASEPROC BindBufferBase; PFNGLBUFFERDATAPROC BufferData;
+        PFNGLBUFFERSUBDATAPROC BufferSubData; PFNGLNAMEDBUFFERSTORAGEPROC NamedBufferStorage;
+        PFNGLGENVERTEXARRAYSPROC GenVertexArrays; PFNGLCREATEVERTEXARRAYSPROC CreateVertexArrays; PFNGLDELETEVERTEXARRAYSPROC DeleteVertexArrays;
+        PFNGLBINDVERTEXARRAYPROC BindVertexArray; PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+        PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer; PFNGLVERTEXATTRIBDIVISORPROC VertexAttribDivisor;
+        PFNGLENABLEVERTEXARRAYATTRIBPROC EnableVertexArrayAttrib; PFNGLVERTEXARRAYATTRIBFORMATPROC VertexArrayAttribFormat;
+        PFNGLVERTEXARRAYATTRIBBINDINGPROC VertexArrayAttribBinding; PFNGLVERTEXARRAYVERTEXBUFFERPROC VertexArrayVertexBuffer;
+        PFNGLVERTEXARRAYELEMENTBUFFERPROC VertexArrayElementBuffer;
+        PFNGLGENTEXTURESPROC GenTextures; PFNGLCREATETEXTURESPROC CreateTextures; PFNGLDELETETEXTURESPROC DeleteTextures;
+        PFNGLBINDTEXTUREPROC BindTexture; PFNGLACTIVETEXTUREPROC ActiveTexture; PFNGLTEXIMAGE2DPROC TexImage2D;
+        PFNGLTEXIMAGE2DMULTISAMPLEPROC TexImage2DMultisample; PFNGLTEXTURESTORAGE2DPROC TextureStorage2D;
+        PFNGLTEXSUBIMAGE2DPROC TexSubImage2D; PFNGLTEXTURESUBIMAGE2DPROC TextureSubImage2D;
+        PFNGLTEXPARAMETERIPROC TexParameteri; PFNGLTEXTUREPARAMETERIPROC TextureParameteri;
+        PFNGLGENERATEMIPMAPPROC GenerateMipmap; PFNGLGENERATETEXTUREMIPMAPPROC GenerateTextureMipmap;
+        PFNGLCOMPRESSEDTEXIMAGE2DPROC CompressedTexImage2D; PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC CompressedTextureSubImage2D;
+        PFNGLPIXELSTOREIPROC PixelStorei;
+        PFNGLGENFRAMEBUFFERSPROC GenFramebuffers; PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers; PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
+        PFNGLFRAMEBUFFERTEXTURE2DPROC FramebufferTexture2D; PFNGLDRAWBUFFERSPROC DrawBuffers; PFNGLDRAWBUFFERPROC DrawBuffer;
+        PFNGLREADBUFFERPROC ReadBuffer;
+        PFNGLCREATESHADERPROC CreateShader; PFNGLSHADERSOURCEPROC ShaderSource; PFNGLATTACHSHADERPROC AttachShader;
+        PFNGLLINKPROGRAMPROC LinkProgram; PFNGLPROGRAMBINARYPROC ProgramBinary; PFNGLDELETEPROGRAMPROC DeleteProgram;
+        PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation; PFNGLUSEPROGRAMPROC UseProgram;
+        PFNGLUNIFORM1IPROC Uniform1i; PFNGLUNIFORM1FPROC Uniform1f; PFNGLUNIFORM2IPROC Uniform2i;
+        PFNGLUNIFORM2FVPROC Uniform2fv; PFNGLUNIFORM3FVPROC Uniform3fv; PFNGLUNIFORMMATRIX4FVPROC UniformMatrix4fv;
+        PFNGLGENQUERIESPROC GenQueries; PFNGLBEGINQUERYPROC BeginQuery; PFNGLENDQUERYPROC EndQuery;
+        PFNGLBEGINCONDITIONALRENDERPROC BeginConditionalRender; PFNGLENDCONDITIONALRENDERPROC EndConditionalRender;
+        PFNGLDRAWELEMENTSPROC DrawElements; PFNGLDRAWELEMENTSINSTANCEDPROC DrawElementsInstanced; PFNGLDRAWARRAYSPROC DrawArrays;
+        PFNGLENABLEPROC Enable; PFNGLDISABLEPROC Disable; PFNGLDEPTHMASKPROC DepthMask; PFNGLCOLORMASKPROC ColorMask;
+        PFNGLBLENDFUNCPROC BlendFunc; PFNGLCLEARCOLORPROC ClearColor; PFNGLCLEARPROC Clear; PFNGLVIEWPORTPROC Viewport;
+        PFNGLBLITFRAMEBUFFERPROC BlitFramebuffer; PFNGLPRIMITIVERESTARTINDEXPROC PrimitiveRestartIndex;
+        PFNGLVERTEXATTRIB1FPROC VertexAttrib1f;
+    };
+
+    static GLCapture& self() { return instance(); }
+
+    static size_t pixelBytes(uint32_t format, uint32_t type) {
+        if (type == GL_UNSIGNED_INT_24_8) return 4;
+        size_t channels = format == GL_RED ? 1 : format == GL_RG ? 2 : format == GL_RGB ? 3 : 4;
+        return channels * ((type == GL_UNSIGNED_BYTE || type == GL_BYTE) ? 1 : 4);
+    }
+
+    // Rows padded to the default unpack alignment of 4
+    static size_t imageBytes(uint32_t format, uint32_t type, int width, int height) {
+        return (((size_t)width * pixelBytes(format, type) + 3) & ~(size_t)3) * height;
+    }
+
+    // Uploaded pixels as rows aligned to 4, whatever the unpack alignment they came with
+    const void* alignedRows(uint32_t format, uint32_t type, int width, int height, const void* pixels) {
+        if (!pixels || unpackAlignment == 4) return pixels;
+        size_t row = (size_t)width * pixelBytes(format, type);
+        size_t from = (row + unpackAlignment - 1) / unpackAlignment * unpackAlignment, to = (row + 3) & ~(size_t)3;
+        repacked.assign(to * height, 0);
+        for (int y = 0; y < height; ++y) memcpy(&repacked[y * to], static_cast<const uint8_t*>(pixels) + y * from, row);
+        return repacked.data();
+    }
+
+    Attrib resolvedAttrib(const Vao& vao, int index) const {
+        Attrib a = vao.attribs[index];
+        if (a.binding >= 0) {
+            const Binding& b = vao.bindings[a.binding];
+            a.buffer = b.buffer;
+            a.offset += b.offset;
+            a.stride = b.stride;
+        }
+        return a;
+    }
+
+    uint32_t boundBuffer(uint32_t target) const {
+        if (target == GL_ELEMENT_ARRAY_BUFFER) {
+            auto it = vaos.find(currentVao);
+            return it != vaos.end() ? it->second.elementBuffer : 0;
+        }
+        auto it = boundBuffers.find(target);
+        return it != boundBuffers.end() ? it->second : 0;
+    }
+
+    uint32_t boundTexture(uint32_t target) const {
+        auto it = boundTextures.find(activeUnit * 65536u + (target & 0xFFFF));
+        return it != boundTextures.end() ? it->second : 0;
+    }
+
+    void copyImage(Texture& t, int x, int y, int width, int height, uint32_t format, uint32_t type, const void* pixels) {
+        if (!pixels) return;
+        if (t.pixels.empty() || x < 0 || y < 0 || x + width > t.width || y + height > t.height || format != t.format || type != t.type) {
+            if (x != 0 || y != 0 || width != t.width || height != t.height) return; // Partial update of an unknown layout
+            t.format = format; t.type = type;
+            t.pixels.assign(static_cast<const uint8_t*>(pixels), static_cast<const uint8_t*>(pixels) + imageBytes(format, type, width, height));
+            return;
+        }
+        size_t dstRow = imageBytes(format, type, t.width, 1), srcRow = imageBytes(format, type, width, 1);
+        size_t pixel = pixelBytes(format, type);
+        for (int row = 0; row < height; ++row)
+            memcpy(&t.pixels[(size_t)(y + row) * dstRow + x * pixel], static_cast<const uint8_t*>(pixels) + row * srcRow, width * pixel);
+    }
+
+    // Objects the frame writes to are saved first, so the file holds them as the frame found them
+    Buffer& bufferForWrite(uint32_t name) {
+        Buffer& b = buffers[name];
+        if (capturing && !startBuffers.count(name)) startBuffers[name] = b;
+        return b;
+    }
+    Texture& textureForWrite(uint32_t name) {
+        Texture& t = textures[name];
+        if (capturing && !startTextures.count(name)) startTextures[name] = t;
+        return t;
+    }
+
+    template <typename T>
+    static const T* atFrameStart(const std::unordered_map<uint32_t, T>& saved, const std::unordered_map<uint32_t, T>& current, uint32_t name) {
+        auto it = saved.find(name);
+        if (it != saved.end()) return &it->second;
+        it = current.find(name);
+        return it != current.end() ? &it->second : nullptr;
+    }
+
+    void setUniform(int location, const GLCaptureWriter& op) {
+        if (location < 0) return;
+        auto it = programs.find(currentProgram);
+        if (it != programs.end()) it->second.uniformValues[location] = op.bytes;
+        if (capturing) frame.raw(op.bytes.data(), op.bytes.size());
+    }
+
+    // --- Hooks ---
+    static void APIENTRY hookGenBuffers(GLsizei n, GLuint* names) {
+        self().real.GenBuffers(n, names);
+        for (int i = 0; i < n; ++i) self().buffers[names[i]];
+    }
+    static void APIENTRY hookCreateBuffers(GLsizei n, GLuint* names) {
+        self().real.CreateBuffers(n, names);
+        for (int i = 0; i < n; ++i) self().buffers[names[i]];
+    }
+    static void APIENTRY hookDeleteBuffers(GLsizei n, const GLuint* names) {
+        for (int i = 0; i < n; ++i) self().buffers.erase(names[i]);
+        self().real.DeleteBuffers(n, names);
+    }
+    static void APIENTRY hookBindBuffer(GLenum target, GLuint buffer) {
+        GLCapture& c = self();
+        c.real.BindBuffer(target, buffer);
+        if (target == GL_ELEMENT_ARRAY_BUFFER) { auto it = c.vaos.find(c.currentVao); if (it != c.vaos.end()) it->second.elementBuffer = buffer; }
+        else c.boundBuffers[target] = buffer;
+        if (c.capturing) { c.frame.op(GLCaptureOp::BindBuffer); c.frame.u32(target); c.frame.u32(buffer); if (buffer) c.usedBuffers.insert(buffer); }
+    }
+    static void APIENTRY hookBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        GLCapture& c = self();
+        c.real.BindBufferBase(target, index, buffer);
+        c.boundBuffers[target] = buffer;
+        if (c.capturing) { c.frame.op(GLCaptureOp::BindBufferBase); c.frame.u32(target); c.frame.u32(index); c.frame.u32(buffer); if (buffer) c.usedBuffers.insert(buffer); }
+    }
+    static void APIENTRY hookBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+        GLCapture& c = self();
+        c.real.BufferData(target, size, data, usage);
+        Buffer& b = c.bufferForWrite(c.boundBuffer(target));
+        b.usage = usage;
+        if (data) b.data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+        else b.data.assign((size_t)size, 0);
+        if (c.capturing) {
+            c.frame.op(GLCaptureOp::BufferData); c.frame.u32(target); c.frame.u32((uint32_t)size); c.frame.u32(usage);
+            c.frame.u8(data ? 1 : 0);
+            if (data) c.frame.raw(data, (size_t)size);
+        }
+    }
+    static void APIENTRY hookBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+        GLCapture& c = self();
+        c.real.BufferSubData(target, offset, size, data);
+        Buffer& b = c.bufferForWrite(c.boundBuffer(target));
+        if ((size_t)(offset + size) <= b.data.size()) memcpy(&b.data[(size_t)offset], data, (size_t)size);
+        if (c.capturing) { c.frame.op(GLCaptureOp::BufferSubData); c.frame.u32(target); c.frame.u32((uint32_t)offset); c.frame.blob(data, (size_t)size); }
+    }
+    static void APIENTRY hookNamedBufferStorage(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags) {
+        GLCapture& c = self();
+        c.real.NamedBufferStorage(buffer, size, data, flags);
+        Buffer& b = c.buffers[buffer];
+        if (data) b.data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+        else b.data.assign((size_t)size, 0);
+    }
+
+    static void APIENTRY hookGenVertexArrays(GLsizei n, GLuint* names) {
+        self().real.GenVertexArrays(n, names);
+        for (int i = 0; i < n; ++i) self().vaos[names[i]] = Vao();
+    }
+    static void APIENTRY hookCreateVertexArrays(GLsizei n, GLuint* names) {
+        self().real.CreateVertexArrays(n, names);
+        for (int i = 0; i < n; ++i) self().vaos[names[i]] = Vao();
+    }
+    static void APIENTRY hookDeleteVertexArrays(GLsizei n, const GLuint* names) {
+        for (int i = 0; i < n; ++i) self().vaos.erase(names[i]);
+        self().real.DeleteVertexArrays(n, names);
+    }
+    static void APIENTRY hookBindVertexArray(GLuint vao) {
+        GLCapture& c = self();
+        c.real.BindVertexArray(vao);
+        c.currentVao = vao;
+        if (c.capturing) { c.frame.op(GLCaptureOp::BindVertexArray); c.frame.u32(vao); if (vao) c.usedVaos.insert(vao); }
+    }
+    static void APIENTRY hookEnableVertexAttribArray(GLuint index) {
+        self().real.EnableVertexAttribArray(index);
+        if (index < (GLuint)maxAttribs) self().vaos[self().currentVao].attribs[index].enabled = true;
+    }
+    static void APIENTRY hookVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {
+        GLCapture& c = self();
+        c.real.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+        if (index >= (GLuint)maxAttribs) return;
+        Attrib& a = c.vaos[c.currentVao].attribs[index];
+        a.size = size; a.type = type; a.normalized = normalized != 0; a.stride = stride;
+        a.offset = (uint32_t)reinterpret_cast<uintptr_t>(pointer);
+        a.buffer = c.boundBuffer(GL_ARRAY_BUFFER);
+        a.binding = -1;
+    }
+    static void APIENTRY hookVertexAttribDivisor(GLuint index, GLuint divisor) {
+        self().real.VertexAttribDivisor(index, divisor);
+        if (index < (GLuint)maxAttribs) self().vaos[self().currentVao].attribs[index].divisor = divisor;
+    }
+    static void APIENTRY hookEnableVertexArrayAttrib(GLuint vao, GLuint index) {
+        self().real.EnableVertexArrayAttrib(vao, index);
+        if (index < (GLuint)maxAttribs) self().vaos[vao].attribs[index].enabled = true;
+    }
+    static void APIENTRY hookVertexArrayAttribFormat(GLuint vao, GLuint index, GLint size, GLenum type, GLboolean normalized, GLuint relativeOffset) {
+        self().real.VertexArrayAttribFormat(vao, index, size, type, normalized, relativeOffset);
+        if (index >= (GLuint)maxAttribs) return;
+        Attrib& a = self().vaos[vao].attribs[index];
+        a.size = size; a.type = type; a.normalized = normalized != 0; a.offset = relativeOffset;
+        if (a.binding < 0) a.binding = (int)index; // The default binding of an attribute is its own index
+    }
+    static void APIENTRY hookVertexArrayAttribBinding(GLuint vao, GLuint index, GLuint binding) {
+        self().real.VertexArrayAttribBinding(vao, index, binding);
+        if (index < (GLuint)maxAttribs && binding < (GLuint)maxAttribs) self().vaos[vao].attribs[index].binding = (int)binding;
+    }
+    static void APIENTRY hookVertexArrayVertexBuffer(GLuint vao, GLuint binding, GLuint buffer, GLintptr offset, GLsizei stride) {
+        self().real.VertexArrayVertexBuffer(vao, binding, buffer, offset, stride);
+        if (binding >= (GLuint)maxAttribs) return;
+        Binding& b = self().vaos[vao].bindings[binding];
+        b.buffer = buffer; b.offset = (uint32_t)offset; b.stride = stride;
+    }
+    static void APIENTRY hookVertexArrayElementBuffer(GLuint vao, GLuint buffer) {
+        self().real.VertexArrayElementBuffer(vao, buffer);
+        self().vaos[vao].elementBuffer = buffer;
+    }
+
+    static void APIENTRY hookGenTextures(GLsizei n, GLuint* names) {
+        self().real.GenTextures(n, names);
+        for (int i = 0; i < n; ++i) self().textures[names[i]] = Texture();
+    }
+    static void APIENTRY hookCreateTextures(GLenum target, GLsizei n, GLuint* names) {
+        self().real.CreateTextures(target, n, names);
+        for (int i = 0; i < n; ++i) { Texture t; t.target = target; self().textures[names[i]] = t; }
+    }
+    static void APIENTRY hookDeleteTextures(GLsizei n, const GLuint* names) {
+        for (int i = 0; i < n; ++i) self().textures.erase(names[i]);
+        self().real.DeleteTextures(n, names);
+    }
+    static void APIENTRY hookActiveTexture(GLenum unit) {
+        GLCapture& c = self();
+        c.real.ActiveTexture(unit);
+        c.activeUnit = unit - GL_TEXTURE0;
+        if (c.capturing) { c.frame.op(GLCaptureOp::ActiveTexture); c.frame.u32(unit); }
+    }
+    static void APIENTRY hookBindTexture(GLenum target, GLuint texture) {
+        GLCapture& c = self();
+        c.real.BindTexture(target, texture);
+        c.boundTextures[c.activeUnit * 65536u + (target & 0xFFFF)] = texture;
+        auto it = c.textures.find(texture);
+        if (it != c.textures.end()) it->second.target = target;
+        if (c.capturing) { c.frame.op(GLCaptureOp::BindTexture); c.frame.u32(target); c.frame.u32(texture); if (texture) c.usedTextures.insert(texture); }
+    }
+    static void APIENTRY hookTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) {
+        GLCapture& c = self();
+        c.real.TexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+        if (level != 0) { c.textures[c.boundTexture(target)].mipmaps = true; return; } // Replay rebuilds the levels from the base
+        pixels = c.alignedRows(format, type, width, height, pixels);
+        Texture& t = c.textures[c.boundTexture(target)];
+        t.target = target; t.internalFormat = internalFormat; t.width = width; t.height = height; t.samples = 0;
+        t.format = format; t.type = type;
+        t.pixels.clear();
+        c.copyImage(t, 0, 0, width, height, format, type, pixels);
+    }
+    static void APIENTRY hookTexImage2DMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height, GLboolean fixed) {
+        GLCapture& c = self();
+        c.real.TexImage2DMultisample(target, samples, internalFormat, width, height, fixed);
+        Texture& t = c.textures[c.boundTexture(target)];
+        t.target = target; t.internalFormat = internalFormat; t.width = width; t.height = height; t.samples = samples;
+        t.pixels.clear();
+    }
+    static void APIENTRY hookTextureStorage2D(GLuint texture, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height) {
+        self().real.TextureStorage2D(texture, levels, internalFormat, width, height);
+        Texture& t = self().textures[texture];
+        t.internalFormat = internalFormat; t.width = width; t.height = height; t.samples = 0; t.mipmaps = levels > 1;
+        if (internalFormat == GL_DEPTH24_STENCIL8) { t.format = GL_DEPTH_STENCIL; t.type = GL_UNSIGNED_INT_24_8; }
+    }
+    static void APIENTRY hookTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) {
+        GLCapture& c = self();
+        c.real.TexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+        pixels = c.alignedRows(format, type, width, height, pixels);
+        if (level == 0) c.copyImage(c.textureForWrite(c.boundTexture(target)), x, y, width, height, format, type, pixels);
+        if (c.capturing) {
+            c.frame.op(GLCaptureOp::TexSubImage2D); c.frame.u32(target); c.frame.i32(level);
+            c.frame.i32(x); c.frame.i32(y); c.frame.i32(width); c.frame.i32(height); c.frame.u32(format); c.frame.u32(type);
+            c.frame.blob(pixels, pixels ? imageBytes(format, type, width, height) : 0);
+        }
+    }
+    static void APIENTRY hookTextureSubImage2D(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) {
+        GLCapture& c = self();
+        c.real.TextureSubImage2D(texture, level, x, y, width, height, format, type, pixels);
+        pixels = c.alignedRows(format, type, width, height, pixels);
+        if (level == 0) c.copyImage(c.textureForWrite(texture), x, y, width, height, format, type, pixels);
+        if (c.capturing) {
+            c.frame.op(GLCaptureOp::TextureSubImage2D); c.frame.u32(texture); c.frame.i32(level);
+            c.frame.i32(x); c.frame.i32(y); c.frame.i32(width); c.frame.i32(height); c.frame.u32(format); c.frame.u32(type);
+            c.frame.blob(pixels, pixels ? imageBytes(format, type, width, height) : 0);
+            c.usedTextures.insert(texture);
+        }
+    }
+    static void textureParameter(Texture& t, GLenum name, GLint value) {
+        switch (name) {
+        case GL_TEXTURE_MIN_FILTER: t.params[0] = value; break;
+        case GL_TEXTURE_MAG_FILTER: t.params[1] = value; break;
+        case GL_TEXTURE_WRAP_S: t.params[2] = value; break;
+        case GL_TEXTURE_WRAP_T: t.params[3] = value; break;
+        default: break;
+        }
+    }
+    static void APIENTRY hookTexParameteri(GLenum target, GLenum name, GLint value) {
+        self().real.TexParameteri(target, name, value);
+        textureParameter(self().textures[self().boundTexture(target)], name, value);
+    }
+    static void APIENTRY hookTextureParameteri(GLuint texture, GLenum name, GLint value) {
+        self().real.TextureParameteri(texture, name, value);
+        textureParameter(self().textures[texture], name, value);
+    }
+    static void APIENTRY hookGenerateMipmap(GLenum target) {
+        self().real.GenerateMipmap(target);
+        self().textures[self().boundTexture(target)].mipmaps = true;
+    }
+    static void APIENTRY hookGenerateTextureMipmap(GLuint texture) {
+        self().real.GenerateTextureMipmap(texture);
+        self().textures[texture].mipmaps = true;
+    }
+    // Compressed data only comes with loading, so it is kept in the shadow but never recorded
+    static void compressedLevel(Texture& t, int level, GLsizei size, const void* data) {
+        if (!data || level < 0) return;
+        if ((int)t.compressedLevels.size() <= level) t.compressedLevels.resize(level + 1);
+        t.compressedLevels[level].assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    }
+    static void APIENTRY hookCompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei size, const void* data) {
+        GLCapture& c = self();
+        c.real.CompressedTexImage2D(target, level, internalFormat, width, height, border, size, data);
+        Texture& t = c.textures[c.boundTexture(target)];
+        if (level == 0) {
+            t.target = target; t.internalFormat = internalFormat; t.width = width; t.height = height; t.samples = 0;
+            t.pixels.clear(); t.compressedLevels.clear();
+        }
+        else t.mipmaps = true;
+        compressedLevel(t, level, size, data);
+    }
+    static void APIENTRY hookCompressedTextureSubImage2D(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLsizei size, const void* data) {
+        GLCapture& c = self();
+        c.real.CompressedTextureSubImage2D(texture, level, x, y, width, height, format, size, data);
+        Texture& t = c.textures[texture];
+        if (x == 0 && y == 0 && width == std::max(1, t.width >> level) && height == std::max(1, t.height >> level)) compressedLevel(t, level, size, data);
+    }
+    static void APIENTRY hookPixelStorei(GLenum name, GLint value) {
+        self().real.PixelStorei(name, value);
+        if (name == GL_UNPACK_ALIGNMENT) self().unpackAlignment = value; // Shadows and streams keep rows aligned to 4
+    }
+
+    static void APIENTRY hookGenFramebuffers(GLsizei n, GLuint* names) {
+        self().real.GenFramebuffers(n, names);
+        for (int i = 0; i < n; ++i) self().framebuffers[names[i]] = Framebuffer();
+    }
+    static void APIENTRY hookDeleteFramebuffers(GLsizei n, const GLuint* names) {
+        for (int i = 0; i < n; ++i) self().framebuffers.erase(names[i]);
+        self().real.DeleteFramebuffers(n, names);
+    }
+    static void APIENTRY hookBindFramebuffer(GLenum target, GLuint fbo) {
+        GLCapture& c = self();
+        c.real.BindFramebuffer(target, fbo);
+        if (target != GL_READ_FRAMEBUFFER) c.drawFramebuffer = fbo;
+        if (target != GL_DRAW_FRAMEBUFFER) c.readFramebuffer = fbo;
+        if (c.capturing) { c.frame.op(GLCaptureOp::BindFramebuffer); c.frame.u32(target); c.frame.u32(fbo); if (fbo) c.usedFramebuffers.insert(fbo); }
+    }
+    static void APIENTRY hookFramebufferTexture2D(GLenum target, GLenum point, GLenum textarget, GLuint texture, GLint level) {
+        GLCapture& c = self();
+        c.real.FramebufferTexture2D(target, point, textarget, texture, level);
+        Framebuffer& f = c.framebuffers[target == GL_READ_FRAMEBUFFER ? c.readFramebuffer : c.drawFramebuffer];
+        for (size_t i = 0; i < f.attachments.size(); ++i)
+            if (f.attachments[i].point == point) { f.attachments.erase(f.attachments.begin() + i); break; }
+        if (texture) f.attachments.push_back({ point, textarget, texture });
+    }
+    static void APIENTRY hookDrawBuffers(GLsizei n, const GLenum* buffers) {
+        self().real.DrawBuffers(n, buffers);
+        self().framebuffers[self().drawFramebuffer].drawBuffers.assign(buffers, buffers + n);
+    }
+    static void APIENTRY hookDrawBuffer(GLenum buffer) {
+        self().real.DrawBuffer(buffer);
+        self().framebuffers[self().drawFramebuffer].drawBuffers.assign(1, buffer);
+    }
+    static void APIENTRY hookReadBuffer(GLenum buffer) {
+        self().real.ReadBuffer(buffer);
+        self().framebuffers[self().readFramebuffer].readBuffer = buffer;
+    }
+
+    static GLuint APIENTRY hookCreateShader(GLenum type) {
+        GLuint shader = self().real.CreateShader(type);
+        self().shaders[shader] = std::make_pair((uint32_t)type, std::string());
+        return shader;
+    }
+    static void APIENTRY hookShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) {
+        self().real.ShaderSource(shader, count, strings, lengths);
+        std::string& source = self().shaders[shader].second;
+        source.clear();
+        for (int i = 0; i < count; ++i) source.append(strings[i], lengths && lengths[i] >= 0 ? (size_t)lengths[i] : strlen(strings[i]));
+    }
+    static void APIENTRY hookAttachShader(GLuint program, GLuint shader) {
+        self().real.AttachShader(program, shader);
+        self().programs[program].shaders.push_back(self().shaders[shader]);
+    }
+    static void APIENTRY hookLinkProgram(GLuint program) {
+        self().real.LinkProgram(program);
+        self().programs[program].binary.clear();
+    }
+    static void APIENTRY hookProgramBinary(GLuint program, GLenum format, const void* binary, GLsizei length) {
+        self().real.ProgramBinary(program, format, binary, length);
+        Program& p = self().programs[program];
+        p.binaryFormat = format;
+        p.binary.assign(static_cast<const uint8_t*>(binary), static_cast<const uint8_t*>(binary) + length);
+    }
+    static void APIENTRY hookDeleteProgram(GLuint program) {
+        self().programs.erase(program);
+        self().real.DeleteProgram(program);
+    }
+    static GLint APIENTRY hookGetUniformLocation(GLuint program, const GLchar* name) {
+        GLint location = self().real.GetUniformLocation(program, name);
+        if (location >= 0) {
+            std::map<int, std::string>& names = self().programs[program].uniformNames;
+            if (!names.count(location)) names[location] = name;
+        }
+        return location;
+    }
+    static void APIENTRY hookUseProgram(GLuint program) {
+        GLCapture& c = self();
+        c.real.UseProgram(program);
+        c.currentProgram = program;
+        if (c.capturing) { c.frame.op(GLCaptureOp::UseProgram); c.frame.u32(program); if (program) c.usedPrograms.insert(program); }
+    }
+    static void APIENTRY hookUniform1i(GLint location, GLint v) {
+        GLCapture& c = self();
+        c.real.Uniform1i(location, v);
+        c.scratch.bytes.clear(); c.scratch.op(GLCaptureOp::Uniform1i); c.scratch.i32(location); c.scratch.i32(v);
+        c.setUniform(location, c.scratch);
+    }
+    static void APIENTRY hookUniform1f(GLint location, GLfloat v) {
+        GLCapture& c = self();
+        c.real.Uniform1f(location, v);
+        c.scratch.bytes.clear(); c.scratch.op(GLCaptureOp::Uniform1f); c.scratch.i32(location); c.scratch.f32(v);
+        c.setUniform(location, c.scratch);
+    }
+    static void APIENTRY hookUniform2i(GLint location, GLint x, GLint y) {
+        GLCapture& c = self();
+        c.real.Uniform2i(location, x, y);
+        c.scratch.bytes.clear(); c.scratch.op(GLCaptureOp::Uniform2i); c.scratch.i32(location); c.scratch.i32(x); c.scratch.i32(y);
+        c.setUniform(location, c.scratch);
+    }
+    static void APIENTRY hookUniform2fv(GLint location, GLsizei count, const GLfloat* v) {
+        GLCapture& c = self();
+        c.real.Uniform2fv(location, count, v);
+        c.scratch.bytes.clear(); c.scratch.op(GLCaptureOp::Uniform2fv); c.scratch.i32(location); c.scratch.blob(v, count * 2 * sizeof(float));
+        c.setUniform(location, c.scratch);
+    }
+    static void APIENTRY hookUniform3fv(GLint location, GLsizei count, const GLfloat* v) {
+        GLCapture& c = self();
+        c.real.Uniform3fv(location, count, v);
+        c.scratch.bytes.clear(); c.scratch.op(GLCaptureOp::Uniform3fv); c.scratch.i32(location); c.scratch.blob(v, count * 3 * sizeof(float));
+        c.setUniform(location, c.scratch);
+    }
+    static void APIENTRY hookUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v) {
+        GLCapture& c = self();
+        c.real.UniformMatrix4fv(location, count, transpose, v);
+        c.scratch.bytes.clear(); c.scratch.op(GLCaptureOp::UniformMatrix4fv); c.scratch.i32(location); c.scratch.u8(transpose);
+        c.scratch.blob(v, count * 16 * sizeof(float));
+        c.setUniform(location, c.scratch);
+    }
+
+    static void APIENTRY hookGenQueries(GLsizei n, GLuint* names) {
+        self().real.GenQueries(n, names);
+    }
+    static void APIENTRY hookBeginQuery(GLenum target, GLuint query) {
+        GLCapture& c = self();
+        c.real.BeginQuery(target, query);
+        c.queryTargets[query] = target;
+        // Frame timers measure the live run only; a replay has its own timing
+        if (c.capturing && target != GL_TIME_ELAPSED) { c.frame.op(GLCaptureOp::BeginQuery); c.frame.u32(target); c.frame.u32(query); c.usedQueries.insert(query); }
+    }
+    static void APIENTRY hookEndQuery(GLenum target) {
+        GLCapture& c = self();
+        c.real.EndQuery(target);
+        if (c.capturing && target != GL_TIME_ELAPSED) { c.frame.op(GLCaptureOp::EndQuery); c.frame.u32(target); }
+    }
+    static void APIENTRY hookBeginConditionalRender(GLuint query, GLenum mode) {
+        GLCapture& c = self();
+        c.real.BeginConditionalRender(query, mode);
+        if (c.capturing) { c.frame.op(GLCaptureOp::BeginConditionalRender); c.frame.u32(query); c.frame.u32(mode); c.usedQueries.insert(query); }
+    }
+    static void APIENTRY hookEndConditionalRender() {
+        GLCapture& c = self();
+        c.real.EndConditionalRender();
+        if (c.capturing) c.frame.op(GLCaptureOp::EndConditionalRender);
+    }
+
+    static void APIENTRY hookDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+        GLCapture& c = self();
+        c.real.DrawElements(mode, count, type, indices);
+        if (c.capturing) { c.frame.op(GLCaptureOp::DrawElements); c.frame.u32(mode); c.frame.i32(count); c.frame.u32(type); c.frame.u32((uint32_t)reinterpret_cast<uintptr_t>(indices)); }
+    }
+    static void APIENTRY hookDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances) {
+        GLCapture& c = self();
+        c.real.DrawElementsInstanced(mode, count, type, indices, instances);
+        if (c.capturing) {
+            c.frame.op(GLCaptureOp::DrawElementsInstanced); c.frame.u32(mode); c.frame.i32(count); c.frame.u32(type);
+            c.frame.u32((uint32_t)reinterpret_cast<uintptr_t>(indices)); c.frame.i32(instances);
+        }
+    }
+    static void APIENTRY hookDrawArrays(GLenum mode, GLint first, GLsizei count) {
+        GLCapture& c = self();
+        c.real.DrawArrays(mode, first, count);
+        if (c.capturing) { c.frame.op(GLCaptureOp::DrawArrays); c.frame.u32(mode); c.frame.i32(first); c.frame.i32(count); }
+    }
+
+    static void APIENTRY hookEnable(GLenum cap) {
+        GLCapture& c = self();
+        c.real.Enable(cap);
+        c.context.caps[cap] = true;
+        if (c.capturing) { c.frame.op(GLCaptureOp::Enable); c.frame.u32(cap); }
+    }
+    static void APIENTRY hookDisable(GLenum cap) {
+        GLCapture& c = self();
+        c.real.Disable(cap);
+        c.context.caps[cap] = false;
+        if (c.capturing) { c.frame.op(GLCaptureOp::Disable); c.frame.u32(cap); }
+    }
+    static void APIENTRY hookDepthMask(GLboolean flag) {
+        GLCapture& c = self();
+        c.real.DepthMask(flag);
+        c.context.depthMask = flag;
+        if (c.capturing) { c.frame.op(GLCaptureOp::DepthMask); c.frame.u8(flag); }
+    }
+    static void APIENTRY hookColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) {
+        GLCapture& c = self();
+        c.real.ColorMask(r, g, b, a);
+        c.context.colorMask[0] = r; c.context.colorMask[1] = g; c.context.colorMask[2] = b; c.context.colorMask[3] = a;
+        if (c.capturing) { c.frame.op(GLCaptureOp::ColorMask); c.frame.u8(r); c.frame.u8(g); c.frame.u8(b); c.frame.u8(a); }
+    }
+    static void APIENTRY hookBlendFunc(GLenum source, GLenum destination) {
+        GLCapture& c = self();
+        c.real.BlendFunc(source, destination);
+        c.context.blend[0] = source; c.context.blend[1] = destination;
+        if (c.capturing) { c.frame.op(GLCaptureOp::BlendFunc); c.frame.u32(source); c.frame.u32(destination); }
+    }
+    static void APIENTRY hookClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+        GLCapture& c = self();
+        c.real.ClearColor(r, g, b, a);
+        float color[4] = { r, g, b, a };
+        memcpy(c.context.clearColor, color, sizeof(color));
+        if (c.capturing) { c.frame.op(GLCaptureOp::ClearColor); c.frame.raw(color, sizeof(color)); }
+    }
+    static void APIENTRY hookClear(GLbitfield mask) {
+        GLCapture& c = self();
+        c.real.Clear(mask);
+        if (c.capturing) { c.frame.op(GLCaptureOp::Clear); c.frame.u32(mask); }
+    }
+    static void APIENTRY hookViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        GLCapture& c = self();
+        c.real.Viewport(x, y, width, height);
+        if (c.capturing) { c.frame.op(GLCaptureOp::Viewport); c.frame.i32(x); c.frame.i32(y); c.frame.i32(width); c.frame.i32(height); }
+    }
+    static void APIENTRY hookBlitFramebuffer(GLint sx0, GLint sy0, GLint sx1, GLint sy1, GLint dx0, GLint dy0, GLint dx1, GLint dy1, GLbitfield mask, GLenum filter) {
+        GLCapture& c = self();
+        c.real.BlitFramebuffer(sx0, sy0, sx1, sy1, dx0, dy0, dx1, dy1, mask, filter);
+        if (c.capturing) {
+            int32_t rect[8] = { sx0, sy0, sx1, sy1, dx0, dy0, dx1, dy1 };
+            c.frame.op(GLCaptureOp::BlitFramebuffer); c.frame.raw(rect, sizeof(rect)); c.frame.u32(mask); c.frame.u32(filter);
+        }
+    }
+    static void APIENTRY hookPrimitiveRestartIndex(GLuint index) {
+        GLCapture& c = self();
+        c.real.PrimitiveRestartIndex(index);
+        c.context.restartIndex = index; c.context.restartIndexSet = true;
+        if (c.capturing) { c.frame.op(GLCaptureOp::PrimitiveRestartIndex); c.frame.u32(index); }
+    }
+    static void APIENTRY hookVertexAttrib1f(GLuint index, GLfloat v) {
+        GLCapture& c = self();
+        c.real.VertexAttrib1f(index, v);
+        c.context.genericAttribs[index] = v;
+        if (c.capturing) { c.frame.op(GLCaptureOp::VertexAttrib1f); c.frame.u32(index); c.frame.f32(v); }
+    }
+
+    // --- File sections ---
+    void writePrograms(GLCaptureWriter& out) const {
+        out.u32((uint32_t)usedPrograms.size());
+        for (uint32_t name : usedPrograms) {
+            auto it = programs.find(name);
+            static const Program none;
+            const Program& p = it != programs.end() ? it->second : none;
+            out.u32(name);
+            out.u32((uint32_t)p.shaders.size());
+            for (const auto& s : p.shaders) { out.u32(s.first); out.str(s.second); }
+            out.u32(p.binaryFormat);
+            out.blob(p.binary.data(), p.binary.size());
+            out.u32((uint32_t)p.uniformNames.size());
+            for (const auto& u : p.uniformNames) { out.i32(u.first); out.str(u.second); }
+        }
+    }
+
+    void writeBuffers(GLCaptureWriter& out) const {
+        out.u32((uint32_t)usedBuffers.size());
+        for (uint32_t name : usedBuffers) {
+            static const Buffer none;
+            const Buffer* b = atFrameStart(startBuffers, buffers, name);
+            if (!b) b = &none;
+            out.u32(name);
+            out.u32(b->usage);
+            out.blob(b->data.data(), b->data.size());
+        }
+    }
+
+    void writeTextures(GLCaptureWriter& out) const {
+        out.u32((uint32_t)usedTextures.size());
+        for (uint32_t name : usedTextures) {
+            static const Texture none;
+            const Texture* saved = atFrameStart(startTextures, textures, name);
+            const Texture& t = saved ? *saved : none;
+            out.u32(name); out.u32(t.target); out.i32(t.internalFormat); out.i32(t.width); out.i32(t.height); out.i32(t.samples);
+            out.u32(t.format); out.u32(t.type); out.u8(t.mipmaps ? 1 : 0);
+            for (int p : t.params) out.i32(p);
+            out.blob(t.pixels.data(), t.pixels.size());
+            out.u32((uint32_t)t.compressedLevels.size());
+            for (const std::vector<uint8_t>& level : t.compressedLevels) out.blob(level.data(), level.size());
+        }
+    }
+
+    void writeVaos(GLCaptureWriter& out) const {
+        out.u32((uint32_t)usedVaos.size());
+        for (uint32_t name : usedVaos) {
+            auto it = vaos.find(name);
+            static const Vao none;
+            const Vao& v = it != vaos.end() ? it->second : none;
+            out.u32(name);
+            out.u32(v.elementBuffer);
+            for (int i = 0; i < maxAttribs; ++i) {
+                Attrib a = resolvedAttrib(v, i);
+                out.u8(a.enabled ? 1 : 0);
+                if (!a.enabled) continue;
+                out.i32(a.size); out.u32(a.type); out.u8(a.normalized ? 1 : 0); out.i32(a.stride); out.u32(a.offset); out.u32(a.buffer); out.u32(a.divisor);
+            }
+        }
+    }
+
+    void writeFramebuffers(GLCaptureWriter& out) const {
+        out.u32((uint32_t)usedFramebuffers.size());
+        for (uint32_t name : usedFramebuffers) {
+            auto it = framebuffers.find(name);
+            static const Framebuffer none;
+            const Framebuffer& f = it != framebuffers.end() ? it->second : none;
+            out.u32(name);
+            out.u32((uint32_t)f.attachments.size());
+            for (const Attachment& a : f.attachments) { out.u32(a.point); out.u32(a.textarget); out.u32(a.texture); }
+            out.u32((uint32_t)f.drawBuffers.size());
+            for (uint32_t b : f.drawBuffers) out.u32(b);
+            out.u32(f.readBuffer);
+        }
+    }
+
+    // Context state and the uniforms of the frame's programs as they were at beginFrame
+    void writePrologue(GLCaptureWriter& out) const {
+        for (const auto& cap : startState.caps) { out.op(cap.second ? GLCaptureOp::Enable : GLCaptureOp::Disable); out.u32(cap.first); }
+        out.op(GLCaptureOp::BlendFunc); out.u32(startState.blend[0]); out.u32(startState.blend[1]);
+        out.op(GLCaptureOp::DepthMask); out.u8(startState.depthMask);
+        out.op(GLCaptureOp::ColorMask); for (uint8_t m : startState.colorMask) out.u8(m);
+        out.op(GLCaptureOp::ClearColor); out.raw(startState.clearColor, sizeof(startState.clearColor));
+        if (startState.restartIndexSet) { out.op(GLCaptureOp::PrimitiveRestartIndex); out.u32(startState.restartIndex); }
+        for (const auto& g : startState.genericAttribs) { out.op(GLCaptureOp::VertexAttrib1f); out.u32(g.first); out.f32(g.second); }
+        for (uint32_t program : usedPrograms) {
+            auto it = startUniforms.find(program);
+            if (it == startUniforms.end()) continue;
+            out.op(GLCaptureOp::UseProgram); out.u32(program);
+            for (const auto& u : it->second) out.raw(u.second.data(), u.second.size());
+        }
+        out.op(GLCaptureOp::UseProgram); out.u32(0);
+    }
+
+    RealGL real = {};
+    bool active = false, capturing = false;
+    std::unordered_map<uint32_t, Buffer> buffers;
+    std::unordered_map<uint32_t, Vao> vaos;
+    std::unordered_map<uint32_t, Texture> textures;
+    std::unordered_map<uint32_t, Framebuffer> framebuffers;
+    std::unordered_map<uint32_t, Program> programs;
+    std::unordered_map<uint32_t, std::pair<uint32_t, std::string>> shaders;
+    std::unordered_map<uint32_t, uint32_t> queryTargets;
+    std::unordered_map<uint32_t, uint32_t> boundBuffers;  // Target to buffer; element arrays live in the VAO
+    std::unordered_map<uint32_t, uint32_t> boundTextures; // Unit * 65536 + target to texture
+    uint32_t currentVao = 0, currentProgram = 0, drawFramebuffer = 0, readFramebuffer = 0;
+    int activeUnit = 0;
+    int unpackAlignment = 4;
+    std::vector<uint8_t> repacked;
+    ContextState context, startState;
+    std::unordered_map<uint32_t, std::map<int, std::vector<uint8_t>>> startUniforms;
+    std::unordered_map<uint32_t, Buffer> startBuffers;
+    std::unordered_map<uint32_t, Texture> startTextures;
+    std::set<uint32_t> usedPrograms, usedVaos, usedTextures, usedBuffers, usedFramebuffers, usedQueries;
+    GLCaptureWriter frame, scratch;
+    int frameWidth = 0, frameHeight = 0;
+};
+
+inline void GLCapture::install() {
+    if (active) return;
+    active = true;
+    // Keep the driver's entry point, put the hook in glad's table
+#define GL_CAPTURE_HOOK(name) real.name = glad_gl##name; glad_gl##name = &GLCapture::hook##name
+    GL_CAPTURE_HOOK(GenBuffers); GL_CAPTURE_HOOK(CreateBuffers); GL_CAPTURE_HOOK(DeleteBuffers);
+    GL_CAPTURE_HOOK(BindBuffer); GL_CAPTURE_HOOK(BindBufferBase); GL_CAPTURE_HOOK(BufferData);
+    GL_CAPTURE_HOOK(BufferSubData); GL_CAPTURE_HOOK(NamedBufferStorage);
+    GL_CAPTURE_HOOK(GenVertexArrays); GL_CAPTURE_HOOK(CreateVertexArrays); GL_CAPTURE_HOOK(DeleteVertexArrays);
+    GL_CAPTURE_HOOK(BindVertexArray); GL_CAPTURE_HOOK(EnableVertexAttribArray); GL_CAPTURE_HOOK(VertexAttribPointer);
+    GL_CAPTURE_HOOK(VertexAttribDivisor); GL_CAPTURE_HOOK(EnableVertexArrayAttrib); GL_CAPTURE_HOOK(VertexArrayAttribFormat);
+    GL_CAPTURE_HOOK(VertexArrayAttribBinding); GL_CAPTURE_HOOK(VertexArrayVertexBuffer); GL_CAPTURE_HOOK(VertexArrayElementBuffer);
+    GL_CAPTURE_HOOK(GenTextures); GL_CAPTURE_HOOK(CreateTextures); GL_CAPTURE_HOOK(DeleteTextures);
+    GL_CAPTURE_HOOK(BindTexture); GL_CAPTURE_HOOK(ActiveTexture); GL_CAPTURE_HOOK(TexImage2D);
+    GL_CAPTURE_HOOK(TexImage2DMultisample); GL_CAPTURE_HOOK(TextureStorage2D); GL_CAPTURE_HOOK(TexSubImage2D);
+    GL_CAPTURE_HOOK(TextureSubImage2D); GL_CAPTURE_HOOK(TexParameteri); GL_CAPTURE_HOOK(TextureParameteri);
+    GL_CAPTURE_HOOK(GenerateMipmap); GL_CAPTURE_HOOK(GenerateTextureMipmap);
+    GL_CAPTURE_HOOK(CompressedTexImage2D); GL_CAPTURE_HOOK(CompressedTextureSubImage2D); GL_CAPTURE_HOOK(PixelStorei);
+    GL_CAPTURE_HOOK(GenFramebuffers); GL_CAPTURE_HOOK(DeleteFramebuffers); GL_CAPTURE_HOOK(BindFramebuffer);
+    GL_CAPTURE_HOOK(FramebufferTexture2D); GL_CAPTURE_HOOK(DrawBuffers); GL_CAPTURE_HOOK(DrawBuffer); GL_CAPTURE_HOOK(ReadBuffer);
+    GL_CAPTURE_HOOK(CreateShader); GL_CAPTURE_HOOK(ShaderSource); GL_CAPTURE_HOOK(AttachShader);
+    GL_CAPTURE_HOOK(LinkProgram); GL_CAPTURE_HOOK(ProgramBinary); GL_CAPTURE_HOOK(DeleteProgram);
+    GL_CAPTURE_HOOK(GetUniformLocation); GL_CAPTURE_HOOK(UseProgram);
+    GL_CAPTURE_HOOK(Uniform1i); GL_CAPTURE_HOOK(Uniform1f); GL_CAPTURE_HOOK(Uniform2i);
+    GL_CAPTURE_HOOK(Uniform2fv); GL_CAPTURE_HOOK(Uniform3fv); GL_CAPTURE_HOOK(UniformMatrix4fv);
+    GL_CAPTURE_HOOK(GenQueries); GL_CAPTURE_HOOK(BeginQuery); GL_CAPTURE_HOOK(EndQuery);
+    GL_CAPTURE_HOOK(BeginConditionalRender); GL_CAPTURE_HOOK(EndConditionalRender);
+    GL_CAPTURE_HOOK(DrawElements); GL_CAPTURE_HOOK(DrawElementsInstanced); GL_CAPTURE_HOOK(DrawArrays);
+    GL_CAPTURE_HOOK(Enable); GL_CAPTURE_HOOK(Disable); GL_CAPTURE_HOOK(DepthMask); GL_CAPTURE_HOOK(ColorMask);
+    GL_CAPTURE_HOOK(BlendFunc); GL_CAPTURE_HOOK(ClearColor); GL_CAPTURE_HOOK(Clear); GL_CAPTURE_HOOK(Viewport);
+    GL_CAPTURE_HOOK(BlitFramebuffer); GL_CAPTURE_HOOK(PrimitiveRestartIndex); GL_CAPTURE_HOOK(VertexAttrib1f);
+#undef GL_CAPTURE_HOOK
+    vaos[0] = Vao();
+    framebuffers[0] = Framebuffer();
+    EventLog::instance().info("GL capture layer installed");
+}
+
+// --- Replay ---
+// Recreates a capture's objects through the plain bind-to-edit API (so immutable storage
+// comes back as mutable) and runs its streams. Programs are rebuilt from their sources,
+// or from the program binary when they were loaded from the pipeline cache, which only
+// works on the driver that wrote it; uniform locations are looked up again by name.
+class GLReplay {
+public:
+    bool load(const char* path) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        file.resize(size > 0 ? (size_t)size : 0);
+        bool read = size > 4 && fread(file.data(), 1, file.size(), f) == file.size();
+        fclose(f);
+        return read && memcmp(file.data(), "GLC2", 4) == 0;
+    }
+
+    // Creates every object; call with the replay context current
+    bool createResources() {
+        GLCaptureReader in;
+        in.p = file.data() + 4; in.end = file.data() + file.size();
+        frameWidth = in.i32(); frameHeight = in.i32();
+        readPrograms(in);
+        readBuffers(in);
+        readTextures(in);
+        readVaos(in);
+        readFramebuffers(in);
+        uint32_t queryCount = in.u32();
+        for (uint32_t i = 0; i < queryCount && !in.failed; ++i) {
+            uint32_t name = in.u32(), target = in.u32();
+            GLuint query;
+            glGenQueries(1, &query);
+            // Conditional rendering needs a query that has been run once
+            glBeginQuery(target, query);
+            glEndQuery(target);
+            queries[name] = query;
+        }
+        uint32_t size;
+        const uint8_t* data = in.blob(size);
+        prologue.assign(data, data + size);
+        data = in.blob(size);
+        frame.assign(data, data + size);
+        glBindVertexArray(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (in.failed) EventLog::instance().error("GL capture is truncated");
+        return !in.failed;
+    }
+
+    int width() const { return frameWidth; }
+    int height() const { return frameHeight; }
+    size_t frameBytes() const { return frame.size(); }
+
+    // Restores the state the frame started from
+    void runPrologue() { run(prologue, nullptr); }
+    // Plays the frame; counts ops by type when counts is given
+    void runFrame(int* counts = nullptr) { run(frame, counts); }
+
+private:
+    struct ProgramMap {
+        unsigned int program = 0;
+        std::unordered_map<int, int> locations; // Recorded to current
+    };
+
+    static uint32_t mapped(const std::unordered_map<uint32_t, uint32_t>& names, uint32_t name) {
+        auto it = names.find(name);
+        return it != names.end() ? it->second : 0;
+    }
+
+    // Stream payloads are unaligned
+    const float* floats(const uint8_t* data, uint32_t size) {
+        aligned.resize(size / sizeof(float) + 1);
+        if (size) memcpy(aligned.data(), data, size);
+        return aligned.data();
+    }
+
+    int location(int recorded) const {
+        auto it = programs.find(currentProgram);
+        if (it == programs.end()) return recorded;
+        auto loc = it->second.locations.find(recorded);
+        return loc != it->second.locations.end() ? loc->second : recorded;
+    }
+
+    void readPrograms(GLCaptureReader& in) {
+        uint32_t count = in.u32();
+        for (uint32_t i = 0; i < count && !in.failed; ++i) {
+            uint32_t name = in.u32();
+            ProgramMap p;
+            p.program = glCreateProgram();
+            uint32_t shaderCount = in.u32();
+            std::vector<unsigned int> stages;
+            for (uint32_t s = 0; s < shaderCount && !in.failed; ++s) {
+                uint32_t type = in.u32();
+                std::string source = in.str();
+                unsigned int shader = glCreateShader(type);
+                const char* text = source.c_str();
+                glShaderSource(shader, 1, &text, NULL);
+                glCompileShader(shader);
+                glAttachShader(p.program, shader);
+                stages.push_back(shader);
+            }
+            uint32_t format = in.u32(), binarySize;
+            const uint8_t* binary = in.blob(binarySize);
+            if (binarySize > 0) glProgramBinary(p.program, format, binary, (GLsizei)binarySize);
+            else glLinkProgram(p.program);
+            for (unsigned int shader : stages) glDeleteShader(shader);
+            int linked = 0;
+            glGetProgramiv(p.program, GL_LINK_STATUS, &linked);
+            if (!linked) EventLog::instance().error("GL replay: program " + std::to_string(name) + " did not link (binary from another driver?)");
+            uint32_t uniformCount = in.u32();
+            for (uint32_t u = 0; u < uniformCount && !in.failed; ++u) {
+                int recorded = in.i32();
+                std::string uniform = in.str();
+                p.locations[recorded] = glGetUniformLocation(p.program, uniform.c_str());
+            }
+            programs[name] = p;
+            programNames[name] = p.program;
+        }
+    }
+
+    void readBuffers(GLCaptureReader& in) {
+        uint32_t count = in.u32();
+        for (uint32_t i = 0; i < count && !in.failed; ++i) {
+            uint32_t name = in.u32(), usage = in.u32(), size;
+            const uint8_t* data = in.blob(size);
+            GLuint buffer;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+            buffers[name] = buffer;
+        }
+    }
+
+    void readTextures(GLCaptureReader& in) {
+        uint32_t count = in.u32();
+        for (uint32_t i = 0; i < count && !in.failed; ++i) {
+            uint32_t name = in.u32(), target = in.u32();
+            int internalFormat = in.i32(), w = in.i32(), h = in.i32(), samples = in.i32();
+            uint32_t format = in.u32(), type = in.u32();
+            bool mipmaps = in.u8() != 0;
+            int params[4];
+            for (int& p : params) p = in.i32();
+            uint32_t size;
+            const uint8_t* pixels = in.blob(size);
+            std::vector<std::pair<const uint8_t*, uint32_t>> compressed(in.u32());
+            for (auto& level : compressed) level.first = in.blob(level.second);
+            GLuint texture;
+            glGenTextures(1, &texture);
+            glBindTexture(target, texture);
+            if (target == GL_TEXTURE_2D_MULTISAMPLE) glTexImage2DMultisample(target, samples, internalFormat, w, h, GL_TRUE);
+            else {
+                for (size_t l = 0; l < compressed.size(); ++l)
+                    glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)l, internalFormat, std::max(1, w >> l), std::max(1, h >> l), 0, compressed[l].second, compressed[l].first);
+                if (!compressed.empty()) glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)compressed.size() - 1);
+                else {
+                    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, size ? pixels : nullptr);
+                    if (mipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+                }
+                const GLenum names[4] = { GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T };
+                for (int p = 0; p < 4; ++p) glTexParameteri(GL_TEXTURE_2D, names[p], params[p]);
+            }
+            glBindTexture(target, 0);
+            textures[name] = texture;
+        }
+    }
+
+    void readVaos(GLCaptureReader& in) {
+        uint32_t count = in.u32();
+        for (uint32_t i = 0; i < count && !in.failed; ++i) {
+            uint32_t name = in.u32(), elements = in.u32();
+            GLuint vao;
+            glGenVertexArrays(1, &vao);
+            glBindVertexArray(vao);
+            if (elements) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mapped(buffers, elements));
+            for (int a = 0; a < GLCapture::maxAttribs && !in.failed; ++a) {
+                if (!in.u8()) continue;
+                int size = in.i32();
+                uint32_t type = in.u32();
+                bool normalized = in.u8() != 0;
+                int stride = in.i32();
+                uint32_t offset = in.u32(), buffer = in.u32(), divisor = in.u32();
+                glBindBuffer(GL_ARRAY_BUFFER, mapped(buffers, buffer));
+                glEnableVertexAttribArray(a);
+                glVertexAttribPointer(a, size, type, normalized ? GL_TRUE : GL_FALSE, stride, reinterpret_cast<const void*>((uintptr_t)offset));
+                if (divisor) glVertexAttribDivisor(a, divisor);
+            }
+            vertexArrays[name] = vao;
+        }
+        glBindVertexArray(0);
+    }
+
+    void readFramebuffers(GLCaptureReader& in) {
+        uint32_t count = in.u32();
+        for (uint32_t i = 0; i < count && !in.failed; ++i) {
+            uint32_t name = in.u32();
+            GLuint fbo;
+            glGenFramebuffers(1, &fbo);
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            uint32_t attachments = in.u32();
+            for (uint32_t a = 0; a < attachments && !in.failed; ++a) {
+                uint32_t point = in.u32(), textarget = in.u32(), texture = in.u32();
+                glFramebufferTexture2D(GL_FRAMEBUFFER, point, textarget, mapped(textures, texture), 0);
+            }
+            uint32_t drawCount = in.u32();
+            std::vector<GLenum> draw;
+            for (uint32_t d = 0; d < drawCount && !in.failed; ++d) draw.push_back(in.u32());
+            if (draw.size() == 1) glDrawBuffer(draw[0]);
+            else if (!draw.empty()) glDrawBuffers((GLsizei)draw.size(), draw.data());
+            glReadBuffer(in.u32());
+            framebuffers[name] = fbo;
+        }
+    }
+
+    void run(const std::vector<uint8_t>& stream, int* counts) {
+        GLCaptureReader in;
+        in.p = stream.data(); in.end = stream.data() + stream.size();
+        uint32_t size;
+        while (in.p < in.end && !in.failed) {
+            GLCaptureOp op = (GLCaptureOp)in.u8();
+            if (counts && op < GLCaptureOp::Count) counts[(int)op]++;
+            switch (op) {
+            case GLCaptureOp::UseProgram: { uint32_t p = in.u32(); currentProgram = p; glUseProgram(mapped(programNames, p)); break; }
+            case GLCaptureOp::BindVertexArray: glBindVertexArray(mapped(vertexArrays, in.u32())); break;
+            case GLCaptureOp::ActiveTexture: glActiveTexture(in.u32()); break;
+            case GLCaptureOp::BindTexture: { uint32_t target = in.u32(); glBindTexture(target, mapped(textures, in.u32())); break; }
+            case GLCaptureOp::BindBuffer: { uint32_t target = in.u32(); glBindBuffer(target, mapped(buffers, in.u32())); break; }
+            case GLCaptureOp::BindBufferBase: { uint32_t target = in.u32(), index = in.u32(); glBindBufferBase(target, index, mapped(buffers, in.u32())); break; }
+            case GLCaptureOp::BindFramebuffer: { uint32_t target = in.u32(); glBindFramebuffer(target, mapped(framebuffers, in.u32())); break; }
+            case GLCaptureOp::Viewport: { int x = in.i32(), y = in.i32(), w = in.i32(), h = in.i32(); glViewport(x, y, w, h); break; }
+            case GLCaptureOp::Clear: glClear(in.u32()); break;
+            case GLCaptureOp::ClearColor: { float r = in.f32(), g = in.f32(), b = in.f32(), a = in.f32(); glClearColor(r, g, b, a); break; }
+            case GLCaptureOp::Enable: glEnable(in.u32()); break;
+            case GLCaptureOp::Disable: glDisable(in.u32()); break;
+            case GLCaptureOp::DepthMask: glDepthMask(in.u8()); break;
+            case GLCaptureOp::ColorMask: { uint8_t r = in.u8(), g = in.u8(), b = in.u8(), a = in.u8(); glColorMask(r, g, b, a); break; }
+            case GLCaptureOp::BlendFunc: { uint32_t s = in.u32(), d = in.u32(); glBlendFunc(s, d); break; }
+            case GLCaptureOp::PrimitiveRestartIndex: glPrimitiveRestartIndex(in.u32()); break;
+            case GLCaptureOp::VertexAttrib1f: { uint32_t index = in.u32(); glVertexAttrib1f(index, in.f32()); break; }
+            case GLCaptureOp::Uniform1i: { int loc = location(in.i32()); glUniform1i(loc, in.i32()); break; }
+            case GLCaptureOp::Uniform1f: { int loc = location(in.i32()); glUniform1f(loc, in.f32()); break; }
+            case GLCaptureOp::Uniform2i: { int loc = location(in.i32()); int x = in.i32(); glUniform2i(loc, x, in.i32()); break; }
+            case GLCaptureOp::Uniform2fv: { int loc = location(in.i32()); const uint8_t* v = in.blob(size); glUniform2fv(loc, (GLsizei)(size / 8), floats(v, size)); break; }
+            case GLCaptureOp::Uniform3fv: { int loc = location(in.i32()); const uint8_t* v = in.blob(size); glUniform3fv(loc, (GLsizei)(size / 12), floats(v, size)); break; }
+            case GLCaptureOp::UniformMatrix4fv: {
+                int loc = location(in.i32());
+                uint8_t transpose = in.u8();
+                const uint8_t* v = in.blob(size);
+                glUniformMatrix4fv(loc, (GLsizei)(size / 64), transpose, floats(v, size));
+                break;
+            }
+            case GLCaptureOp::BufferData: {
+                uint32_t target = in.u32(), bytes = in.u32(), usage = in.u32();
+                bool hasData = in.u8() != 0;
+                const uint8_t* data = hasData ? in.p : nullptr;
+                if (hasData) { if ((size_t)(in.end - in.p) < bytes) { in.failed = true; break; } in.p += bytes; }
+                glBufferData(target, bytes, data, usage);
+                break;
+            }
+            case GLCaptureOp::BufferSubData: { uint32_t target = in.u32(), offset = in.u32(); const uint8_t* data = in.blob(size); glBufferSubData(target, offset, size, data); break; }
+            case GLCaptureOp::TexSubImage2D:
+            case GLCaptureOp::TextureSubImage2D: {
+                uint32_t target = in.u32();
+                int level = in.i32(), x = in.i32(), y = in.i32(), w = in.i32(), h = in.i32();
+                uint32_t format = in.u32(), type = in.u32();
+                const uint8_t* pixels = in.blob(size);
+                if (!pixels) break;
+                if (op == GLCaptureOp::TextureSubImage2D) { glBindTexture(GL_TEXTURE_2D, mapped(textures, target)); target = GL_TEXTURE_2D; }
+                glTexSubImage2D(target, level, x, y, w, h, format, type, pixels);
+                break;
+            }
+            case GLCaptureOp::DrawElements: {
+                uint32_t mode = in.u32(); int count = in.i32(); uint32_t type = in.u32(), offset = in.u32();
+                glDrawElements(mode, count, type, reinterpret_cast<const void*>((uintptr_t)offset));
+                break;
+            }
+            case GLCaptureOp::DrawElementsInstanced: {
+                uint32_t mode = in.u32(); int count = in.i32(); uint32_t type = in.u32(), offset = in.u32(); int instances = in.i32();
+                glDrawElementsInstanced(mode, count, type, reinterpret_cast<const void*>((uintptr_t)offset), instances);
+                break;
+            }
+            case GLCaptureOp::DrawArrays: { uint32_t mode = in.u32(); int first = in.i32(); glDrawArrays(mode, first, in.i32()); break; }
+            case GLCaptureOp::BeginQuery: { uint32_t target = in.u32(); glBeginQuery(target, mapped(queries, in.u32())); break; }
+            case GLCaptureOp::EndQuery: glEndQuery(in.u32()); break;
+            case GLCaptureOp::BeginConditionalRender: { uint32_t query = in.u32(); glBeginConditionalRender(mapped(queries, query), in.u32()); break; }
+            case GLCaptureOp::EndConditionalRender: glEndConditionalRender(); break;
+            case GLCaptureOp::BlitFramebuffer: {
+                int32_t r[8];
+                for (int32_t& v : r) v = in.i32();
+                uint32_t mask = in.u32(), filter = in.u32();
+                glBlitFramebuffer(r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], mask, filter);
+                break;
+            }
+            default:
+                EventLog::instance().error("GL replay: unknown op " + std::to_string((int)op));
+                in.failed = true;
+                break;
+            }
+        }
+    }
+
+    std::vector<uint8_t> file, prologue, frame;
+    std::vector<float> aligned;
+    std::unordered_map<uint32_t, ProgramMap> programs;
+    std::unordered_map<uint32_t, uint32_t> programNames, buffers, textures, vertexArrays, framebuffers, queries;
+    uint32_t currentProgram = 0;
+    int frameWidth = 0, frameHeight = 0;
+};
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "DeltaCodec.h"
+#include "MemoryTracker.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// --- Gameplay state ---
+// Everything the simulation owns lives in one flat, trivially copyable block, so a
+// snapshot is a single memcpy. Meshes are shared and live outside of it.
+
+struct Parcel {
+    glm::vec3 position;
+    glm::vec3 velocity = glm::vec3(0, -9.8f, 0);
+    float radius = 0.5f;
+    bool active = true;
+    uint16_t id = 0; // The slot on the authority, the replicated id on clients; sounds follow it
+};
+
+struct Target {
+    glm::vec3 position;
+    float radius = 2.5f;
+    bool active = true;
+};
+
+struct Airship {
+    glm::vec3 position;
+    bool active = false;
+};
+
+// Moments the authority reports instead of leaving peers to infer them from state
+// changes (a parcel leaving a client's view is not a landing). Event n is kept in
+// events[n % maxEvents] with sequence n until newer ones overwrite it.
+enum class GameEventKind : uint8_t { None, ParcelLanded, TargetHit };
+
+struct GameEvent {
+    uint32_t sequence = 0;
+    GameEventKind kind = GameEventKind::None;
+    glm::vec3 position;
+};
+
+// Player input as a bitmask, so it can be replayed for prediction and sent over the wire
+enum InputButton : uint8_t {
+    InputForward = 1 << 0,
+    InputBack = 1 << 1,
+    InputRight = 1 << 2,
+    InputLeft = 1 << 3,
+    InputUp = 1 << 4,
+    InputDown = 1 << 5,
+    InputDrop = 1 << 6,
+};
+
+// halfExtent > 0 keeps the airship inside a box of that half size around the origin
+inline void moveAirship(glm::vec3& pos, uint8_t buttons, float dt, float halfExtent = 0.0f) {
+    const float speed = 15.0f;
+    glm::vec3 forward = glm::vec3(0, 0, -1); glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0, 1, 0)));
+    if (buttons & InputForward) pos += forward * speed * dt;
+    if (buttons & InputBack) pos -= forward * speed * dt;
+    if (buttons & InputRight) pos += right * speed * dt;
+    if (buttons & InputLeft) pos -= right * speed * dt;
+    if (buttons & InputUp) pos.y += speed * dt;
+    if (buttons & InputDown) pos.y -= speed * dt;
+    if (halfExtent > 0.0f) pos = glm::clamp(pos, -halfExtent, halfExtent);
+}
+
+struct GameState {
+    static const int maxParcels = 256;
+    static const int maxTargets = 2048; // Village houses; ids must stay below netTargetActiveBit
+    static const int maxAirships = 512;
+    static const int maxEvents = 32; // Readers must look at least this often
+
+    Airship airships[maxAirships]; // Slot 0 is the local player in single player and on the host
+    int score = 0;
+    int parcelCount = 0;
+    int targetCount = 0;
+    Parcel parcels[maxParcels];
+    Target targets[maxTargets];
+    uint32_t eventCount = 0; // Events ever recorded
+    GameEvent events[maxEvents];
+
+    // Reuses the slot of a parcel that already landed before growing the array
+    Parcel* spawnParcel(const glm::vec3& position) {
+        Parcel* slot = nullptr;
+        for (int i = 0; i < parcelCount && !slot; ++i)
+            if (!parcels[i].active) slot = &parcels[i];
+        if (!slot && parcelCount < maxParcels) slot = &parcels[parcelCount++];
+        if (!slot) return nullptr;
+        *slot = Parcel();
+        slot->position = position;
+        slot->id = (uint16_t)(slot - parcels);
+        return slot;
+    }
+
+    void recordEvent(GameEventKind kind, const glm::vec3& position) {
+        GameEvent& e = events[eventCount % maxEvents];
+        e.sequence = eventCount++;
+        e.kind = kind;
+        e.position = position;
+    }
+
+    Target* addTarget(const glm::vec3& position) {
+        if (targetCount >= maxTargets) return nullptr;
+        Target* t = &targets[targetCount++];
+        *t = Target();
+        t->position = position;
+        return t;
+    }
+
+    int activeParcels() const {
+        int n = 0;
+        for (int i = 0; i < parcelCount; ++i) if (parcels[i].active) n++;
+        return n;
+    }
+    int activeTargets() const {
+        int n = 0;
+        for (int i = 0; i < targetCount; ++i) if (targets[i].active) n++;
+        return n;
+    }
+
+    // Quicksave: "GSAV", the save version and sizeof(GameState), then the raw state. Bump
+    // saveVersion when the layout changes; a file from another build is refused rather
+    // than loaded as garbage.
+    static const uint32_t saveMagic = 0x56415347; // "GSAV" read little-endian
+    static const uint32_t saveVersion = 2;
+
+    bool saveToFile(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        uint32_t header[3] = { saveMagic, saveVersion, (uint32_t)sizeof(GameState) };
+        bool ok = fwrite(header, sizeof(header), 1, f) == 1 && fwrite(this, sizeof(GameState), 1, f) == 1;
+        ok = fclose(f) == 0 && ok;
+        return ok;
+    }
+    bool loadFromFile(const char* path) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        uint32_t header[3] = {};
+        GameState loaded;
+        bool ok = fread(header, sizeof(header), 1, f) == 1
+            && header[0] == saveMagic && header[1] == saveVersion && header[2] == (uint32_t)sizeof(GameState)
+            && fread(&loaded, sizeof(GameState), 1, f) == 1;
+        fclose(f);
+        // The counts bound loops over the fixed arrays, so a damaged file must not get past here
+        ok = ok && loaded.parcelCount >= 0 && loaded.parcelCount <= maxParcels && loaded.targetCount >= 0 && loaded.targetCount <= maxTargets;
+        if (ok) *this = loaded;
+        return ok;
+    }
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must stay memcpy-able for snapshots");
+
+// --- Snapshot history ---
+// A ring of per-tick snapshots for rewind. Every keyframeInterval-th entry is a raw copy
+// of the state; the rest store the XOR/RLE delta against the previous tick. Slot buffers
+// keep their capacity, so recording stops allocating once every slot has been used.
+class SnapshotHistory {
+public:
+    static const int capacity = 600; // Ten seconds at 60 Hz
+    static const int keyframeInterval = 30;
+
+    void record(const GameState& state) {
+        Slot& slot = slots[(first + count) % capacity];
+        if (count == capacity) {
+            // Dropping the oldest entry must not orphan deltas that depend on it
+            first = (first + 1) % capacity; count--;
+            while (count > 0 && !slots[first].keyframe) { first = (first + 1) % capacity; count--; }
+        }
+        size_t before = slot.data.capacity();
+        slot.keyframe = count == 0 || sinceKeyframe >= keyframeInterval - 1;
+        if (slot.keyframe) {
+            slot.data.resize(sizeof(GameState));
+            memcpy(slot.data.data(), &state, sizeof(GameState));
+            sinceKeyframe = 0;
+        }
+        else {
+            encodeXorDelta(reinterpret_cast<const uint8_t*>(&previous), reinterpret_cast<const uint8_t*>(&state), sizeof(GameState), slot.data);
+            sinceKeyframe++;
+        }
+        MemoryTracker::instance().add(MemTag::GameState, (int64_t)(slot.data.capacity() - before));
+        previous = state;
+        count++;
+    }
+
+    // Restores the newest snapshot into state and removes it; false once history is empty
+    bool rewind(GameState& state) {
+        if (count == 0) return false;
+        state = previous;
+        count--;
+        if (count > 0) rebuild(count - 1, previous);
+        sinceKeyframe = 0;
+        for (int i = count - 1; i >= 0 && !slots[(first + i) % capacity].keyframe; --i) sinceKeyframe++;
+        return true;
+    }
+
+    int size() const { return count; }
+    size_t storedBytes() const {
+        size_t total = 0;
+        for (int i = 0; i < count; ++i) total += slots[(first + i) % capacity].data.size();
+        return total;
+    }
+
+private:
+    struct Slot {
+        bool keyframe = false;
+        std::vector<uint8_t> data;
+    };
+
+    // Reconstructs entry `index` (relative to first) from the nearest keyframe at or before it
+    void rebuild(int index, GameState& out) const {
+        int k = index;
+        while (!slots[(first + k) % capacity].keyframe) k--;
+        memcpy(&out, slots[(first + k) % capacity].data.data(), sizeof(GameState));
+        for (int i = k + 1; i <= index; ++i)
+            applyXorDelta(slots[(first + i) % capacity].data.data(), slots[(first + i) % capacity].data.size(), reinterpret_cast<uint8_t*>(&out), sizeof(GameState));
+    }
+
+    Slot slots[capacity];
+    GameState previous;
+    int first = 0;
+    int count = 0;
+    int sinceKeyframe = 0;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "EventLog.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdio>
+
+// --- GPU frame time ---
+// GL_TIME_ELAPSED around the frame's passes, in a ring deep enough that results are read
+// a few frames late instead of stalling on the current one.
+class GpuFrameTimer {
+public:
+    static const int depth = 4;
+
+    void init() { glGenQueries(depth, queries); }
+
+    void begin() {
+        if (pending[head]) return; // Still in flight after a full ring: skip this frame
+        glBeginQuery(GL_TIME_ELAPSED, queries[head]);
+        open = true;
+    }
+
+    void end() {
+        if (!open) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        open = false;
+        pending[head] = true;
+        head = (head + 1) % depth;
+    }
+
+    // Reads whatever has finished; returns the latest result in ms, or -1 before the first
+    float poll() {
+        for (int i = 0; i < depth; ++i) {
+            int q = (head + i) % depth; // Oldest first
+            if (!pending[q]) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[q], GL_QUERY_RESULT, &ns);
+            pending[q] = false;
+            latestMs = ns / 1e6f;
+        }
+        return latestMs;
+    }
+
+private:
+    GLuint queries[depth] = {};
+    bool pending[depth] = {};
+    int head = 0;
+    bool open = false;
+    float latestMs = -1.0f;
+};
+
+// --- LOD budget ---
+// Holds a frame time target by trading detail as the scene gets denser, instead of a tier
+// switch. Two knobs: the texture LOD bias (GPU cost only, so it follows the GPU time) and
+// the detail distance beyond which small parts (ornaments, gondolas) are left out, which
+// saves draws and triangles on both sides, so it follows the slower of CPU and GPU.
+//
+// Frame times react a few frames late, so the submitted draws and triangles are used to
+// see density changes coming: the smoothed ms per unit of work, times this frame's work,
+// predicts the frame before it is measured. Each knob only moves when the load leaves a
+// dead band around the target, steps down faster than it comes back, and holds for a
+// while after every change so the next decision sees the effect of the last one.
+class LodController {
+public:
+    static constexpr float maxExtraBias = 2.0f;   // Mip levels added at the lowest detail
+    static constexpr float minDetailDistance = 40.0f;
+    static constexpr float drawCost = 400.0f;      // Triangles one draw call is worth in the work estimate
+
+    void setTarget(float frameMs) { targetMs = frameMs; }
+    void setEnabled(bool on) { enabled = on; if (!on) reset(); }
+    bool isEnabled() const { return enabled; }
+
+    // Full detail again, e.g. after a tier change; the estimates start over too
+    void reset() {
+        bias = Knob(); distance = Knob();
+        smoothedCpuMs = smoothedGpuMs = msPerWork = gpuMsPerWork = 0.0f;
+        samples = 0;
+    }
+
+    // cpuMs: the frame's work before present; gpuMs: the latest GPU time, or < 0 if none yet
+    void update(float cpuMs, float gpuMs, int drawCalls, int triangles) {
+        if (!enabled) return;
+        float work = (float)triangles + drawCost * drawCalls + 1.0f;
+        const float alpha = 0.1f;
+        bool haveGpu = gpuMs >= 0.0f;
+        if (samples++ == 0) {
+            smoothedCpuMs = cpuMs; smoothedGpuMs = haveGpu ? gpuMs : 0.0f;
+            msPerWork = cpuMs / work; gpuMsPerWork = smoothedGpuMs / work;
+            return;
+        }
+        smoothedCpuMs += (cpuMs - smoothedCpuMs) * alpha;
+        msPerWork += (cpuMs / work - msPerWork) * alpha;
+        if (haveGpu) {
+            smoothedGpuMs += (gpuMs - smoothedGpuMs) * alpha;
+            gpuMsPerWork += (gpuMs / work - gpuMsPerWork) * alpha;
+        }
+        // The larger of what was measured and what this frame's work predicts
+        float cpuLoad = std::max(smoothedCpuMs, msPerWork * work);
+        float gpuLoad = haveGpu ? std::max(smoothedGpuMs, gpuMsPerWork * work) : 0.0f;
+        bool changed = distance.step(std::max(cpuLoad, gpuLoad) / targetMs);
+        changed |= bias.step(gpuLoad / targetMs);
+        if (changed && ++changes % 30 == 1) {
+            char line[160];
+            snprintf(line, sizeof(line), "LOD: bias +%.2f, detail distance %.0f%% pulled in (CPU %.2f ms, GPU %.2f ms, %d draws, %d triangles)",
+                extraBias(), distance.level * 100.0f, smoothedCpuMs, smoothedGpuMs, drawCalls, triangles);
+            EventLog::instance().info(line);
+        }
+    }
+
+    float extraBias() const { return bias.level * maxExtraBias; }
+
+    // Small parts are dropped beyond this; never further than the draw distance
+    float detailDistance(float drawDistance) const {
+        float nearest = drawDistance < minDetailDistance ? drawDistance : minDetailDistance;
+        return drawDistance + (nearest - drawDistance) * distance.level;
+    }
+
+    float cpuMs() const { return smoothedCpuMs; }
+    float gpuMs() const { return smoothedGpuMs; }
+
+private:
+    // One detail reduction in [0, 1] with a dead band and a hold after each move
+    struct Knob {
+        static const int holdFrames = 20;
+        float level = 0.0f;
+        int hold = 0;
+
+        // load: predicted frame time over the target; returns true if the level moved
+        bool step(float load) {
+            if (hold > 0) { hold--; return false; }
+            float before = level;
+            if (load > 1.05f) level = std::min(1.0f, level + std::min(0.25f, (load - 1.0f) * 0.5f));
+            else if (load < 0.8f) level = std::max(0.0f, level - 0.05f);
+            if (level == before) return false;
+            hold = holdFrames;
+            return true;
+        }
+    };
+
+    Knob bias, distance;
+    float targetMs = 12.5f;
+    float smoothedCpuMs = 0.0f, smoothedGpuMs = 0.0f;
+    float msPerWork = 0.0f, gpuMsPerWork = 0.0f;
+    int samples = 0, changes = 0;
+    bool enabled = true;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+// --- Memory accounting ---
+// Current/peak byte counters per subsystem. CPU containers opt in through
+// TrackedAllocator, GPU storage is reported explicitly where it is created.
+
+enum class MemTag : int { MeshCPU, MeshGPU, TextureGPU, GameState, Scene, Audio, RenderTarget, Count };
+
+inline const char* memTagName(MemTag tag) {
+    static const char* names[] = { "mesh_cpu", "mesh_gpu", "texture_gpu", "game_state", "scene", "audio", "render_target" };
+    return names[(int)tag];
+}
+
+class MemoryTracker {
+public:
+    static MemoryTracker& instance() {
+        static MemoryTracker tracker;
+        return tracker;
+    }
+
+    void add(MemTag tag, int64_t bytes) {
+        int64_t now = current[(int)tag].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        int64_t prev = peak[(int)tag].load(std::memory_order_relaxed);
+        while (now > prev && !peak[(int)tag].compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+    }
+    void remove(MemTag tag, int64_t bytes) { current[(int)tag].fetch_sub(bytes, std::memory_order_relaxed); }
+
+    int64_t currentBytes(MemTag tag) const { return current[(int)tag].load(std::memory_order_relaxed); }
+    int64_t peakBytes(MemTag tag) const { return peak[(int)tag].load(std::memory_order_relaxed); }
+    int64_t totalCurrentBytes() const {
+        int64_t sum = 0;
+        for (int i = 0; i < (int)MemTag::Count; ++i) sum += current[i].load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    // GPU objects are keyed by GL name so re-specifying storage replaces the old size.
+    // Only called at load time, so the map is not on the hot path.
+    void setGpuObject(MemTag tag, unsigned int name, int64_t bytes) {
+        int64_t& slot = gpuObjects[(int)tag][name];
+        remove(tag, slot);
+        add(tag, bytes);
+        slot = bytes;
+    }
+    void releaseGpuObject(MemTag tag, unsigned int name) {
+        auto it = gpuObjects[(int)tag].find(name);
+        if (it == gpuObjects[(int)tag].end()) return;
+        remove(tag, it->second);
+        gpuObjects[(int)tag].erase(it);
+    }
+
+private:
+    MemoryTracker() {
+        for (int i = 0; i < (int)MemTag::Count; ++i) { current[i] = 0; peak[i] = 0; }
+    }
+
+    std::atomic<int64_t> current[(int)MemTag::Count];
+    std::atomic<int64_t> peak[(int)MemTag::Count];
+    std::unordered_map<unsigned int, int64_t> gpuObjects[(int)MemTag::Count];
+};
+
+template <typename T, MemTag Tag>
+struct TrackedAllocator {
+    typedef T value_type;
+    template <typename U> struct rebind { typedef TrackedAllocator<U, Tag> other; };
+
+    TrackedAllocator() = default;
+    template <typename U> TrackedAllocator(const TrackedAllocator<U, Tag>&) {}
+
+    T* allocate(size_t n) {
+        MemoryTracker::instance().add(Tag, (int64_t)(n * sizeof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) {
+        MemoryTracker::instance().remove(Tag, (int64_t)(n * sizeof(T)));
+        ::operator delete(p);
+    }
+
+    template <typename U> bool operator==(const TrackedAllocator<U, Tag>&) const { return true; }
+    template <typename U> bool operator!=(const TrackedAllocator<U, Tag>&) const { return false; }
+};
+
+template <typename T, MemTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
+
+// --- Frame-loop allocation guard ---
+// Debug builds replace global operator new (see main.cpp) and count allocations made
+// by this thread while a frame is open, so a stray allocation in the loop shows up.
+struct FrameAllocationGuard {
+    static bool& active() { static thread_local bool flag = false; return flag; }
+    static uint64_t& count() { static thread_local uint64_t n = 0; return n; }
+
+    static void begin() { count() = 0; active() = true; }
+    static uint64_t end() { active() = false; return count(); }
+
+    // Budgeted work inside the frame that is allowed to allocate, like streaming uploads
+    struct Exempt {
+        bool wasActive;
+        Exempt() : wasActive(active()) { active() = false; }
+        ~Exempt() { active() = wasActive; }
+    };
+};
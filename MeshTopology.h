@@ -0,0 +1,230 @@
+#pragma once
+
+#include "EventLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// --- Mesh topology ---
+// Regular grids (the terrain, ellipsoids, streamed terrain tiles) can be indexed as a
+// vertex-cache optimised triangle list, or as one triangle strip per row with the
+// primitive restart index between rows, which needs a little over half the indices.
+// Strips walk each row once, so a post-transform cache shorter than a row gets no
+// reuse between rows; which form is faster is up to the driver, and --bench-strips
+// measures it per grid shape.
+
+enum class PrimitiveTopology : uint8_t { Triangles, TriangleStrip };
+
+// Ends the current strip; enabled once by the render device
+const unsigned int primitiveRestartIndex = 0xFFFFFFFFu;
+
+// Requested per mesh. Auto takes the benchmarked form for the grid's shape, and without
+// a measurement the one with fewer vertex shader runs in a simulated cache.
+enum class GridTopology { Auto, Triangles, Strips };
+
+namespace mesh_topology {
+
+const int modelCacheSize = 32; // Post-transform FIFO entries assumed when nothing was measured
+
+// A (columns + 1) x (rows + 1) row-major vertex grid; both triangles of the quad at
+// (r, c) are wound like (r, c) (r + 1, c) (r, c + 1), which every grid here uses
+inline std::vector<unsigned int> gridTriangles(int columns, int rows) {
+    std::vector<unsigned int> indices;
+    indices.reserve((size_t)columns * rows * 6);
+    const unsigned int row = columns + 1;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < columns; ++c) {
+            unsigned int top = r * row + c, bottom = top + row;
+            unsigned int quad[] = { top, bottom, top + 1, top + 1, bottom, bottom + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+    return indices;
+}
+
+// Same triangles and winding: top, bottom, top + 1, bottom + 1, ... per row. Odd strip
+// triangles are flipped by GL, which turns (top + 1, bottom, bottom + 1) back into the
+// list's second triangle.
+inline std::vector<unsigned int> gridStrips(int columns, int rows) {
+    std::vector<unsigned int> indices;
+    indices.reserve((size_t)rows * (2 * columns + 3));
+    const unsigned int row = columns + 1;
+    for (int r = 0; r < rows; ++r) {
+        if (r > 0) indices.push_back(primitiveRestartIndex);
+        for (int c = 0; c <= columns; ++c) {
+            indices.push_back(r * row + c);
+            indices.push_back((r + 1) * row + c);
+        }
+    }
+    return indices;
+}
+
+inline int triangleCount(const unsigned int* indices, size_t count, PrimitiveTopology topology) {
+    if (topology == PrimitiveTopology::Triangles) return (int)(count / 3);
+    int triangles = 0, run = 0;
+    for (size_t i = 0; i <= count; ++i) {
+        if (i == count || indices[i] == primitiveRestartIndex) { triangles += std::max(0, run - 2); run = 0; }
+        else run++;
+    }
+    return triangles;
+}
+
+// Vertex shader runs for the index stream through a FIFO post-transform cache
+inline int simulateTransforms(const unsigned int* indices, size_t count, int cacheSize = modelCacheSize) {
+    std::vector<unsigned int> fifo(cacheSize, primitiveRestartIndex);
+    int head = 0, misses = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] == primitiveRestartIndex) continue;
+        if (std::find(fifo.begin(), fifo.end(), indices[i]) != fifo.end()) continue;
+        fifo[head] = indices[i];
+        head = (head + 1) % cacheSize;
+        misses++;
+    }
+    return misses;
+}
+
+// Reorders a triangle list for the post-transform cache (Forsyth's linear-speed
+// method): greedily emits the triangle whose vertices are most recently used and
+// have the fewest triangles left, so the mesh is finished off locally
+inline void optimizeVertexCache(std::vector<unsigned int>& indices, int vertexCount) {
+    const int cacheSize = modelCacheSize;
+    const int triangleTotal = (int)(indices.size() / 3);
+    std::vector<int> remaining(vertexCount, 0), first(vertexCount + 1, 0), cachePosition(vertexCount, -1);
+    for (unsigned int v : indices) remaining[v]++;
+    for (int v = 0; v < vertexCount; ++v) first[v + 1] = first[v] + remaining[v];
+    // Live triangles of vertex v are adjacent[first[v] .. first[v] + remaining[v])
+    std::vector<int> adjacent(indices.size()), fill(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) adjacent[fill[indices[i]]++] = (int)(i / 3);
+
+    auto vertexScore = [&](int v) {
+        if (remaining[v] == 0) return -1.0f;
+        float score = 0.0f;
+        int position = cachePosition[v];
+        if (position >= 0) score = position < 3 ? 0.75f : std::pow(1.0f - (position - 3) / (float)(cacheSize - 3), 1.5f);
+        return score + 2.0f / std::sqrt((float)remaining[v]);
+    };
+    std::vector<float> vertexScores(vertexCount), triangleScores(triangleTotal);
+    std::vector<bool> emitted(triangleTotal, false);
+    for (int v = 0; v < vertexCount; ++v) vertexScores[v] = vertexScore(v);
+    int best = -1;
+    for (int t = 0; t < triangleTotal; ++t) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+        if (best < 0 || triangleScores[t] > triangleScores[best]) best = t;
+    }
+
+    std::vector<unsigned int> ordered;
+    ordered.reserve(indices.size());
+    std::vector<int> cache, next;
+    cache.reserve(cacheSize + 3); next.reserve(cacheSize + 3);
+    for (int done = 0; done < triangleTotal; ++done) {
+        if (best < 0) { // Nothing left around the cache: restart from the best triangle anywhere
+            for (int t = 0; t < triangleTotal; ++t)
+                if (!emitted[t] && (best < 0 || triangleScores[t] > triangleScores[best])) best = t;
+        }
+        const unsigned int* corner = &indices[best * 3];
+        ordered.insert(ordered.end(), corner, corner + 3);
+        emitted[best] = true;
+        next.clear();
+        for (int k = 0; k < 3; ++k) {
+            int v = corner[k];
+            int* live = &adjacent[first[v]];
+            std::swap(*std::find(live, live + remaining[v], best), live[remaining[v] - 1]);
+            remaining[v]--;
+            next.push_back(v);
+        }
+        for (int v : cache) if (std::find(next.begin(), next.end(), v) == next.end()) next.push_back(v);
+        for (size_t i = 0; i < next.size(); ++i) cachePosition[next[i]] = i < (size_t)cacheSize ? (int)i : -1;
+        for (int v : next) vertexScores[v] = vertexScore(v);
+        best = -1;
+        for (int v : next) {
+            for (int i = 0; i < remaining[v]; ++i) {
+                int t = adjacent[first[v] + i];
+                triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                if (best < 0 || triangleScores[t] > triangleScores[best]) best = t;
+            }
+        }
+        if (next.size() > (size_t)cacheSize) next.resize(cacheSize);
+        cache.swap(next);
+    }
+    indices.swap(ordered);
+}
+
+// Renumbers vertices in the order the indices first use them, so the vertex fetches of an
+// optimised index order walk the buffer forwards; vertices nothing uses are dropped.
+// Restart indices are kept as they are.
+inline void optimizeVertexFetch(std::vector<float>& vertices, int floatsPerVertex, std::vector<unsigned int>& indices) {
+    const unsigned int unassigned = 0xFFFFFFFFu;
+    std::vector<unsigned int> remap(vertices.size() / floatsPerVertex, unassigned);
+    std::vector<float> ordered;
+    ordered.reserve(vertices.size());
+    unsigned int next = 0;
+    for (unsigned int& index : indices) {
+        if (index == primitiveRestartIndex) continue;
+        if (remap[index] == unassigned) {
+            remap[index] = next++;
+            ordered.insert(ordered.end(), vertices.begin() + (size_t)index * floatsPerVertex, vertices.begin() + (size_t)(index + 1) * floatsPerVertex);
+        }
+        index = remap[index];
+    }
+    vertices.swap(ordered);
+}
+
+} // namespace mesh_topology
+
+// --- Benchmarked forms: "grid columns rows strips|triangles" per line ---
+class GridTopologyTable {
+public:
+    void load(const char* path) {
+        FILE* f = fopen(path, "r");
+        if (!f) return;
+        int columns, rows;
+        char form[16];
+        while (fscanf(f, " grid %d %d %15s", &columns, &rows, form) == 3) choices[{ columns, rows }] = std::string(form) == "strips";
+        fclose(f);
+    }
+
+    void save(const char* path) const {
+        FILE* f = fopen(path, "w");
+        if (!f) { EventLog::instance().warning(std::string("Could not write ") + path); return; }
+        for (const auto& it : choices) fprintf(f, "grid %d %d %s\n", it.first.first, it.first.second, it.second ? "strips" : "triangles");
+        fclose(f);
+    }
+
+    void set(int columns, int rows, bool strips) { choices[{ columns, rows }] = strips; }
+
+    bool lookup(int columns, int rows, bool& strips) const {
+        auto it = choices.find({ columns, rows });
+        if (it == choices.end()) return false;
+        strips = it->second;
+        return true;
+    }
+
+private:
+    std::map<std::pair<int, int>, bool> choices;
+};
+
+inline GridTopologyTable& gridTopologyTable() {
+    static GridTopologyTable table;
+    return table;
+}
+
+// Fills indices for the grid described at gridTriangles in the requested form and
+// returns the topology to draw them with
+inline PrimitiveTopology gridIndices(GridTopology requested, int columns, int rows, std::vector<unsigned int>& indices) {
+    std::vector<unsigned int> list = mesh_topology::gridTriangles(columns, rows);
+    mesh_topology::optimizeVertexCache(list, (columns + 1) * (rows + 1));
+    bool strips = requested == GridTopology::Strips;
+    if (requested == GridTopology::Auto && !gridTopologyTable().lookup(columns, rows, strips)) {
+        std::vector<unsigned int> candidate = mesh_topology::gridStrips(columns, rows);
+        strips = mesh_topology::simulateTransforms(candidate.data(), candidate.size()) <= mesh_topology::simulateTransforms(list.data(), list.size());
+    }
+    if (!strips) { indices.swap(list); return PrimitiveTopology::Triangles; }
+    indices = mesh_topology::gridStrips(columns, rows);
+    return PrimitiveTopology::TriangleStrip;
+}
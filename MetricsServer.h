@@ -0,0 +1,155 @@
+#pragma once
+
+#include "EventLog.h"
+#include "MemoryTracker.h"
+
+#include <SFML/Network.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// --- Triple buffer ---
+// Lock-free single-writer/single-reader handoff of the latest value: the writer
+// fills its private slot and swaps it into the middle, the reader swaps the
+// middle out only when something new was published. Neither side ever waits.
+template <typename T>
+class TripleBuffer {
+public:
+    T& writeSlot() { return slots[writeIndex]; }
+    void publish() {
+        writeIndex = middle.exchange(writeIndex | dirtyBit, std::memory_order_acq_rel) & indexMask;
+    }
+    const T& read() {
+        if (middle.load(std::memory_order_relaxed) & dirtyBit)
+            readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return slots[readIndex];
+    }
+
+private:
+    static const int dirtyBit = 4;
+    static const int indexMask = 3;
+    T slots[3] = {};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle{ 2 };
+};
+
+// Everything the frame loop publishes for the metrics endpoint
+struct MetricsSnapshot {
+    unsigned long long frames;
+    unsigned long long hitches;
+    float frameMs;
+    float avgFrameMs; // Exponential moving average
+    float maxFrameMs; // Worst frame of the last full second
+    int drawCalls;
+    int triangles;
+    int parcelsActive;
+    int parcelsTotal;
+    int targetsActive;
+    int score;
+    float inputLatencyMs;    // Input to GPU completion, average of the last 120 measured frames
+    float inputLatencyMaxMs;
+    int audioVoices;
+    int audioVirtualVoices;
+    float audioUpdateMs;
+};
+
+// --- Metrics endpoint ---
+// Serves the latest snapshot as Prometheus text on 127.0.0.1 from its own thread.
+class MetricsServer {
+public:
+    ~MetricsServer() { stop(); }
+
+    bool start(unsigned short port) {
+        if (listener.listen(port, sf::IpAddress::LocalHost) != sf::Socket::Done) return false;
+        running.store(true);
+        worker = std::thread(&MetricsServer::run, this);
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        worker.join();
+        listener.close();
+    }
+
+    MetricsSnapshot& snapshot() { return buffer.writeSlot(); }
+    void publish() { buffer.publish(); }
+
+private:
+    void run() {
+        sf::SocketSelector selector;
+        selector.add(listener);
+        while (running.load()) {
+            if (!selector.wait(sf::milliseconds(100))) continue;
+            sf::TcpSocket client;
+            if (listener.accept(client) != sf::Socket::Done) continue;
+            serve(client);
+        }
+    }
+
+    void serve(sf::TcpSocket& client) {
+        // The request itself does not matter: every path returns the metrics. It is still
+        // read when it arrives in time, but a client that never sends (a port scan, a stuck
+        // scraper) must not hold up this thread, and stop() with it.
+        sf::SocketSelector request;
+        request.add(client);
+        if (request.wait(sf::milliseconds(100))) {
+            char discard[1024];
+            std::size_t received = 0;
+            client.receive(discard, sizeof(discard), received);
+        }
+
+        std::string body = format(buffer.read());
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\nContent-Length: "
+            + std::to_string(body.size()) + "\r\n\r\n" + body;
+        client.send(response.data(), response.size());
+        client.disconnect();
+    }
+
+    static std::string format(const MetricsSnapshot& s) {
+        std::string out;
+        char line[256];
+        auto metric = [&](const char* name, const char* type, double value) {
+            snprintf(line, sizeof(line), "# TYPE %s %s\n%s %.6g\n", name, type, name, value);
+            out += line;
+        };
+        metric("delivery_frames_total", "counter", (double)s.frames);
+        metric("delivery_hitches_total", "counter", (double)s.hitches);
+        metric("delivery_frame_time_ms", "gauge", s.frameMs);
+        metric("delivery_frame_time_avg_ms", "gauge", s.avgFrameMs);
+        metric("delivery_frame_time_max_ms", "gauge", s.maxFrameMs);
+        metric("delivery_draw_calls", "gauge", s.drawCalls);
+        metric("delivery_triangles", "gauge", s.triangles);
+        metric("delivery_parcels_active", "gauge", s.parcelsActive);
+        metric("delivery_parcels_total", "gauge", s.parcelsTotal);
+        metric("delivery_targets_active", "gauge", s.targetsActive);
+        metric("delivery_score", "gauge", s.score);
+        metric("delivery_input_latency_ms", "gauge", s.inputLatencyMs);
+        metric("delivery_input_latency_max_ms", "gauge", s.inputLatencyMaxMs);
+        metric("delivery_audio_voices", "gauge", s.audioVoices);
+        metric("delivery_audio_virtual_voices", "gauge", s.audioVirtualVoices);
+        metric("delivery_audio_update_ms", "gauge", s.audioUpdateMs);
+        metric("delivery_event_log_dropped_total", "counter", (double)EventLog::instance().droppedCount());
+
+        MemoryTracker& mem = MemoryTracker::instance();
+        out += "# TYPE delivery_memory_bytes gauge\n";
+        for (int i = 0; i < (int)MemTag::Count; ++i) {
+            snprintf(line, sizeof(line), "delivery_memory_bytes{tag=\"%s\"} %lld\n", memTagName((MemTag)i), (long long)mem.currentBytes((MemTag)i));
+            out += line;
+        }
+        out += "# TYPE delivery_memory_peak_bytes gauge\n";
+        for (int i = 0; i < (int)MemTag::Count; ++i) {
+            snprintf(line, sizeof(line), "delivery_memory_peak_bytes{tag=\"%s\"} %lld\n", memTagName((MemTag)i), (long long)mem.peakBytes((MemTag)i));
+            out += line;
+        }
+        return out;
+    }
+
+    TripleBuffer<MetricsSnapshot> buffer;
+    sf::TcpListener listener;
+    std::atomic<bool> running{ false };
+    std::thread worker;
+};
@@ -0,0 +1,502 @@
+#pragma once
+
+#include "DeltaCodec.h"
+#include "EventLog.h"
+#include "GameState.h"
+#include "SpatialGrid.h"
+
+#include <SFML/Network.hpp>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// --- Network replication ---
+// Listen-server model over UDP. The host runs the authoritative simulation; clients send
+// their input bitmask every frame and receive fixed-size, quantized snapshots at
+// netTickRate, XOR/RLE-encoded against the last snapshot they acknowledged.
+//
+// Interest management: entities are bucketed in a grid every tick and each client only
+// considers those within netRelevanceRadius of its airship. Candidates are ranked by
+// priority (type weight over distance, with a bonus for being sent last tick so the set
+// does not churn) and fill a fixed number of slots per type. That slot budget bounds the
+// bytes per client, and the grid bounds the work per client, regardless of world size.
+// Both ends are assumed little-endian (tested over loopback).
+
+enum class NetMode { Offline, Host, Client };
+
+const unsigned short defaultNetPort = 7777;
+const float netTickRate = 30.0f;
+
+const float netRelevanceRadius = 150.0f;
+
+const uint16_t netEmptySlot = 0xFFFF;
+const uint16_t netTargetActiveBit = 0x8000;
+
+// Positions travel as 16-bit fixed point: 1/64 unit over +-512 units
+struct NetEntity {
+    uint16_t id;
+    int16_t x, y, z;
+};
+
+// Networked play stays inside what the encoding and the interest grids cover, even on
+// procedural terrain; server and prediction clamp alike, so reconciliation agrees
+const float netWorldHalfExtent = 500.0f;
+
+inline int16_t quantizeCoord(float v) {
+    float q = std::round(v * 64.0f);
+    return (int16_t)(q < -32767.0f ? -32767.0f : (q > 32767.0f ? 32767.0f : q));
+}
+inline float dequantizeCoord(int16_t q) { return q / 64.0f; }
+inline NetEntity makeNetEntity(uint16_t id, const glm::vec3& p) { return { id, quantizeCoord(p.x), quantizeCoord(p.y), quantizeCoord(p.z) }; }
+inline glm::vec3 netEntityPosition(const NetEntity& e) { return glm::vec3(dequantizeCoord(e.x), dequantizeCoord(e.y), dequantizeCoord(e.z)); }
+
+struct NetSnapshot {
+    static const int maxAirships = 16;
+    static const int maxParcels = 64;
+    static const int maxTargets = 32;
+    static const int maxEvents = 16;
+
+    uint32_t tick;
+    uint16_t lastInput; // Newest input sequence the server has applied for this client
+    uint16_t yourId;    // Airship slot owned by the receiver
+    int32_t score;
+    uint16_t targets[maxTargets]; // Target id, ORed with netTargetActiveBit while standing
+    NetEntity airships[maxAirships];
+    NetEntity parcels[maxParcels];
+    // The server's newest events: events[k] is number eventCount - 1 - k, its id the
+    // GameEventKind (None if out of the receiver's range). Resent every tick while they
+    // are among the newest, so a lost snapshot does not lose them.
+    uint32_t eventCount;
+    NetEntity events[maxEvents];
+};
+
+enum NetPacketType : uint8_t { PacketInput = 1, PacketSnapshot = 2 };
+
+// Sequence numbers wrap, so compare by signed distance
+inline bool sequenceNewer(uint16_t a, uint16_t b) { return (int16_t)(a - b) > 0; }
+
+inline void putU16(std::vector<uint8_t>& out, uint16_t v) { out.push_back((uint8_t)v); out.push_back((uint8_t)(v >> 8)); }
+inline void putU32(std::vector<uint8_t>& out, uint32_t v) { putU16(out, (uint16_t)v); putU16(out, (uint16_t)(v >> 16)); }
+inline uint16_t getU16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+inline uint32_t getU32(const uint8_t* p) { return getU16(p) | ((uint32_t)getU16(p + 2) << 16); }
+
+// --- Server ---
+class NetServer {
+public:
+    static const int historySize = 32; // Sent snapshots kept per client as delta baselines
+    static const int inputsPerPacket = 4;
+
+    // A listen server keeps airship slot 0 for the host's own player
+    bool start(unsigned short port, bool reserveHostSlot = true) {
+        firstClientSlot = reserveHostSlot ? 1 : 0;
+        socket.setBlocking(false);
+        return socket.bind(port) == sf::Socket::Done;
+    }
+
+    // Applies every pending client input to the authoritative state
+    void receive(GameState& state, float now) {
+        sf::Clock timer;
+        uint8_t buffer[1024];
+        std::size_t size = 0;
+        sf::IpAddress address;
+        unsigned short port = 0;
+        while (socket.receive(buffer, sizeof(buffer), size, address, port) == sf::Socket::Done) {
+            if (size < 6 || buffer[0] != PacketInput) continue;
+            Client* client = findOrAddClient(state, address, port);
+            if (!client) continue;
+            client->lastHeard = now;
+            uint32_t ack = getU32(buffer + 1);
+            if (ack > client->ackTick) client->ackTick = ack;
+            int count = buffer[5];
+            if (size < 6 + (size_t)count * 4) continue;
+            // Inputs arrive newest first; apply the unseen ones oldest first
+            for (int i = count - 1; i >= 0; --i) {
+                const uint8_t* in = buffer + 6 + i * 4;
+                uint16_t seq = getU16(in);
+                if (client->inputSeen && !sequenceNewer(seq, client->lastInput)) continue;
+                applyInput(state, *client, in[2], in[3] / 1000.0f);
+                client->lastInput = seq;
+                client->inputSeen = true;
+            }
+        }
+        cpuSecondsThisSecond += timer.getElapsedTime().asSeconds();
+    }
+
+    // Sends snapshots at netTickRate and drops clients that went silent
+    void update(GameState& state, float dt, float now) {
+        sendTimer += dt;
+        secondTimer += dt;
+        if (secondTimer >= 1.0f) {
+            bytesPerClientPerSecond = clients.empty() ? 0.0f : bytesThisSecond / (float)clients.size() / secondTimer;
+            cpuUsPerClientPerTick = clients.empty() || ticksThisSecond == 0 ? 0.0f : cpuSecondsThisSecond * 1e6f / clients.size() / ticksThisSecond;
+            bytesThisSecond = 0; secondTimer = 0.0f; cpuSecondsThisSecond = 0.0f; ticksThisSecond = 0;
+        }
+        if (sendTimer < 1.0f / netTickRate) return;
+        sendTimer = std::fmod(sendTimer, 1.0f / netTickRate);
+
+        sf::Clock timer;
+        airshipGrid.build(GameState::maxAirships, [&](int i) { return state.airships[i].position; });
+        parcelGrid.build(state.parcelCount, [&](int i) { return state.parcels[i].position; });
+        if (state.targetCount != gridTargetCount) {
+            targetGrid.build(state.targetCount, [&](int i) { return state.targets[i].position; });
+            gridTargetCount = state.targetCount;
+        }
+        for (size_t i = 0; i < clients.size();) {
+            if (now - clients[i].lastHeard > timeoutSeconds) { removeClient(state, i); continue; }
+            sendSnapshot(state, clients[i]);
+            ++i;
+        }
+        tick++;
+        ticksThisSecond++;
+        lastSendMs = timer.getElapsedTime().asMicroseconds() / 1000.0f;
+        cpuSecondsThisSecond += lastSendMs / 1000.0f;
+    }
+
+    int clientCount() const { return (int)clients.size(); }
+    float sendBytesPerClient() const { return bytesPerClientPerSecond; }
+    float lastTickMs() const { return lastSendMs; }
+    float cpuMicrosecondsPerClient() const { return cpuUsPerClientPerTick; } // Receive + snapshot work, per tick
+
+private:
+    static constexpr float timeoutSeconds = 5.0f;
+
+    struct Client {
+        sf::IpAddress address;
+        unsigned short port = 0;
+        int airship = 0;
+        uint16_t lastInput = 0;
+        bool inputSeen = false;
+        uint32_t ackTick = 0;
+        float lastHeard = 0.0f;
+        NetSnapshot sent[historySize];
+        // Tick each entity was last included, for the priority bonus
+        std::vector<uint32_t> airshipSentTick, parcelSentTick, targetSentTick;
+    };
+
+    static uint64_t clientKey(const sf::IpAddress& address, unsigned short port) {
+        return ((uint64_t)address.toInteger() << 16) | port;
+    }
+
+    Client* findOrAddClient(GameState& state, const sf::IpAddress& address, unsigned short port) {
+        auto it = clientIndex.find(clientKey(address, port));
+        if (it != clientIndex.end()) return &clients[it->second];
+        // Slot 0 belongs to the host
+        int slot = -1;
+        for (int i = firstClientSlot; i < GameState::maxAirships && slot < 0; ++i)
+            if (!state.airships[i].active) slot = i;
+        if (slot < 0) return nullptr;
+        state.airships[slot].active = true;
+        state.airships[slot].position = glm::vec3((slot % 20) * 10.0f - 95.0f, 30.0f, (slot / 20 % 20) * 10.0f - 95.0f);
+        clients.emplace_back();
+        Client& c = clients.back();
+        c.address = address; c.port = port; c.airship = slot;
+        memset(c.sent, 0, sizeof(c.sent));
+        c.airshipSentTick.assign(GameState::maxAirships, 0);
+        c.parcelSentTick.assign(GameState::maxParcels, 0);
+        c.targetSentTick.assign(GameState::maxTargets, 0);
+        clientIndex[clientKey(address, port)] = clients.size() - 1;
+        EventLog::instance().info("Client " + address.toString() + ":" + std::to_string(port) + " joined as airship " + std::to_string(slot));
+        return &c;
+    }
+
+    void removeClient(GameState& state, size_t index) {
+        EventLog::instance().info("Client airship " + std::to_string(clients[index].airship) + " timed out");
+        state.airships[clients[index].airship].active = false;
+        clientIndex.erase(clientKey(clients[index].address, clients[index].port));
+        if (index != clients.size() - 1) {
+            clients[index] = std::move(clients.back());
+            clientIndex[clientKey(clients[index].address, clients[index].port)] = index;
+        }
+        clients.pop_back();
+    }
+
+    void applyInput(GameState& state, Client& client, uint8_t buttons, float dt) {
+        glm::vec3& pos = state.airships[client.airship].position;
+        moveAirship(pos, buttons, dt > 0.1f ? 0.1f : dt, netWorldHalfExtent);
+        if ((buttons & InputDrop) && state.spawnParcel(pos + glm::vec3(0, -4.0f, 0)))
+            EventLog::instance().spawn(state.parcelCount, state.activeParcels());
+    }
+
+    void buildSnapshot(const GameState& state, Client& client, NetSnapshot& snap) {
+        memset(&snap, 0, sizeof(snap));
+        snap.tick = tick;
+        snap.lastInput = client.lastInput;
+        snap.yourId = (uint16_t)client.airship;
+        snap.score = state.score;
+        glm::vec3 center = state.airships[client.airship].position;
+
+        gather(airshipGrid, center, client.airshipSentTick, 4.0f,
+            [&](int i) { return state.airships[i].active; }, [&](int i) { return state.airships[i].position; });
+        fill(NetSnapshot::maxAirships, client.airshipSentTick, [&](int slot, int i) { snap.airships[slot] = makeNetEntity((uint16_t)i, state.airships[i].position); },
+            [&](int slot) { snap.airships[slot] = NetEntity{ netEmptySlot, 0, 0, 0 }; });
+
+        gather(parcelGrid, center, client.parcelSentTick, 2.0f,
+            [&](int i) { return state.parcels[i].active; }, [&](int i) { return state.parcels[i].position; });
+        fill(NetSnapshot::maxParcels, client.parcelSentTick, [&](int slot, int i) { snap.parcels[slot] = makeNetEntity((uint16_t)i, state.parcels[i].position); },
+            [&](int slot) { snap.parcels[slot] = NetEntity{ netEmptySlot, 0, 0, 0 }; });
+
+        gather(targetGrid, center, client.targetSentTick, 1.0f,
+            [&](int i) { return i < state.targetCount; }, [&](int i) { return state.targets[i].position; });
+        fill(NetSnapshot::maxTargets, client.targetSentTick, [&](int slot, int i) { snap.targets[slot] = (uint16_t)i | (state.targets[i].active ? netTargetActiveBit : 0); },
+            [&](int slot) { snap.targets[slot] = netEmptySlot; });
+
+        snap.eventCount = state.eventCount;
+        for (int k = 0; k < NetSnapshot::maxEvents && k < GameState::maxEvents && (uint32_t)k < state.eventCount; ++k) {
+            const GameEvent& e = state.events[(state.eventCount - 1 - k) % GameState::maxEvents];
+            if (glm::length(e.position - center) <= netRelevanceRadius) snap.events[k] = makeNetEntity((uint16_t)e.kind, e.position);
+        }
+    }
+
+    // Collects relevant entities around center into scratch as (-priority, id)
+    template <typename IsLive, typename PositionOf>
+    void gather(const SpatialGrid& grid, const glm::vec3& center, const std::vector<uint32_t>& sentTick, float weight, IsLive isLive, PositionOf positionOf) {
+        scratch.clear();
+        grid.query(center, netRelevanceRadius, [&](int i) {
+            if (!isLive(i)) return;
+            float dist = glm::length(positionOf(i) - center);
+            if (dist > netRelevanceRadius) return;
+            float priority = weight / (1.0f + dist);
+            if (sentTick[i] + 1 == tick) priority *= 1.25f; // Hysteresis against slot churn
+            scratch.push_back(std::make_pair(-priority, i));
+        });
+    }
+
+    // Keeps the `limit` highest-priority entries, written in id order so slots stay stable between ticks
+    template <typename Write, typename Clear>
+    void fill(int limit, std::vector<uint32_t>& sentTick, Write write, Clear clear) {
+        if ((int)scratch.size() > limit) {
+            std::nth_element(scratch.begin(), scratch.begin() + limit, scratch.end());
+            scratch.resize(limit);
+        }
+        std::sort(scratch.begin(), scratch.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.second < b.second; });
+        for (int slot = 0; slot < limit; ++slot) {
+            if (slot < (int)scratch.size()) { write(slot, scratch[slot].second); sentTick[scratch[slot].second] = tick; }
+            else clear(slot);
+        }
+    }
+
+    void sendSnapshot(const GameState& state, Client& client) {
+        NetSnapshot& snap = client.sent[tick % historySize];
+        buildSnapshot(state, client, snap);
+
+        // Delta against the newest acknowledged snapshot if we still have it, else against zeros
+        static const NetSnapshot zero = {};
+        const NetSnapshot* base = &zero;
+        uint32_t baseTick = 0;
+        const NetSnapshot& acked = client.sent[client.ackTick % historySize];
+        if (client.ackTick != 0 && acked.tick == client.ackTick && tick - client.ackTick < historySize) {
+            base = &acked; baseTick = client.ackTick;
+        }
+        encodeXorDelta(reinterpret_cast<const uint8_t*>(base), reinterpret_cast<const uint8_t*>(&snap), sizeof(NetSnapshot), delta);
+
+        packet.clear();
+        packet.push_back(PacketSnapshot);
+        putU32(packet, tick);
+        putU32(packet, baseTick);
+        packet.insert(packet.end(), delta.begin(), delta.end());
+        socket.send(packet.data(), packet.size(), client.address, client.port);
+        bytesThisSecond += packet.size();
+    }
+
+    sf::UdpSocket socket;
+    std::vector<Client> clients;
+    std::unordered_map<uint64_t, size_t> clientIndex;
+    int firstClientSlot = 1;
+    // The snapshot quantization covers +-512 units, so the grids do too; play is clamped inside (netWorldHalfExtent)
+    SpatialGrid airshipGrid{ -512.0f, 512.0f, 32.0f }, parcelGrid{ -512.0f, 512.0f, 32.0f }, targetGrid{ -512.0f, 512.0f, 32.0f };
+    int gridTargetCount = -1;
+    std::vector<std::pair<float, int>> scratch;
+    std::vector<uint8_t> delta, packet;
+    uint32_t tick = 1; // 0 means "no baseline"
+    float sendTimer = 0.0f, secondTimer = 0.0f, bytesPerClientPerSecond = 0.0f, lastSendMs = 0.0f;
+    float cpuSecondsThisSecond = 0.0f, cpuUsPerClientPerTick = 0.0f;
+    int ticksThisSecond = 0;
+    size_t bytesThisSecond = 0;
+};
+
+// --- Client ---
+// Predicts its own airship from local input and replays unacknowledged inputs on every
+// snapshot; everything else is interpolated netInterpolationTicks behind the newest snapshot.
+class NetClient {
+public:
+    static const int historySize = 32;
+    static const int pendingSize = 128;
+
+    bool connect(const sf::IpAddress& address, unsigned short port) {
+        server = address; serverPort = port;
+        socket.setBlocking(false);
+        return socket.bind(sf::Socket::AnyPort) == sf::Socket::Done;
+    }
+
+    bool connected() const { return latestTick != 0; }
+    int localId() const { return localAirship; }
+    float receiveBytesPerSecond() const { return bytesPerSecond; }
+
+    // Predicts this frame's movement and sends it with the previous few inputs for redundancy
+    void sendInput(uint8_t buttons, float dt) {
+        uint8_t dtMs = (uint8_t)std::min(100.0f, std::max(1.0f, std::round(dt * 1000.0f))); // Server clamps to 0.1 s too
+        inputSeq++;
+        pending[inputSeq % pendingSize] = { inputSeq, buttons, dtMs };
+        if (connected()) moveAirship(predicted, buttons, dtMs / 1000.0f, netWorldHalfExtent);
+
+        packet.clear();
+        packet.push_back(PacketInput);
+        putU32(packet, latestTick);
+        int count = inputSeq < NetServer::inputsPerPacket ? inputSeq : NetServer::inputsPerPacket;
+        packet.push_back((uint8_t)count);
+        for (int i = 0; i < count; ++i) {
+            const PendingInput& in = pending[(uint16_t)(inputSeq - i) % pendingSize];
+            putU16(packet, in.seq);
+            packet.push_back(in.buttons);
+            packet.push_back(in.dtMs);
+        }
+        socket.send(packet.data(), packet.size(), server, serverPort);
+    }
+
+    void receive(float dt) {
+        uint8_t buffer[8192];
+        std::size_t size = 0;
+        sf::IpAddress address;
+        unsigned short port = 0;
+        while (socket.receive(buffer, sizeof(buffer), size, address, port) == sf::Socket::Done) {
+            bytesThisSecond += size;
+            if (size < 9 || buffer[0] != PacketSnapshot) continue;
+            uint32_t tick = getU32(buffer + 1), baseTick = getU32(buffer + 5);
+            if (tick <= latestTick) continue; // Late or duplicate
+
+            NetSnapshot snap = {};
+            if (baseTick != 0) {
+                const NetSnapshot& base = received[baseTick % historySize];
+                if (base.tick != baseTick) continue; // Baseline already overwritten
+                snap = base;
+            }
+            if (!applyXorDelta(buffer + 9, size - 9, reinterpret_cast<uint8_t*>(&snap), sizeof(NetSnapshot)) || snap.tick != tick) continue;
+            received[tick % historySize] = snap;
+            onSnapshot(snap);
+        }
+        secondTimer += dt;
+        if (secondTimer >= 1.0f) { bytesPerSecond = bytesThisSecond / secondTimer; bytesThisSecond = 0; secondTimer = 0.0f; }
+    }
+
+    // Writes the replicated world into state for rendering
+    void apply(GameState& state, float dt) {
+        if (!connected()) return;
+        const NetSnapshot& newest = received[latestTick % historySize];
+
+        // Advance the render clock and pull it gently toward the target delay
+        float target = (float)latestTick - netInterpolationTicks;
+        renderTick += dt * netTickRate;
+        if (std::fabs(renderTick - target) > 4.0f) renderTick = target;
+        else renderTick += (target - renderTick) * 0.1f;
+
+        const NetSnapshot* a = nullptr;
+        const NetSnapshot* b = nullptr;
+        uint32_t base = (uint32_t)std::max(1.0f, std::floor(renderTick));
+        for (uint32_t t = base; t + historySize > latestTick && t > 0 && !a; --t)
+            if (received[t % historySize].tick == t) a = &received[t % historySize];
+        for (uint32_t t = base + 1; t <= latestTick && !b; ++t)
+            if (received[t % historySize].tick == t) b = &received[t % historySize];
+        if (!a) a = &newest;
+        if (!b) b = a;
+        float alpha = b->tick > a->tick ? glm::clamp((renderTick - a->tick) / (float)(b->tick - a->tick), 0.0f, 1.0f) : 0.0f;
+
+        for (int i = 0; i < GameState::maxAirships; ++i) state.airships[i].active = false;
+        for (int i = 0; i < NetSnapshot::maxAirships; ++i) {
+            const NetEntity& e = b->airships[i];
+            if (e.id == netEmptySlot || e.id >= GameState::maxAirships) continue;
+            state.airships[e.id].active = true;
+            state.airships[e.id].position = interpolate(a->airships, NetSnapshot::maxAirships, e, alpha);
+        }
+        state.airships[localAirship].active = true;
+        state.airships[localAirship].position = predicted;
+
+        state.parcelCount = 0;
+        for (int i = 0; i < NetSnapshot::maxParcels; ++i) {
+            const NetEntity& e = b->parcels[i];
+            if (e.id == netEmptySlot) continue;
+            Parcel& p = state.parcels[state.parcelCount++];
+            p = Parcel();
+            p.id = e.id;
+            p.position = interpolate(a->parcels, NetSnapshot::maxParcels, e, alpha);
+        }
+
+        // Landings and hits only as the server reports them, none from before we joined
+        for (int k = 0; k < NetSnapshot::maxEvents && k < GameState::maxEvents && (uint32_t)k < newest.eventCount; ++k) {
+            uint32_t sequence = newest.eventCount - 1 - k;
+            GameEvent& out = state.events[sequence % GameState::maxEvents];
+            out.sequence = sequence;
+            out.kind = sequence >= firstEvent ? (GameEventKind)newest.events[k].id : GameEventKind::None;
+            out.position = netEntityPosition(newest.events[k]);
+        }
+        state.eventCount = newest.eventCount;
+
+        // Houses outside the relevance radius keep the last state we heard for them
+        for (int i = 0; i < NetSnapshot::maxTargets; ++i) {
+            uint16_t t = newest.targets[i];
+            if (t == netEmptySlot) continue;
+            int id = t & ~netTargetActiveBit;
+            if (id < state.targetCount) state.targets[id].active = (t & netTargetActiveBit) != 0;
+        }
+        if (newest.score > state.score) EventLog::instance().score(newest.score, predicted);
+        state.score = newest.score;
+    }
+
+private:
+    struct PendingInput {
+        uint16_t seq;
+        uint8_t buttons;
+        uint8_t dtMs;
+    };
+
+    static constexpr float netInterpolationTicks = 2.0f;
+
+    void onSnapshot(const NetSnapshot& snap) {
+        bool first = latestTick == 0;
+        latestTick = snap.tick;
+        localAirship = snap.yourId < GameState::maxAirships ? snap.yourId : 0;
+        if (first) { renderTick = (float)latestTick - netInterpolationTicks; firstEvent = snap.eventCount; }
+
+        // Reconcile: start from the authoritative position, replay inputs it has not seen
+        for (int i = 0; i < NetSnapshot::maxAirships; ++i) {
+            if (snap.airships[i].id != snap.yourId) continue;
+            predicted = netEntityPosition(snap.airships[i]);
+            uint16_t start = snap.lastInput + 1;
+            uint16_t oldestKept = inputSeq - pendingSize + 1;
+            if (sequenceNewer(oldestKept, start)) start = oldestKept;
+            for (uint16_t seq = start; !sequenceNewer(seq, inputSeq); ++seq) {
+                const PendingInput& in = pending[seq % pendingSize];
+                if (in.seq == seq) moveAirship(predicted, in.buttons, in.dtMs / 1000.0f, netWorldHalfExtent);
+            }
+            break;
+        }
+    }
+
+    // Matches e by id in the older snapshot; new arrivals snap to their current position
+    static glm::vec3 interpolate(const NetEntity* older, int count, const NetEntity& e, float alpha) {
+        glm::vec3 to = netEntityPosition(e);
+        for (int i = 0; i < count; ++i)
+            if (older[i].id == e.id) return glm::mix(netEntityPosition(older[i]), to, alpha);
+        return to;
+    }
+
+    sf::UdpSocket socket;
+    sf::IpAddress server;
+    unsigned short serverPort = 0;
+    NetSnapshot received[historySize] = {};
+    PendingInput pending[pendingSize] = {};
+    std::vector<uint8_t> packet;
+    uint32_t latestTick = 0;
+    uint16_t inputSeq = 0;
+    int localAirship = 0;
+    uint32_t firstEvent = 0;
+    glm::vec3 predicted;
+    float renderTick = 0.0f;
+    float secondTimer = 0.0f, bytesPerSecond = 0.0f;
+    size_t bytesThisSecond = 0;
+};
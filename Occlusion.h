@@ -0,0 +1,150 @@
+#pragma once
+
+#include "RenderState.h"
+#include "Shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdint>
+#include <memory>
+
+// --- Occlusion culling ---
+// Large objects get a bounding-box GL_ANY_SAMPLES_PASSED query drawn after the scene,
+// and the next frame draws them inside glBeginConditionalRender(GL_QUERY_NO_WAIT), so
+// the GPU skips them when the box was hidden and the CPU never waits for a result.
+// Results are also read back when they happen to be ready: objects seen visible are
+// then only re-tested every retestInterval frames (and drawn unconditionally), while
+// hidden or unknown ones are tested every frame. Each object ping-pongs between two
+// queries so the one being issued is never the one being conditioned on.
+class OcclusionCuller {
+public:
+    static const int maxObjects = 320;
+    static const int retestInterval = 8;
+
+    void init() {
+        const char* vertexSource = R"(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;
+            uniform mat4 viewProjection; uniform vec3 boxMin; uniform vec3 boxMax;
+            void main() { gl_Position = viewProjection * vec4(mix(boxMin, boxMax, aPos), 1.0); }
+        )";
+        const char* fragmentSource = R"(
+            #version 330 core
+            out vec4 FragColor;
+            void main() { FragColor = vec4(1.0); }
+        )";
+        shader.reset(new Shader(vertexSource, fragmentSource));
+        viewProjectionLocation = glGetUniformLocation(shader->ID, "viewProjection");
+        boxMinLocation = glGetUniformLocation(shader->ID, "boxMin");
+        boxMaxLocation = glGetUniformLocation(shader->ID, "boxMax");
+
+        const float corners[] = { 0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1 };
+        const uint8_t faces[] = { 0,2,1, 0,3,2, 4,5,6, 4,6,7, 0,1,5, 0,5,4, 3,6,2, 3,7,6, 0,4,7, 0,7,3, 1,2,6, 1,6,5 };
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glState().bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(faces), faces, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+
+        for (Object& o : objects) glGenQueries(2, o.queries);
+    }
+
+    // Reads back whatever results are ready; call once per frame before recording
+    void beginFrame() {
+        frame++;
+        hidden = 0;
+        for (Object& o : objects) {
+            for (int q = 0; q < 2; ++q) {
+                if (!o.pending[q]) continue;
+                GLint available = 0;
+                glGetQueryObjectiv(o.queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) continue;
+                GLint passed = 0;
+                glGetQueryObjectiv(o.queries[q], GL_QUERY_RESULT, &passed);
+                o.pending[q] = false;
+                if (o.queryFrame[q] < o.resultFrame) continue; // A newer result already arrived
+                o.resultFrame = o.queryFrame[q];
+                o.visible = passed != 0;
+                o.known = true;
+            }
+            if (o.known && !o.visible) hidden++;
+        }
+    }
+
+    // Called while recording, from the partition that owns the object. Returns the query
+    // to condition the object's draws on, or 0 to draw it unconditionally.
+    unsigned int object(int id, const glm::vec3& lo, const glm::vec3& hi, const glm::vec3& cameraPos) {
+        Object& o = objects[id];
+        // Slightly larger than the object, so the box is never hidden behind its own contents
+        o.lo = lo - glm::vec3(0.5f);
+        o.hi = hi + glm::vec3(0.5f);
+        glm::vec3 nearLo = o.lo - glm::vec3(1.0f), nearHi = o.hi + glm::vec3(1.0f);
+        bool inside = cameraPos.x >= nearLo.x && cameraPos.y >= nearLo.y && cameraPos.z >= nearLo.z
+            && cameraPos.x <= nearHi.x && cameraPos.y <= nearHi.y && cameraPos.z <= nearHi.z;
+        if (inside) {
+            // The near plane would clip the box; the object is certainly visible
+            o.test = false;
+            o.visible = o.known = true;
+            return 0;
+        }
+        bool stableVisible = o.known && o.visible;
+        o.test = !stableVisible || (frame + id) % retestInterval == 0;
+        bool issuedLastFrame = o.issuedFrame == frame - 1;
+        return issuedLastFrame && !stableVisible ? o.queries[(frame - 1) & 1] : 0;
+    }
+
+    // Draws the boxes of the objects due for a test; call after the scene is drawn
+    void issueQueries(const glm::mat4& viewProjection) {
+        tests = 0;
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        shader->use();
+        glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+        glState().bindVertexArray(VAO);
+        for (Object& o : objects) {
+            if (!o.test) continue;
+            int q = frame & 1;
+            glUniform3fv(boxMinLocation, 1, glm::value_ptr(o.lo));
+            glUniform3fv(boxMaxLocation, 1, glm::value_ptr(o.hi));
+            glBeginQuery(GL_ANY_SAMPLES_PASSED, o.queries[q]);
+            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, 0);
+            glEndQuery(GL_ANY_SAMPLES_PASSED);
+            o.pending[q] = true;
+            o.queryFrame[q] = frame;
+            o.issuedFrame = frame;
+            o.test = false;
+            tests++;
+        }
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    }
+
+    int testsIssued() const { return tests; }
+    int knownHidden() const { return hidden; }
+
+private:
+    struct Object {
+        GLuint queries[2] = {};
+        bool pending[2] = {};
+        uint32_t queryFrame[2] = {};
+        uint32_t resultFrame = 0;
+        bool known = false;   // A result has been read back at least once
+        bool visible = true;  // Latest result read back
+        bool test = false;    // Box is drawn this frame
+        uint32_t issuedFrame = 0;
+        glm::vec3 lo, hi;
+    };
+
+    std::unique_ptr<Shader> shader;
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    int viewProjectionLocation = -1, boxMinLocation = -1, boxMaxLocation = -1;
+    Object objects[maxObjects];
+    uint32_t frame = 1; // issuedFrame 0 means never
+    int tests = 0, hidden = 0;
+};
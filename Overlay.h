@@ -0,0 +1,199 @@
+#pragma once
+
+#include "MemoryTracker.h"
+#include "RenderState.h"
+#include "Shader.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// --- Stats overlay ---
+// Text and the frame-time graph are quads in one streamed vertex buffer, textured
+// from a baked 5x7 glyph atlas, so the whole overlay is a single draw call.
+class StatsOverlay {
+public:
+    static const int historySize = 120;
+
+    void init() {
+        const char* vertexSource = R"(
+            #version 330 core
+            layout (location = 0) in vec2 aPos;
+            layout (location = 1) in vec2 aTexCoords;
+            layout (location = 2) in vec4 aColor;
+            out vec2 TexCoords; out vec4 Color;
+            uniform vec2 screenSize;
+            void main() {
+                vec2 ndc = aPos / screenSize * 2.0 - 1.0;
+                gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0); TexCoords = aTexCoords; Color = aColor;
+            }
+        )";
+        const char* fragmentSource = R"(
+            #version 330 core
+            out vec4 FragColor;
+            in vec2 TexCoords; in vec4 Color;
+            uniform sampler2D atlas;
+            void main() { FragColor = vec4(Color.rgb, Color.a * texture(atlas, TexCoords).r); }
+        )";
+        shader.reset(new Shader(vertexSource, fragmentSource));
+        buildAtlas();
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glState().bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glEnableVertexAttribArray(0); glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexAttribArray(1); glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(2); glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)(4 * sizeof(float)));
+        vertices.reserve(16384);
+    }
+
+    void pushFrameTime(float ms) {
+        history[historyHead] = ms;
+        historyHead = (historyHead + 1) % historySize;
+    }
+
+    void begin() { vertices.clear(); }
+
+    void rect(float x, float y, float w, float h, uint32_t rgba) {
+        // Sample the middle of the solid cell so filtering never reaches a glyph edge
+        float u = (solidCell % atlasColumns * cellSize + cellSize * 0.5f) / atlasWidth;
+        float v = (solidCell / atlasColumns * cellSize + cellSize * 0.5f) / atlasHeight;
+        quad(x, y, x + w, y + h, u, v, u, v, rgba);
+    }
+
+    void text(float x, float y, const char* s, uint32_t rgba) {
+        for (; *s; ++s, x += glyphAdvance) {
+            char c = *s;
+            if (c >= 'a' && c <= 'z') c = c - 'a' + 'A';
+            if (c <= ' ' || c > '~') continue;
+            int cell = c - ' ';
+            float u0 = (float)(cell % atlasColumns * cellSize) / atlasWidth;
+            float v0 = (float)(cell / atlasColumns * cellSize) / atlasHeight;
+            quad(x, y, x + 5 * glyphScale, y + 7 * glyphScale, u0, v0, u0 + 5.0f / atlasWidth, v0 + 7.0f / atlasHeight, rgba);
+        }
+    }
+
+    // Bars scaled to maxMs, with a marker line at the 60 Hz budget
+    void frameGraph(float x, float y, float w, float h, float maxMs) {
+        rect(x, y, w, h, 0x00000099);
+        float barWidth = w / historySize;
+        for (int i = 0; i < historySize; ++i) {
+            float ms = history[(historyHead + i) % historySize];
+            float barHeight = (ms < maxMs ? ms : maxMs) / maxMs * h;
+            uint32_t color = ms < 17.0f ? 0x40E040FF : (ms < 34.0f ? 0xE0E040FF : 0xE04040FF);
+            rect(x + i * barWidth, y + h - barHeight, barWidth, barHeight, color);
+        }
+        rect(x, y + h - 16.7f / maxMs * h, w, 1.0f, 0xFFFFFFAA);
+    }
+
+    void draw(int screenWidth, int screenHeight) {
+        if (vertices.empty()) return;
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        shader->use();
+        shader->setVec2("screenSize", glm::vec2((float)screenWidth, (float)screenHeight));
+        shader->setInt("atlas", 0);
+        glState().bindTexture(0, atlas);
+        glState().bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // Orphan the previous frame's storage so the upload never waits on the GPU
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+        renderStats().drawCalls++; renderStats().triangles += (int)vertices.size() / 3;
+
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    static const int lineHeight = 18;
+
+private:
+    struct Vertex {
+        float x, y, u, v;
+        uint8_t r, g, b, a;
+    };
+
+    static const int glyphScale = 2;
+    static const int glyphAdvance = 6 * glyphScale;
+    static const int cellSize = 8;
+    static const int atlasColumns = 16;
+    static const int atlasWidth = atlasColumns * cellSize;
+    static const int atlasHeight = 6 * cellSize;
+    static const int solidCell = 127 - ' '; // DEL is baked as a filled cell
+
+    void quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, uint32_t rgba) {
+        uint8_t r = rgba >> 24, g = (rgba >> 16) & 0xFF, b = (rgba >> 8) & 0xFF, a = rgba & 0xFF;
+        Vertex tl = { x0, y0, u0, v0, r, g, b, a }, tr = { x1, y0, u1, v0, r, g, b, a };
+        Vertex bl = { x0, y1, u0, v1, r, g, b, a }, br = { x1, y1, u1, v1, r, g, b, a };
+        vertices.push_back(tl); vertices.push_back(bl); vertices.push_back(tr);
+        vertices.push_back(tr); vertices.push_back(bl); vertices.push_back(br);
+    }
+
+    void buildAtlas() {
+        // 5x7 glyphs, one byte per row, bit 4 is the leftmost pixel. Lowercase maps to uppercase.
+        struct Glyph { char c; uint8_t rows[7]; };
+        static const Glyph font[] = {
+            { '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } }, { '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+            { '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } }, { '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+            { '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } }, { '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+            { '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } }, { '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+            { '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } }, { '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+            { 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } }, { 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+            { 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } }, { 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+            { 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } }, { 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+            { 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } }, { 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+            { 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } }, { 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+            { 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } }, { 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+            { 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } }, { 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+            { 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } }, { 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+            { 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } }, { 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+            { 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } }, { 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+            { 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } }, { 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+            { 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } }, { 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+            { 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } }, { 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+            { '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } }, { ',', { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 } },
+            { ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } }, { '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+            { '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } }, { '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+            { '+', { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 } }, { '=', { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } },
+            { '(', { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } }, { ')', { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } },
+            { '[', { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E } }, { ']', { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E } },
+            { '!', { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 } }, { '?', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 } },
+            { '_', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F } }, { '*', { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 } },
+            { '<', { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 } }, { '>', { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 } },
+            { '#', { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A } }, { '\'', { 0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 } },
+        };
+
+        std::vector<uint8_t> pixels(atlasWidth * atlasHeight, 0);
+        for (const Glyph& g : font) {
+            int cell = g.c - ' ';
+            int ox = cell % atlasColumns * cellSize, oy = cell / atlasColumns * cellSize;
+            for (int row = 0; row < 7; ++row)
+                for (int col = 0; col < 5; ++col)
+                    if (g.rows[row] & (0x10 >> col)) pixels[(oy + row) * atlasWidth + ox + col] = 255;
+        }
+        int ox = solidCell % atlasColumns * cellSize, oy = solidCell / atlasColumns * cellSize;
+        for (int row = 0; row < cellSize; ++row) memset(&pixels[(oy + row) * atlasWidth + ox], 255, cellSize);
+
+        glGenTextures(1, &atlas);
+        glState().bindTexture(0, atlas);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        MemoryTracker::instance().setGpuObject(MemTag::TextureGPU, atlas, atlasWidth * atlasHeight);
+    }
+
+    std::unique_ptr<Shader> shader;
+    unsigned int VAO = 0, VBO = 0, atlas = 0;
+    std::vector<Vertex> vertices;
+    float history[historySize] = {};
+    int historyHead = 0;
+};
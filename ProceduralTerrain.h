@@ -0,0 +1,429 @@
+#pragma once
+
+#include "Frustum.h"
+#include "MemoryTracker.h"
+#include "RenderDevice.h"
+
+#include <SFML/System.hpp>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TERRAIN_NOISE_SIMD 1
+#else
+#define TERRAIN_NOISE_SIMD 0
+#endif
+
+// --- Terrain noise ---
+// Seeded gradient noise with lattice gradients hashed from the cell coordinates, so there
+// is no permutation table to gather from and four samples evaluate in one SSE2 register.
+// The functions are templates over the lane type: float/uint32_t for single queries and
+// Float4/Int4 for tile generation run exactly the same arithmetic.
+namespace terrain_noise {
+
+inline uint32_t floorToInt(float x) { return (uint32_t)(int32_t)std::floor(x); }
+inline float toFloat(uint32_t i) { return (float)(int32_t)i; }
+inline float absolute(float x) { return std::fabs(x); }
+inline float clampZero(float x) { return x > 0.0f ? x : 0.0f; }
+
+#if TERRAIN_NOISE_SIMD
+struct Float4 {
+    __m128 v;
+    Float4(__m128 v) : v(v) {}
+    Float4(float s) : v(_mm_set1_ps(s)) {}
+};
+inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+
+struct Int4 {
+    __m128i v;
+    Int4(__m128i v) : v(v) {}
+    Int4(uint32_t s) : v(_mm_set1_epi32((int)s)) {}
+};
+inline Int4 operator+(Int4 a, Int4 b) { return _mm_add_epi32(a.v, b.v); }
+inline Int4 operator^(Int4 a, Int4 b) { return _mm_xor_si128(a.v, b.v); }
+inline Int4 operator&(Int4 a, Int4 b) { return _mm_and_si128(a.v, b.v); }
+inline Int4 operator>>(Int4 a, int bits) { return _mm_srli_epi32(a.v, bits); }
+// SSE2 has no 32-bit low multiply; two 32x32->64 multiplies cover the even and odd lanes
+inline Int4 operator*(Int4 a, Int4 b) {
+    __m128i even = _mm_mul_epu32(a.v, b.v);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a.v, 32), _mm_srli_epi64(b.v, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline Int4 floorToInt(Float4 x) {
+    __m128i t = _mm_cvttps_epi32(x.v);
+    __m128 above = _mm_cmpgt_ps(_mm_cvtepi32_ps(t), x.v); // Truncation rounded a negative up
+    return _mm_add_epi32(t, _mm_castps_si128(above));
+}
+inline Float4 toFloat(Int4 i) { return _mm_cvtepi32_ps(i.v); }
+inline Float4 absolute(Float4 x) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x.v); }
+inline Float4 clampZero(Float4 x) { return _mm_max_ps(x.v, _mm_setzero_ps()); }
+#endif
+
+template <typename I>
+inline I hash(I x, I z, uint32_t seed) {
+    I h = x * I(0x27d4eb2du) ^ z * I(0x165667b1u) ^ I(seed);
+    h = h ^ (h >> 15);
+    h = h * I(0x2c1b3c6du);
+    h = h ^ (h >> 12);
+    h = h * I(0x297a2d39u);
+    return h ^ (h >> 15);
+}
+
+// Lattice gradient from the hash's two halves, dotted with the offset to the corner
+template <typename F, typename I>
+inline F cornerDot(I h, F dx, F dz) {
+    const float scale = 1.0f / 32767.5f;
+    F gx = toFloat(h & I(0xFFFFu)) * F(scale) - F(1.0f);
+    F gz = toFloat(h >> 16) * F(scale) - F(1.0f);
+    return gx * dx + gz * dz;
+}
+
+// Roughly -1..1
+template <typename F, typename I>
+inline F gradient(F x, F z, uint32_t seed) {
+    I ix = floorToInt(x), iz = floorToInt(z);
+    F fx = x - toFloat(ix), fz = z - toFloat(iz);
+    I ix1 = ix + I(1u), iz1 = iz + I(1u);
+    F d00 = cornerDot(hash(ix, iz, seed), fx, fz);
+    F d10 = cornerDot(hash(ix1, iz, seed), fx - F(1.0f), fz);
+    F d01 = cornerDot(hash(ix, iz1, seed), fx, fz - F(1.0f));
+    F d11 = cornerDot(hash(ix1, iz1, seed), fx - F(1.0f), fz - F(1.0f));
+    F u = fx * fx * fx * (fx * (fx * F(6.0f) - F(15.0f)) + F(10.0f));
+    F v = fz * fz * fz * (fz * (fz * F(6.0f) - F(15.0f)) + F(10.0f));
+    F a = d00 + (d10 - d00) * u;
+    F b = d01 + (d11 - d01) * u;
+    return (a + (b - a) * v) * F(1.4f);
+}
+
+template <typename F, typename I>
+inline F fbm(F x, F z, uint32_t seed, int octaves) {
+    F sum(0.0f);
+    float amplitude = 0.5f, frequency = 1.0f;
+    for (int i = 0; i < octaves; ++i) {
+        sum = sum + gradient<F, I>(x * F(frequency), z * F(frequency), seed + (uint32_t)i * 0x9E3779B9u) * F(amplitude);
+        frequency *= 2.0f;
+        amplitude *= 0.5f;
+    }
+    return sum;
+}
+
+// Sharp crests where the noise crosses zero; each octave is weighted by the one above it
+template <typename F, typename I>
+inline F ridged(F x, F z, uint32_t seed, int octaves) {
+    F sum(0.0f), weight(1.0f);
+    float amplitude = 0.5f, frequency = 1.0f;
+    for (int i = 0; i < octaves; ++i) {
+        F n = F(1.0f) - absolute(gradient<F, I>(x * F(frequency), z * F(frequency), seed ^ (0x85EBCA6Bu + (uint32_t)i * 0x9E3779B9u)));
+        n = n * n * weight;
+        weight = n;
+        sum = sum + n * F(amplitude);
+        frequency *= 2.0f;
+        amplitude *= 0.5f;
+    }
+    return sum;
+}
+
+// World-space terrain height: rolling fBm hills, with ridged mountains where a very low
+// frequency mask allows them. Stays within about 0..28 so airships at cruise height clear it.
+template <typename F, typename I>
+inline F height(F x, F z, uint32_t seed) {
+    F px = x * F(1.0f / 256.0f), pz = z * F(1.0f / 256.0f);
+    F hills = fbm<F, I>(px, pz, seed, 5);
+    F mask = clampZero(fbm<F, I>(px * F(0.25f), pz * F(0.25f), seed + 17u, 2) * F(2.5f) + F(0.2f));
+    mask = mask * mask;
+    F mountains = ridged<F, I>(px * F(0.5f), pz * F(0.5f), seed + 31u, 4);
+    return clampZero(F(6.0f) + hills * F(8.0f) + mountains * mask * F(14.0f));
+}
+
+} // namespace terrain_noise
+
+// --- Procedural terrain ---
+// Infinite terrain from seeded noise, in square tiles generated on worker threads around
+// a point ahead of the camera. Tiles live in a ring indexed by tile coordinate modulo the
+// ring size, so finding a tile is two modulos and streaming never allocates: each slot
+// keeps its height grid, and vertex data goes through a few preallocated staging buffers
+// that also bound how many tiles are in flight. The render thread uploads at most
+// uploadsPerFrame finished tiles per frame. Height queries read the tile's grid when it
+// is resident and evaluate the same noise directly otherwise, so gameplay never depends
+// on what has streamed in; a dedicated server uses only that path.
+class ProceduralTerrain {
+public:
+    static const int tileQuads = 32;             // Quads per tile edge
+    static constexpr float tileSize = 64.0f;     // World units per tile edge
+    static const int maxRadiusTiles = 10;        // Streaming radius cap, about 640 units
+    static const int ringSize = 2 * maxRadiusTiles + 3;
+    static const int stagingCount = 8;           // Tiles in flight
+    static const int uploadsPerFrame = 4;
+    static constexpr float lookaheadSeconds = 1.5f;
+
+    explicit ProceduralTerrain(uint32_t seed) : seed(seed) {}
+
+    ~ProceduralTerrain() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quitting = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+    // Everything that streaming needs is allocated here
+    void startStreaming(RenderDevice& renderDevice, int workerCount) {
+        device = &renderDevice;
+        tiles.resize(ringSize * ringSize);
+        MemoryTracker::instance().add(MemTag::Scene, (int64_t)(tiles.size() * sizeof(Tile)));
+        for (Staging& s : staging) s.vertices.resize(verticesPerTile * floatsPerVertex);
+        MemoryTracker::instance().add(MemTag::MeshCPU, (int64_t)stagingCount * verticesPerTile * floatsPerVertex * sizeof(float));
+        topology = gridIndices(GridTopology::Auto, tileQuads, tileQuads, indices); // Shared by every tile
+        // Nearest first, so the tiles under the camera are always requested before the horizon
+        for (int dz = -maxRadiusTiles; dz <= maxRadiusTiles; ++dz)
+            for (int dx = -maxRadiusTiles; dx <= maxRadiusTiles; ++dx)
+                if (dx * dx + dz * dz <= maxRadiusTiles * maxRadiusTiles) offsets.push_back({ dx, dz });
+        std::sort(offsets.begin(), offsets.end(), [](const Offset& a, const Offset& b) { return a.dx * a.dx + a.dz * a.dz < b.dx * b.dx + b.dz * b.dz; });
+        for (int i = 0; i < workerCount; ++i) workers.emplace_back(&ProceduralTerrain::workerLoop, this);
+    }
+
+    bool streaming() const { return device != nullptr; }
+
+    // Render thread, once per frame before recording
+    void update(const glm::vec3& position, const glm::vec3& velocity, float radius) {
+        sf::Clock timer;
+        uploadFinished();
+
+        int radiusTiles = (int)std::ceil(radius / tileSize);
+        if (radiusTiles > maxRadiusTiles) radiusTiles = maxRadiusTiles;
+        // Look ahead, but never so far that the camera's own tile leaves the wanted set
+        float lookahead = lookaheadSeconds;
+        glm::vec2 shift(velocity.x * lookahead, velocity.z * lookahead);
+        float maxShift = (radiusTiles - 1) * tileSize;
+        if (glm::length(shift) > maxShift) shift = shift * (maxShift / glm::length(shift));
+        int centerX = tileCoord(position.x + shift.x), centerZ = tileCoord(position.z + shift.y);
+
+        missing = 0;
+        for (const Offset& o : offsets) {
+            if (o.dx * o.dx + o.dz * o.dz > radiusTiles * radiusTiles) break;
+            int tx = centerX + o.dx, tz = centerZ + o.dz;
+            Tile& tile = slot(tx, tz);
+            if (tile.state != TileState::Empty && tile.tx == tx && tile.tz == tz) {
+                if (tile.state != TileState::Resident) missing++;
+                continue;
+            }
+            missing++;
+            if (tile.state == TileState::Queued) continue; // Its worker must finish with the old tile first
+            int s = freeStaging();
+            if (s < 0) continue;
+            evict(tile);
+            tile.tx = tx; tile.tz = tz;
+            tile.state = TileState::Queued;
+            staging[s].free = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs[(jobHead + jobCount++) % stagingCount] = { (int)(&tile - tiles.data()), s };
+            }
+            wake.notify_one();
+        }
+        lastUpdateMs = timer.getElapsedTime().asMicroseconds() / 1000.0f;
+    }
+
+    // Any thread that does not race update(), e.g. a recording job
+    void record(CommandList& list, int pipeline, unsigned int albedo, const ViewSet& views) const {
+        static const glm::mat4 identity(1.0f); // Tiles are built in world space
+        for (const Tile& tile : tiles) {
+            if (tile.state != TileState::Resident) continue;
+            uint8_t mask = views.boxMask(tile.lo, tile.hi);
+            if (!mask) { list.culled++; continue; }
+            list.visible++;
+            list.beginViews(mask);
+            list.draw(pipeline, tile.mesh, identity, albedo);
+        }
+        list.endViews();
+    }
+
+    // Bilinear over the tile grid, or straight from the noise when the tile is not resident
+    float height(float x, float z) const {
+        const float spacing = tileSize / tileQuads;
+        int tx = tileCoord(x), tz = tileCoord(z);
+        float gx = (x - tx * tileSize) / spacing, gz = (z - tz * tileSize) / spacing;
+        int ix = std::min((int)gx, tileQuads - 1), iz = std::min((int)gz, tileQuads - 1);
+        float fx = gx - ix, fz = gz - iz;
+        float h00, h10, h01, h11;
+        const Tile* tile = tiles.empty() ? nullptr : &slot(tx, tz);
+        if (tile && tile->state == TileState::Resident && tile->tx == tx && tile->tz == tz) {
+            const float* row = tile->heights + iz * (tileQuads + 1) + ix;
+            h00 = row[0]; h10 = row[1]; h01 = row[tileQuads + 1]; h11 = row[tileQuads + 2];
+        }
+        else {
+            float x0 = tx * tileSize + ix * spacing, z0 = tz * tileSize + iz * spacing;
+            h00 = terrain_noise::height<float, uint32_t>(x0, z0, seed);
+            h10 = terrain_noise::height<float, uint32_t>(x0 + spacing, z0, seed);
+            h01 = terrain_noise::height<float, uint32_t>(x0, z0 + spacing, seed);
+            h11 = terrain_noise::height<float, uint32_t>(x0 + spacing, z0 + spacing, seed);
+        }
+        float a = h00 + (h10 - h00) * fx, b = h01 + (h11 - h01) * fx;
+        return a + (b - a) * fz;
+    }
+
+    int residentTiles() const {
+        int n = 0;
+        for (const Tile& tile : tiles) n += tile.state == TileState::Resident;
+        return n;
+    }
+    int missingTiles() const { return missing; } // Wanted last update but not drawable yet
+    float updateMs() const { return lastUpdateMs; }
+    float generateMs() const { // Average worker time per tile
+        int64_t n = generated.load();
+        return n > 0 ? generateMicros.load() / 1000.0f / n : 0.0f;
+    }
+
+private:
+    static const int floatsPerVertex = 14;
+    static const int verticesPerTile = (tileQuads + 1) * (tileQuads + 1);
+
+    enum class TileState : uint8_t { Empty, Queued, Resident };
+
+    struct Tile {
+        int tx = 0, tz = 0;
+        TileState state = TileState::Empty;
+        float heights[(tileQuads + 1) * (tileQuads + 1)];
+        MeshBuffers mesh;
+        glm::vec3 lo, hi;
+    };
+
+    struct Staging {
+        std::vector<float> vertices;
+        bool free = true;
+    };
+
+    struct Job { int tile, staging; };
+    struct Offset { int dx, dz; };
+
+    static int tileCoord(float world) { return (int)std::floor(world / tileSize); }
+    static int wrap(int i) { return ((i % ringSize) + ringSize) % ringSize; }
+    Tile& slot(int tx, int tz) { return tiles[wrap(tz) * ringSize + wrap(tx)]; }
+    const Tile& slot(int tx, int tz) const { return tiles[wrap(tz) * ringSize + wrap(tx)]; }
+
+    int freeStaging() const {
+        for (int i = 0; i < stagingCount; ++i) if (staging[i].free) return i;
+        return -1;
+    }
+
+    void evict(Tile& tile) {
+        if (tile.state == TileState::Resident) device->destroyMesh(tile.mesh);
+        tile.state = TileState::Empty;
+    }
+
+    void uploadFinished() {
+        for (int uploads = 0; uploads < uploadsPerFrame; ++uploads) {
+            Job done;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (doneCount == 0) return;
+                done = finished[doneHead];
+                doneHead = (doneHead + 1) % stagingCount;
+                doneCount--;
+            }
+            Tile& tile = tiles[done.tile];
+            Staging& s = staging[done.staging];
+            FrameAllocationGuard::Exempt exempt; // Budgeted upload; GPU bookkeeping may allocate
+            tile.mesh = device->createMesh(s.vertices.data(), s.vertices.size(), indices.data(), indices.size(), topology);
+            tile.state = TileState::Resident;
+            s.free = true;
+        }
+    }
+
+    void workerLoop() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return quitting || jobCount > 0; });
+                if (quitting) return;
+                job = jobs[jobHead];
+                jobHead = (jobHead + 1) % stagingCount;
+                jobCount--;
+            }
+            sf::Clock timer;
+            generate(tiles[job.tile], staging[job.staging].vertices.data());
+            generateMicros += timer.getElapsedTime().asMicroseconds();
+            generated++;
+            std::lock_guard<std::mutex> lock(mutex);
+            finished[(doneHead + doneCount++) % stagingCount] = job;
+        }
+    }
+
+    // Heights with a one-sample border (for normals), then the tile's vertices
+    void generate(Tile& tile, float* out) const {
+        const int row = tileQuads + 1;
+        const int border = tileQuads + 3;
+        const int padded = (border + 3) & ~3;
+        const float spacing = tileSize / tileQuads;
+        float grid[border * padded];
+        float originX = tile.tx * tileSize - spacing, originZ = tile.tz * tileSize - spacing;
+        for (int z = 0; z < border; ++z) {
+            float wz = originZ + z * spacing;
+            float* line = grid + z * padded;
+#if TERRAIN_NOISE_SIMD
+            using namespace terrain_noise;
+            for (int x = 0; x < padded; x += 4) {
+                Float4 wx = _mm_add_ps(_mm_set1_ps(originX + x * spacing), _mm_set_ps(3 * spacing, 2 * spacing, spacing, 0.0f));
+                _mm_storeu_ps(line + x, terrain_noise::height<Float4, Int4>(wx, Float4(wz), seed).v);
+            }
+#else
+            for (int x = 0; x < border; ++x) line[x] = terrain_noise::height<float, uint32_t>(originX + x * spacing, wz, seed);
+#endif
+        }
+
+        float lo = 1e30f, hi = -1e30f;
+        for (int z = 0; z < row; ++z) {
+            for (int x = 0; x < row; ++x) {
+                const float* c = grid + (z + 1) * padded + (x + 1);
+                float h = *c;
+                tile.heights[z * row + x] = h;
+                lo = std::min(lo, h); hi = std::max(hi, h);
+                float slopeX = (c[1] - c[-1]) / (2.0f * spacing), slopeZ = (c[padded] - c[-padded]) / (2.0f * spacing);
+                glm::vec3 normal = glm::normalize(glm::vec3(-slopeX, 1.0f, -slopeZ));
+                glm::vec3 tangent = glm::normalize(glm::vec3(1.0f, slopeX, 0.0f));
+                glm::vec3 bitangent = glm::normalize(glm::vec3(0.0f, slopeZ, 1.0f));
+                float wx = tile.tx * tileSize + x * spacing, wz = tile.tz * tileSize + z * spacing;
+                // Same texture density as the heightmap terrain: one repeat per 20 units
+                float v[floatsPerVertex] = { wx, h, wz, normal.x, normal.y, normal.z, wx / 20.0f, wz / 20.0f,
+                    tangent.x, tangent.y, tangent.z, bitangent.x, bitangent.y, bitangent.z };
+                std::copy(v, v + floatsPerVertex, out + (z * row + x) * floatsPerVertex);
+            }
+        }
+        tile.lo = glm::vec3(tile.tx * tileSize, lo, tile.tz * tileSize);
+        tile.hi = glm::vec3((tile.tx + 1) * tileSize, hi, (tile.tz + 1) * tileSize);
+    }
+
+    uint32_t seed;
+    RenderDevice* device = nullptr;
+    std::vector<Tile> tiles;
+    Staging staging[stagingCount];
+    std::vector<unsigned int> indices;
+    PrimitiveTopology topology = PrimitiveTopology::Triangles;
+    std::vector<Offset> offsets;
+    int missing = 0;
+    float lastUpdateMs = 0.0f;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool quitting = false;
+    Job jobs[stagingCount] = {};     // Queued, guarded by mutex
+    int jobHead = 0, jobCount = 0;
+    Job finished[stagingCount] = {}; // Generated, waiting for upload, guarded by mutex
+    int doneHead = 0, doneCount = 0;
+    std::atomic<int64_t> generateMicros{ 0 }, generated{ 0 };
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "EventLog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// --- Quality tiers ---
+// Everything that trades image quality for frame time, picked as one tier. Draw
+// distance is also the far plane, so frustum culling and the fog that hides the
+// cull boundary always agree.
+
+enum class QualityTier : int { Low, Medium, High, Ultra, Count };
+
+struct QualitySettings {
+    const char* name;
+    float drawDistance;
+    float lodBias;      // Added to the mip level the shader samples; also meant for mesh LOD
+    int maxTextureSize; // Larger images are halved at load; applies on the next launch
+    int msaaSamples;
+};
+
+inline QualitySettings qualityPreset(QualityTier tier) {
+    switch (tier) {
+    case QualityTier::Low: return { "LOW", 150.0f, 1.0f, 256, 0 };
+    case QualityTier::Medium: return { "MEDIUM", 250.0f, 0.5f, 512, 2 };
+    case QualityTier::High: return { "HIGH", 400.0f, 0.0f, 1024, 4 };
+    default: return { "ULTRA", 1000.0f, 0.0f, 4096, 8 };
+    }
+}
+
+// Squared-exponential fog that is opaque to 8 bits (1/256 transmittance) exactly at
+// the draw distance: exp(-(d * density)^2) = 1/256  =>  density = sqrt(ln 256) / d
+inline float fogDensityFor(float drawDistance) { return 2.3548f / drawDistance; }
+
+// One line, "tier=N"; anything unreadable means "not configured yet"
+inline bool loadQualityTier(const char* path, QualityTier& tier) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    int value = -1;
+    bool ok = fscanf(f, "tier=%d", &value) == 1 && value >= 0 && value < (int)QualityTier::Count;
+    fclose(f);
+    if (ok) tier = (QualityTier)value;
+    return ok;
+}
+
+inline void saveQualityTier(const char* path, QualityTier tier) {
+    FILE* f = fopen(path, "w");
+    if (!f) { EventLog::instance().warning(std::string("Could not write ") + path); return; }
+    fprintf(f, "tier=%d\n", (int)tier);
+    fclose(f);
+}
+
+// --- First-launch benchmark ---
+// Renders the live scene at each tier from the top down and keeps the first one whose
+// 90th-percentile frame time meets the target. Frame times are only meaningful with
+// the frame limiter off and the GPU drained each frame, which the caller arranges.
+class QualityBenchmark {
+public:
+    static const int warmupFrames = 15;
+    static const int sampleFrames = 60;
+
+    void start(float targetFrameMs) {
+        targetMs = targetFrameMs;
+        tier = (int)QualityTier::Ultra;
+        samples.clear();
+        samples.reserve(sampleFrames);
+        frame = 0;
+        active = true;
+    }
+
+    bool running() const { return active; }
+    QualityTier currentTier() const { return (QualityTier)tier; }
+
+    void frameDone(float ms) {
+        if (!active) return;
+        if (frame++ < warmupFrames) return; // Tier switches reallocate targets and stall
+        samples.push_back(ms);
+        if ((int)samples.size() < sampleFrames) return;
+        std::sort(samples.begin(), samples.end());
+        float p90 = samples[samples.size() * 9 / 10];
+        char line[96];
+        snprintf(line, sizeof(line), "Quality benchmark: %s p90 %.2f ms (target %.2f)", qualityPreset((QualityTier)tier).name, p90, targetMs);
+        EventLog::instance().info(line);
+        if (p90 <= targetMs || tier == (int)QualityTier::Low) { active = false; return; }
+        tier--;
+        samples.clear();
+        frame = 0;
+    }
+
+private:
+    std::vector<float> samples;
+    float targetMs = 12.5f;
+    int tier = (int)QualityTier::Ultra;
+    int frame = 0;
+    bool active = false;
+};
@@ -0,0 +1,604 @@
+#pragma once
+
+#include "CookedTexture.h"
+#include "EventLog.h"
+#include "MemoryTracker.h"
+#include "MeshTopology.h"
+#include "RenderState.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+// --- Render device ---
+// Creates GPU resources and executes command lists. Scene code records DrawCommands
+// (from any thread) and the device submits them on the render thread, so nothing
+// outside a backend needs to know which API is underneath.
+//
+// GL is the only backend. There is no Vulkan backend yet: no command buffers recorded
+// in parallel, no VkPipelineCache, no lavapipe run and no GL-vs-Vulkan submission
+// numbers. It needs the Vulkan SDK (or volk) in the build first. F2's MT/ST times on
+// the overlay compare two ways of recording for GL, not two APIs.
+
+// Scene vertex layout: position, normal, uv, tangent, bitangent (14 floats)
+const int sceneAttribComponents[5] = { 3, 3, 2, 3, 3 };
+const int sceneAttribOffsets[5] = { 0, 3, 6, 8, 11 };
+// Baked ambient occlusion, one float per vertex in its own buffer; 1 for meshes without one
+const int sceneOcclusionAttrib = 5;
+
+struct MeshBuffers {
+    unsigned int vao = 0, vbo = 0, ebo = 0;
+    unsigned int occlusionVbo = 0;
+    int indexCount = 0;
+    int triangleCount = 0;
+    PrimitiveTopology topology = PrimitiveTopology::Triangles;
+};
+
+enum DrawFlags : uint8_t {
+    DrawNormalMap = 1 << 0,
+    DrawTerrain = 1 << 1,
+    DrawMasked = 1 << 2,
+};
+
+struct DrawCommand {
+    uint64_t sortKey;
+    int pipeline;
+    unsigned int vao;
+    int indexCount;
+    int triangleCount;
+    PrimitiveTopology topology;
+    unsigned int textures[3]; // Albedo, normal map, height map
+    unsigned int condition;   // Occlusion query the draw is conditional on, 0 for none
+    uint8_t views;            // Mask of the views the draw is submitted to (see ViewSet)
+    int firstInstance;        // Masked draws: id of the mesh's first instance in the visibility texture
+    int instanceVertices;     // Masked draws: vertices per instance, 0 otherwise
+    uint8_t flags;
+    glm::mat4 model;
+};
+
+// Commands for one scene partition. Lists keep their capacity, so recording stops
+// allocating after the first frames.
+class CommandList {
+public:
+    int visible = 0;
+    int culled = 0;
+
+    void clear() { commands.clear(); visible = culled = 0; condition = 0; views = allViews; }
+
+    // Draws recorded in between are skipped by the GPU if the query found nothing visible
+    void beginCondition(unsigned int query) { condition = query; }
+    void endCondition() { condition = 0; }
+
+    // Draws recorded in between only go to the views in mask; outside, to every view
+    void beginViews(uint8_t mask) { views = mask; }
+    void endViews() { views = allViews; }
+
+    void draw(int pipeline, const MeshBuffers& mesh, const glm::mat4& model, unsigned int albedo, unsigned int normalMap = 0, unsigned int heightMap = 0, uint8_t flags = 0) {
+        DrawCommand cmd;
+        // Pipeline, then textures, then mesh; the record index keeps the sort deterministic
+        cmd.sortKey = ((uint64_t)(pipeline & 0xF) << 60) | ((uint64_t)(albedo & 0xFFF) << 48) | ((uint64_t)(normalMap & 0xFFF) << 36)
+            | ((uint64_t)(mesh.vao & 0xFFFF) << 20) | (uint64_t)(commands.size() & 0xFFFFF);
+        cmd.pipeline = pipeline;
+        cmd.vao = mesh.vao;
+        cmd.indexCount = mesh.indexCount;
+        cmd.triangleCount = mesh.triangleCount;
+        cmd.topology = mesh.topology;
+        cmd.textures[0] = albedo; cmd.textures[1] = normalMap; cmd.textures[2] = heightMap;
+        cmd.condition = condition;
+        cmd.views = views;
+        cmd.firstInstance = cmd.instanceVertices = 0;
+        cmd.flags = flags | (normalMap ? DrawNormalMap : 0);
+        cmd.model = model;
+        commands.push_back(cmd);
+    }
+
+    // A mesh made of equally sized instances, each shown or hidden by the red channel of
+    // its texel in visibility (256 texels per row, starting at firstInstance)
+    void drawMasked(int pipeline, const MeshBuffers& mesh, const glm::mat4& model, unsigned int albedo, unsigned int visibility, int firstInstance, int instanceVertices) {
+        draw(pipeline, mesh, model, albedo, 0, visibility, DrawMasked);
+        commands.back().firstInstance = firstInstance;
+        commands.back().instanceVertices = instanceVertices;
+    }
+
+    // Groups draws by state; only valid for opaque geometry
+    void sort() {
+        std::sort(commands.begin(), commands.end(), [](const DrawCommand& a, const DrawCommand& b) { return a.sortKey < b.sortKey; });
+    }
+
+    void reserve(size_t n) { commands.reserve(n); }
+    const std::vector<DrawCommand>& items() const { return commands; }
+
+private:
+    static const uint8_t allViews = 0xFF;
+
+    std::vector<DrawCommand> commands;
+    unsigned int condition = 0;
+    uint8_t views = allViews;
+};
+
+class RenderDevice {
+public:
+    virtual ~RenderDevice() {}
+
+    virtual unsigned int createTexture(int width, int height, const uint8_t* rgba, bool repeat) = 0;
+    // Uploads the cooked mip chain as is, from the first level that fits the size limit
+    virtual unsigned int createTexture(const CookedTexture& cooked, bool repeat) = 0;
+    // Rewrites a rectangle of the base level; mip levels keep their old contents
+    virtual void updateTexture(unsigned int texture, int x, int y, int width, int height, const uint8_t* rgba) = 0;
+    // Vertices use the scene layout above; strips are separated by primitiveRestartIndex
+    virtual MeshBuffers createMesh(const float* vertices, size_t floatCount, const unsigned int* indices, size_t indexCount,
+        PrimitiveTopology topology = PrimitiveTopology::Triangles) = 0;
+    virtual void destroyMesh(MeshBuffers& mesh) = 0;
+    virtual void attachOcclusion(MeshBuffers& mesh, const float* occlusion, size_t vertexCount) = 0;
+    // Compiles (or loads from the pipeline cache) and resolves the shared uniforms once
+    virtual int createPipeline(const char* vertexSource, const char* fragmentSource) = 0;
+    virtual unsigned int pipelineProgram(int pipeline) const = 0;
+    // Draws the list's commands for one view; view and projection uniforms are the caller's
+    virtual void submit(const CommandList& list, int view = 0) = 0;
+};
+
+// --- OpenGL backend ---
+// Resource creation has two paths picked once in init(): Direct State Access with
+// immutable storage on GL 4.5 (or the matching ARB extensions), and classic
+// bind-to-edit otherwise. DSA never touches the bound state, so the state cache
+// stays valid while assets are created. Both paths need glad generated for GL 4.5
+// core with the extensions README.md lists; the flags below come from it.
+class GLRenderDevice : public RenderDevice {
+public:
+    // Call once the context is current
+    void init() {
+        dsaSupported = GLAD_GL_VERSION_4_5 || (GLAD_GL_ARB_direct_state_access && GLAD_GL_ARB_buffer_storage && GLAD_GL_ARB_texture_storage);
+        GLint formats = 0;
+        if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        binariesSupported = formats > 0;
+        GLint compressedCount = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &compressedCount);
+        std::vector<GLint> compressed(std::max(0, compressedCount));
+        if (compressedCount > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, compressed.data());
+        bc1Supported = std::find(compressed.begin(), compressed.end(), (GLint)GL_COMPRESSED_RGB_S3TC_DXT1_EXT) != compressed.end();
+        glVertexAttrib1f(sceneOcclusionAttrib, 1.0f); // Read by every VAO that has no occlusion buffer
+        // Core since 3.1; no list index is ever 0xFFFFFFFF, so it can stay on for every draw
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(primitiveRestartIndex);
+        EventLog::instance().info(std::string("Render device: ") + (dsaSupported ? "direct state access" : "bind-to-edit")
+            + (binariesSupported ? ", program binaries" : "") + (bc1Supported ? ", BC1" : ", no BC1 (cooked textures expanded at load)"));
+    }
+
+    bool usesDirectStateAccess() const { return dsaSupported; }
+
+    // Textures larger than this are box-filtered down at creation; 0 keeps full size
+    void setMaxTextureSize(int size) { maxTextureSize = size; }
+
+    unsigned int createTexture(int width, int height, const uint8_t* rgba, bool repeat) override {
+        std::vector<uint8_t> reduced;
+        while (maxTextureSize > 0 && std::max(width, height) > maxTextureSize && width > 1 && height > 1) {
+            int halfWidth = width / 2, halfHeight = height / 2;
+            std::vector<uint8_t> next((size_t)halfWidth * halfHeight * 4);
+            for (int y = 0; y < halfHeight; ++y)
+                for (int x = 0; x < halfWidth; ++x)
+                    for (int c = 0; c < 4; ++c) {
+                        const uint8_t* p = rgba + ((size_t)(2 * y) * width + 2 * x) * 4 + c;
+                        size_t row = (size_t)width * 4;
+                        next[((size_t)y * halfWidth + x) * 4 + c] = (uint8_t)((p[0] + p[4] + p[row] + p[row + 4] + 2) / 4);
+                    }
+            reduced.swap(next);
+            rgba = reduced.data();
+            width = halfWidth; height = halfHeight;
+        }
+        unsigned int texture;
+        // RGBA8 base level plus roughly a third more for the mip chain
+        int64_t bytes = (int64_t)width * height * 4 * 4 / 3;
+        GLint wrap = repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+        if (dsaSupported) {
+            int levels = 1 + (int)std::floor(std::log2((float)std::max(width, height)));
+            glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+            glTextureStorage2D(texture, levels, GL_RGBA8, width, height);
+            glTextureSubImage2D(texture, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+            glGenerateTextureMipmap(texture);
+            MemoryTracker::instance().setGpuObject(MemTag::TextureGPU, texture, bytes);
+            glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_S, wrap);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_T, wrap);
+            return texture;
+        }
+        glGenTextures(1, &texture);
+        glState().bindTexture(0, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        MemoryTracker::instance().setGpuObject(MemTag::TextureGPU, texture, bytes);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        return texture;
+    }
+
+    unsigned int createTexture(const CookedTexture& cooked, bool repeat) override {
+        int first = 0, levels = (int)cooked.levels.size();
+        while (maxTextureSize > 0 && first + 1 < levels && std::max(cooked.levelWidth(first), cooked.levelHeight(first)) > maxTextureSize) first++;
+        bool bc1 = cooked.format == CookedFormat::BC1;
+        bool expand = bc1 && !bc1Supported;
+        GLenum internalFormat = cooked.format == CookedFormat::R8 ? GL_R8 : expand ? GL_RGBA8 : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        GLenum format = cooked.format == CookedFormat::R8 ? GL_RED : GL_RGBA;
+        GLint wrap = repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+        int64_t bytes = 0;
+        unsigned int texture;
+        if (dsaSupported) {
+            glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+            glTextureStorage2D(texture, levels - first, internalFormat, cooked.levelWidth(first), cooked.levelHeight(first));
+        }
+        else {
+            glGenTextures(1, &texture);
+            glState().bindTexture(0, texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - first - 1);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Single-channel rows are not padded
+        for (int l = first; l < levels; ++l) {
+            int level = l - first, w = cooked.levelWidth(l), h = cooked.levelHeight(l);
+            const std::vector<uint8_t>& data = cooked.levels[l];
+            std::vector<uint8_t> expanded;
+            if (expand) expanded = texture_cook::decodeBC1(data.data(), w, h);
+            bytes += expand ? (int64_t)expanded.size() : (int64_t)data.size();
+            if (bc1 && !expand) {
+                if (dsaSupported) glCompressedTextureSubImage2D(texture, level, 0, 0, w, h, internalFormat, (GLsizei)data.size(), data.data());
+                else glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, w, h, 0, (GLsizei)data.size(), data.data());
+                continue;
+            }
+            const uint8_t* texels = expand ? expanded.data() : data.data();
+            if (dsaSupported) glTextureSubImage2D(texture, level, 0, 0, w, h, format, GL_UNSIGNED_BYTE, texels);
+            else glTexImage2D(GL_TEXTURE_2D, level, internalFormat, w, h, 0, format, GL_UNSIGNED_BYTE, texels);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        MemoryTracker::instance().setGpuObject(MemTag::TextureGPU, texture, bytes);
+        if (dsaSupported) {
+            glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_S, wrap);
+            glTextureParameteri(texture, GL_TEXTURE_WRAP_T, wrap);
+            return texture;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        return texture;
+    }
+
+    void updateTexture(unsigned int texture, int x, int y, int width, int height, const uint8_t* rgba) override {
+        if (dsaSupported) {
+            glTextureSubImage2D(texture, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+            return;
+        }
+        glState().bindTexture(0, texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    }
+
+    MeshBuffers createMesh(const float* vertices, size_t floatCount, const unsigned int* indices, size_t indexCount,
+        PrimitiveTopology topology = PrimitiveTopology::Triangles) override {
+        MeshBuffers mesh;
+        mesh.indexCount = (int)indexCount;
+        mesh.triangleCount = mesh_topology::triangleCount(indices, indexCount, topology);
+        mesh.topology = topology;
+        if (dsaSupported) {
+            // Immutable storage: the data never changes after load
+            glCreateBuffers(1, &mesh.vbo);
+            glNamedBufferStorage(mesh.vbo, floatCount * sizeof(float), vertices, 0);
+            glCreateBuffers(1, &mesh.ebo);
+            glNamedBufferStorage(mesh.ebo, indexCount * sizeof(unsigned int), indices, 0);
+            MemoryTracker::instance().setGpuObject(MemTag::MeshGPU, mesh.vbo, (int64_t)(floatCount * sizeof(float)));
+            MemoryTracker::instance().setGpuObject(MemTag::MeshGPU, mesh.ebo, (int64_t)(indexCount * sizeof(unsigned int)));
+
+            glCreateVertexArrays(1, &mesh.vao);
+            glVertexArrayVertexBuffer(mesh.vao, 0, mesh.vbo, 0, 14 * sizeof(float));
+            glVertexArrayElementBuffer(mesh.vao, mesh.ebo);
+            for (int i = 0; i < 5; ++i) {
+                glEnableVertexArrayAttrib(mesh.vao, i);
+                glVertexArrayAttribFormat(mesh.vao, i, sceneAttribComponents[i], GL_FLOAT, GL_FALSE, sceneAttribOffsets[i] * sizeof(float));
+                glVertexArrayAttribBinding(mesh.vao, i, 0);
+            }
+            return mesh;
+        }
+        glGenVertexArrays(1, &mesh.vao);
+        glGenBuffers(1, &mesh.vbo);
+        glGenBuffers(1, &mesh.ebo);
+
+        glState().bindVertexArray(mesh.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glBufferData(GL_ARRAY_BUFFER, floatCount * sizeof(float), vertices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+        MemoryTracker::instance().setGpuObject(MemTag::MeshGPU, mesh.vbo, (int64_t)(floatCount * sizeof(float)));
+        MemoryTracker::instance().setGpuObject(MemTag::MeshGPU, mesh.ebo, (int64_t)(indexCount * sizeof(unsigned int)));
+
+        for (int i = 0; i < 5; ++i) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribPointer(i, sceneAttribComponents[i], GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(sceneAttribOffsets[i] * sizeof(float)));
+        }
+        return mesh;
+    }
+
+    void attachOcclusion(MeshBuffers& mesh, const float* occlusion, size_t vertexCount) override {
+        int64_t bytes = (int64_t)(vertexCount * sizeof(float));
+        if (dsaSupported) {
+            glCreateBuffers(1, &mesh.occlusionVbo);
+            glNamedBufferStorage(mesh.occlusionVbo, bytes, occlusion, 0);
+            glVertexArrayVertexBuffer(mesh.vao, 1, mesh.occlusionVbo, 0, sizeof(float));
+            glEnableVertexArrayAttrib(mesh.vao, sceneOcclusionAttrib);
+            glVertexArrayAttribFormat(mesh.vao, sceneOcclusionAttrib, 1, GL_FLOAT, GL_FALSE, 0);
+            glVertexArrayAttribBinding(mesh.vao, sceneOcclusionAttrib, 1);
+        }
+        else {
+            glGenBuffers(1, &mesh.occlusionVbo);
+            glState().bindVertexArray(mesh.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, mesh.occlusionVbo);
+            glBufferData(GL_ARRAY_BUFFER, bytes, occlusion, GL_STATIC_DRAW);
+            glEnableVertexAttribArray(sceneOcclusionAttrib);
+            glVertexAttribPointer(sceneOcclusionAttrib, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+        }
+        MemoryTracker::instance().setGpuObject(MemTag::MeshGPU, mesh.occlusionVbo, bytes);
+    }
+
+    void destroyMesh(MeshBuffers& mesh) override {
+        MemoryTracker::instance().releaseGpuObject(MemTag::MeshGPU, mesh.vbo);
+        MemoryTracker::instance().releaseGpuObject(MemTag::MeshGPU, mesh.ebo);
+        if (mesh.occlusionVbo) MemoryTracker::instance().releaseGpuObject(MemTag::MeshGPU, mesh.occlusionVbo);
+        glDeleteBuffers(1, &mesh.vbo);
+        glDeleteBuffers(1, &mesh.ebo);
+        if (mesh.occlusionVbo) glDeleteBuffers(1, &mesh.occlusionVbo);
+        glDeleteVertexArrays(1, &mesh.vao);
+        glState().invalidate(); // The name may come back from the next glGen while still cached as bound
+        mesh = MeshBuffers();
+    }
+
+    int createPipeline(const char* vertexSource, const char* fragmentSource) override {
+        Pipeline p;
+        uint64_t key = cacheKey(vertexSource, fragmentSource);
+        p.program = loadCachedProgram(key);
+        if (!p.program) p.program = compileProgram(vertexSource, fragmentSource, key);
+
+        p.model = glGetUniformLocation(p.program, "model");
+        p.useNormalMap = glGetUniformLocation(p.program, "useNormalMap");
+        p.isTerrain = glGetUniformLocation(p.program, "isTerrain");
+        p.instanceMask = glGetUniformLocation(p.program, "instanceMask");
+        // Sampler units are fixed per slot, so they are set once here instead of per draw
+        glState().useProgram(p.program);
+        const char* samplers[3] = { "texture1", "normalMap", "heightMap" };
+        for (int i = 0; i < 3; ++i) {
+            int location = glGetUniformLocation(p.program, samplers[i]);
+            if (location >= 0) glUniform1i(location, i);
+        }
+        pipelines.push_back(p);
+        return (int)pipelines.size() - 1;
+    }
+
+    unsigned int pipelineProgram(int pipeline) const override { return pipelines[pipeline].program; }
+
+    void submit(const CommandList& list, int view = 0) override {
+        RenderStats& stats = renderStats();
+        // Culling is shared, so it is counted once; occlusion queries are issued against
+        // the main view's depth and mean nothing for the others
+        const bool mainView = view == 0;
+        const uint8_t viewBit = (uint8_t)(1 << view);
+        if (mainView) {
+            stats.visible += list.visible;
+            stats.culled += list.culled;
+        }
+        unsigned int condition = 0;
+        for (const DrawCommand& cmd : list.items()) {
+            if (!(cmd.views & viewBit)) continue;
+            unsigned int wanted = mainView ? cmd.condition : 0;
+            if (wanted != condition) {
+                // Never waits for the result: an unfinished query just draws
+                if (condition) glEndConditionalRender();
+                if (wanted) glBeginConditionalRender(wanted, GL_QUERY_NO_WAIT);
+                condition = wanted;
+            }
+            if (condition) stats.conditionalDraws++;
+            Pipeline& p = pipelines[cmd.pipeline];
+            glState().useProgram(p.program);
+            if (p.model >= 0) glUniformMatrix4fv(p.model, 1, GL_FALSE, glm::value_ptr(cmd.model));
+            // Uniforms are program state, so flags only need setting when they change
+            if (cmd.flags != p.flags) {
+                if (p.useNormalMap >= 0) glUniform1i(p.useNormalMap, (cmd.flags & DrawNormalMap) ? 1 : 0);
+                if (p.isTerrain >= 0) glUniform1i(p.isTerrain, (cmd.flags & DrawTerrain) ? 1 : 0);
+                p.flags = cmd.flags;
+            }
+            if (p.instanceMask >= 0 && (cmd.firstInstance != p.firstInstance || cmd.instanceVertices != p.instanceVertices)) {
+                glUniform2i(p.instanceMask, cmd.firstInstance, cmd.instanceVertices);
+                p.firstInstance = cmd.firstInstance;
+                p.instanceVertices = cmd.instanceVertices;
+            }
+            for (int i = 0; i < 3; ++i)
+                if (cmd.textures[i]) glState().bindTexture(i, cmd.textures[i]);
+            glState().bindVertexArray(cmd.vao);
+            glDrawElements(cmd.topology == PrimitiveTopology::TriangleStrip ? GL_TRIANGLE_STRIP : GL_TRIANGLES, cmd.indexCount, GL_UNSIGNED_INT, 0);
+            stats.drawCalls++; stats.triangles += cmd.triangleCount;
+        }
+        if (condition) glEndConditionalRender();
+    }
+
+    // --- Pipeline cache ---
+    // Linked program binaries keyed by a hash of the sources and the driver, so a
+    // driver update just misses. Needs GL 4.1 or ARB_get_program_binary; otherwise
+    // every pipeline is compiled from source as before.
+    void loadPipelineCache(const char* path) {
+        cachePath = path;
+        if (!binariesSupported) return;
+
+        FILE* f = fopen(path, "rb");
+        if (!f) return;
+        char magic[4];
+        if (fread(magic, 4, 1, f) == 1 && memcmp(magic, cacheMagic, 4) == 0) {
+            CachedBinary entry;
+            uint64_t key;
+            uint32_t size;
+            while (fread(&key, sizeof(key), 1, f) == 1 && fread(&entry.format, sizeof(entry.format), 1, f) == 1 && fread(&size, sizeof(size), 1, f) == 1) {
+                entry.data.resize(size);
+                if (size > 0 && fread(entry.data.data(), size, 1, f) != 1) break;
+                cache[key] = entry;
+            }
+        }
+        fclose(f);
+    }
+
+    void savePipelineCache() {
+        if (!cacheDirty || cachePath.empty()) return;
+        FILE* f = fopen(cachePath.c_str(), "wb");
+        if (!f) { EventLog::instance().warning("Could not write pipeline cache " + cachePath); return; }
+        fwrite(cacheMagic, 4, 1, f);
+        for (const auto& it : cache) {
+            uint32_t size = (uint32_t)it.second.data.size();
+            fwrite(&it.first, sizeof(it.first), 1, f);
+            fwrite(&it.second.format, sizeof(it.second.format), 1, f);
+            fwrite(&size, sizeof(size), 1, f);
+            fwrite(it.second.data.data(), size, 1, f);
+        }
+        fclose(f);
+        cacheDirty = false;
+    }
+
+    int cacheHits() const { return hits; }
+    int cacheMisses() const { return misses; }
+
+private:
+    struct Pipeline {
+        unsigned int program = 0;
+        int model = -1, useNormalMap = -1, isTerrain = -1, instanceMask = -1;
+        uint8_t flags = 0xFF; // Last flags uploaded; 0xFF forces the first upload
+        int firstInstance = -1, instanceVertices = -1; // Last instanceMask uploaded
+    };
+
+    struct CachedBinary {
+        uint32_t format = 0;
+        std::vector<uint8_t> data;
+    };
+
+    uint64_t cacheKey(const char* vertexSource, const char* fragmentSource) const {
+        uint64_t hash = 14695981039346656037ull; // FNV-1a
+        auto mix = [&hash](const char* s) {
+            for (; s && *s; ++s) { hash ^= (uint8_t)*s; hash *= 1099511628211ull; }
+            hash ^= 0xFF; hash *= 1099511628211ull;
+        };
+        mix(vertexSource);
+        mix(fragmentSource);
+        mix(reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+        mix(reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+        return hash;
+    }
+
+    unsigned int loadCachedProgram(uint64_t key) {
+        if (!binariesSupported) return 0;
+        auto it = cache.find(key);
+        if (it == cache.end()) { misses++; return 0; }
+        unsigned int program = glCreateProgram();
+        glProgramBinary(program, it->second.format, it->second.data.data(), (GLsizei)it->second.data.size());
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            // Stale binary (driver changed without the version string changing): rebuild it
+            glDeleteProgram(program);
+            cache.erase(it);
+            misses++;
+            return 0;
+        }
+        hits++;
+        return program;
+    }
+
+    unsigned int compileProgram(const char* vertexSource, const char* fragmentSource, uint64_t key) {
+        unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vertexSource, NULL);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, "VERTEX");
+
+        unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fragmentSource, NULL);
+        glCompileShader(fragment);
+        checkCompileErrors(fragment, "FRAGMENT");
+
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        if (binariesSupported) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(program);
+        bool linked = checkCompileErrors(program, "PROGRAM");
+
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+
+        if (binariesSupported && linked) {
+            GLint length = 0;
+            glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+            CachedBinary entry;
+            entry.data.resize(length);
+            GLenum format = 0;
+            glGetProgramBinary(program, length, NULL, &format, entry.data.data());
+            entry.format = format;
+            cache[key] = entry;
+            cacheDirty = true;
+        }
+        return program;
+    }
+
+    bool checkCompileErrors(unsigned int shader, std::string type) {
+        int success;
+        char infoLog[1024];
+        if (type != "PROGRAM") {
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+                logInfoLog("ERROR::SHADER_COMPILATION_ERROR of type: " + type, infoLog);
+            }
+        }
+        else {
+            glGetProgramiv(shader, GL_LINK_STATUS, &success);
+            if (!success) {
+                glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+                logInfoLog("ERROR::PROGRAM_LINKING_ERROR of type: " + type, infoLog);
+            }
+        }
+        return success != 0;
+    }
+
+    // Driver logs are multi-line; one record per line keeps each within the fixed record size
+    void logInfoLog(const std::string& header, const char* infoLog) {
+        EventLog::instance().error(header);
+        std::istringstream lines(infoLog);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (!line.empty()) EventLog::instance().error(line);
+        }
+    }
+
+    static constexpr const char* cacheMagic = "PLC1";
+
+    std::vector<Pipeline> pipelines;
+    std::unordered_map<uint64_t, CachedBinary> cache;
+    std::string cachePath;
+    bool dsaSupported = false;
+    int maxTextureSize = 0;
+    bool binariesSupported = false;
+    bool bc1Supported = false;
+    bool cacheDirty = false;
+    int hits = 0, misses = 0;
+};
+
+inline GLRenderDevice& renderDevice() {
+    static GLRenderDevice device;
+    return device;
+}
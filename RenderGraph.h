@@ -0,0 +1,420 @@
+#pragma once
+
+#include "EventLog.h"
+#include "MemoryTracker.h"
+#include "RenderState.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// --- Render graph ---
+// The frame is declared as passes that read and write named render targets. compile()
+// drops passes whose output never reaches the backbuffer (unless they have side effects,
+// like query passes), orders the rest so every reader runs after the writers of what it
+// reads, and gives each transient target a lifetime from first to last use. Targets with
+// the same format and size whose lifetimes do not overlap share one GL texture, which is
+// as close to memory aliasing as GL gets. Declaration and compilation allocate; they run
+// when the frame's shape changes (resize, quality tier), not every frame. execute() only
+// binds each pass's framebuffer and calls back into the caller with the pass id.
+// GL objects are left to the context on shutdown; it may already be gone by then.
+
+enum class RGFormat : uint8_t { RGBA8, Depth24Stencil8 };
+
+class RenderGraph {
+public:
+    static const int maxPasses = 16;
+    static const int maxResources = 16;
+    static const int maxAttachments = 4;
+
+    // Starts a new declaration; physical targets are kept for reuse by the next compile
+    void clear() {
+        passCount = 0;
+        resourceCount = 0;
+        orderCount = 0;
+    }
+
+    // The declaration calls return -1 once the fixed tables are full; the read and write
+    // calls ignore -1, so an overfull graph compiles without the extra passes and targets
+    int createTexture(const char* name, RGFormat format, int width, int height, int samples) {
+        if (resourceCount == maxResources) { overflow("target", name); return -1; }
+        Resource& r = resources[resourceCount];
+        r = Resource();
+        r.name = name;
+        r.format = format;
+        r.width = width;
+        r.height = height;
+        r.samples = samples;
+        return resourceCount++;
+    }
+
+    // The window's framebuffer; passes writing it are the graph's roots
+    int importBackbuffer(const char* name, int width, int height) {
+        int id = createTexture(name, RGFormat::RGBA8, width, height, 0);
+        if (id >= 0) resources[id].imported = true;
+        return id;
+    }
+
+    // id is what execute() hands back; sideEffects keeps a pass whose output is unused
+    int addPass(const char* name, int id, bool sideEffects = false) {
+        if (passCount == maxPasses) { overflow("pass", name); return -1; }
+        Pass& p = passes[passCount];
+        p = Pass();
+        p.name = name;
+        p.id = id;
+        p.sideEffects = sideEffects;
+        return passCount++;
+    }
+
+    // Sampled or blitted from; the pass must run after every writer of the resource
+    void read(int pass, int resource) {
+        if (pass < 0 || resource < 0) return;
+        Pass& p = passes[pass];
+        if (p.readCount == maxAttachments) { overflow("another read in pass", p.name); return; }
+        p.reads[p.readCount++] = resource;
+    }
+    // Bound as an attachment, including depth that is only tested against
+    void write(int pass, int resource) {
+        if (pass < 0 || resource < 0) return;
+        Pass& p = passes[pass];
+        if (p.writeCount == maxAttachments) { overflow("another write in pass", p.name); return; }
+        p.writes[p.writeCount++] = resource;
+    }
+
+    void compile() {
+        if (maxSamples == 0) {
+            GLint color = 0, depth = 0;
+            glGetIntegerv(GL_MAX_COLOR_TEXTURE_SAMPLES, &color);
+            glGetIntegerv(GL_MAX_DEPTH_TEXTURE_SAMPLES, &depth);
+            maxSamples = std::max(1, std::min(color, depth));
+        }
+        for (int i = 0; i < resourceCount; ++i) resources[i].samples = std::min(resources[i].samples, maxSamples);
+
+        // --- Dependencies: readers after all writers, writers of one resource in declaration order ---
+        bool dependsOn[maxPasses][maxPasses] = {};
+        for (int r = 0; r < resourceCount; ++r) {
+            int lastWriter = -1;
+            for (int p = 0; p < passCount; ++p) {
+                if (!writes(p, r)) continue;
+                if (lastWriter >= 0) dependsOn[p][lastWriter] = true;
+                lastWriter = p;
+            }
+            for (int p = 0; p < passCount; ++p) {
+                if (!reads(p, r)) continue;
+                for (int w = 0; w < passCount; ++w) if (w != p && writes(w, r)) dependsOn[p][w] = true;
+            }
+        }
+
+        // --- Culling: keep what the roots need ---
+        bool live[maxPasses] = {};
+        int stack[maxPasses], top = 0;
+        for (int p = 0; p < passCount; ++p) {
+            bool root = passes[p].sideEffects;
+            for (int i = 0; i < passes[p].writeCount; ++i) root |= resources[passes[p].writes[i]].imported;
+            if (root) { live[p] = true; stack[top++] = p; }
+        }
+        while (top > 0) {
+            int p = stack[--top];
+            for (int d = 0; d < passCount; ++d)
+                if (dependsOn[p][d] && !live[d]) { live[d] = true; stack[top++] = d; }
+        }
+
+        // --- Ordering: topological, ties broken by declaration order ---
+        bool placed[maxPasses] = {};
+        orderCount = 0;
+        int liveCount = 0;
+        for (int p = 0; p < passCount; ++p) liveCount += live[p];
+        while (orderCount < liveCount) {
+            int next = -1;
+            for (int p = 0; p < passCount && next < 0; ++p) {
+                if (!live[p] || placed[p]) continue;
+                bool ready = true;
+                for (int d = 0; d < passCount && ready; ++d) if (dependsOn[p][d] && live[d] && !placed[d]) ready = false;
+                if (ready) next = p;
+            }
+            if (next < 0) {
+                EventLog::instance().error("Render graph has a cycle; remaining passes run in declaration order");
+                for (int p = 0; p < passCount; ++p) if (live[p] && !placed[p]) { placed[p] = true; order[orderCount++] = p; }
+                break;
+            }
+            placed[next] = true;
+            order[orderCount++] = next;
+        }
+
+        // --- Lifetimes over the compiled order ---
+        for (int r = 0; r < resourceCount; ++r) { resources[r].firstUse = -1; resources[r].lastUse = -1; resources[r].physical = -1; }
+        for (int i = 0; i < orderCount; ++i) {
+            const Pass& p = passes[order[i]];
+            for (int k = 0; k < p.readCount; ++k) touch(p.reads[k], i);
+            for (int k = 0; k < p.writeCount; ++k) touch(p.writes[k], i);
+        }
+
+        // --- Aliasing: greedy by first use onto matching physical targets that are free by then ---
+        std::vector<Physical> previous;
+        previous.swap(physicals);
+        std::vector<int> byFirstUse;
+        for (int r = 0; r < resourceCount; ++r) if (!resources[r].imported && resources[r].firstUse >= 0) byFirstUse.push_back(r);
+        std::sort(byFirstUse.begin(), byFirstUse.end(), [this](int a, int b) { return resources[a].firstUse < resources[b].firstUse; });
+        for (int r : byFirstUse) {
+            Resource& res = resources[r];
+            int slot = -1;
+            for (int s = 0; s < (int)physicals.size() && slot < 0; ++s)
+                if (matches(physicals[s], res) && physicals[s].freeAfter < res.firstUse) slot = s;
+            if (slot < 0) {
+                Physical phys;
+                phys.format = res.format; phys.width = res.width; phys.height = res.height; phys.samples = res.samples;
+                // Reuse a texture from the previous compile when one still fits
+                for (size_t k = 0; k < previous.size(); ++k)
+                    if (previous[k].texture && matches(previous[k], res)) { phys.texture = previous[k].texture; previous[k].texture = 0; break; }
+                if (!phys.texture) allocate(phys);
+                physicals.push_back(phys);
+                slot = (int)physicals.size() - 1;
+            }
+            physicals[slot].freeAfter = res.lastUse;
+            res.physical = slot;
+        }
+        for (Physical& phys : previous) destroy(phys);
+
+        // --- Framebuffers: one per live pass, plus a read framebuffer per sampled target ---
+        for (unsigned int fbo : framebuffers) glDeleteFramebuffers(1, &fbo);
+        framebuffers.clear();
+        for (int i = 0; i < orderCount; ++i) {
+            Pass& p = passes[order[i]];
+            p.fbo = 0;
+            p.width = p.height = 0;
+            bool toBackbuffer = false;
+            for (int k = 0; k < p.writeCount; ++k) {
+                const Resource& res = resources[p.writes[k]];
+                toBackbuffer |= res.imported;
+                p.width = res.width; p.height = res.height;
+            }
+            if (!toBackbuffer && p.writeCount > 0) p.fbo = createFramebuffer(p.writes, p.writeCount);
+        }
+        for (int r = 0; r < resourceCount; ++r) {
+            resources[r].readFbo = 0;
+            bool sampled = false;
+            for (int i = 0; i < orderCount; ++i) sampled |= reads(order[i], r);
+            if (sampled && !resources[r].imported) resources[r].readFbo = createFramebuffer(&r, 1);
+        }
+
+        buildDump();
+    }
+
+    // Binds each live pass's target in order and calls run(pass id) for it
+    template <typename Run>
+    void execute(Run& run) {
+        for (int i = 0; i < orderCount; ++i) {
+            const Pass& p = passes[order[i]];
+            glBindFramebuffer(GL_FRAMEBUFFER, p.fbo);
+            if (p.width > 0) glViewport(0, 0, p.width, p.height);
+            run(p.id);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Framebuffer with only this resource attached, for blits out of it
+    unsigned int readFramebuffer(int resource) const { return resource >= 0 ? resources[resource].readFbo : 0; }
+    unsigned int texture(int resource) const { return resource >= 0 && resources[resource].physical >= 0 ? physicals[resources[resource].physical].texture : 0; }
+    int samples(int resource) const { return resource >= 0 ? resources[resource].samples : 0; }
+
+    int livePasses() const { return orderCount; }
+    int culledPasses() const { return passCount - orderCount; }
+    int64_t transientBytes() const {
+        int64_t sum = 0;
+        for (const Physical& phys : physicals) sum += bytes(phys.format, phys.width, phys.height, phys.samples);
+        return sum;
+    }
+    // What the live transients would take without sharing
+    int64_t unaliasedBytes() const {
+        int64_t sum = 0;
+        for (int r = 0; r < resourceCount; ++r)
+            if (!resources[r].imported && resources[r].physical >= 0) sum += bytes(resources[r].format, resources[r].width, resources[r].height, resources[r].samples);
+        return sum;
+    }
+
+    // Pass order, culled passes, lifetimes and the physical target each one landed on
+    const std::string& dump() const { return dumpText; }
+
+    // Deletes the textures and framebuffers, for a graph that goes away before the context
+    void release() {
+        for (Physical& phys : physicals) destroy(phys);
+        physicals.clear();
+        for (unsigned int fbo : framebuffers) glDeleteFramebuffers(1, &fbo);
+        framebuffers.clear();
+    }
+
+    // Compiles a small graph whose first and last transients match and never overlap, and
+    // checks they landed on one texture while the one in between did not. The frame graph
+    // has no such pair yet, so this is what exercises the aliasing path. Needs a context.
+    static bool aliasingSelfTest(std::string& report) {
+        RenderGraph graph;
+        int a = graph.createTexture("a", RGFormat::RGBA8, 64, 64, 0);
+        int b = graph.createTexture("b", RGFormat::RGBA8, 64, 64, 0);
+        int c = graph.createTexture("c", RGFormat::RGBA8, 64, 64, 0);
+        int backbuffer = graph.importBackbuffer("backbuffer", 64, 64);
+        int first = graph.addPass("write_a", 0);
+        graph.write(first, a);
+        int second = graph.addPass("a_to_b", 1);
+        graph.read(second, a); graph.write(second, b);
+        int third = graph.addPass("b_to_c", 2);
+        graph.read(third, b); graph.write(third, c);
+        int last = graph.addPass("c_to_backbuffer", 3);
+        graph.read(last, c); graph.write(last, backbuffer);
+        graph.compile();
+        bool ok = graph.texture(a) != 0 && graph.texture(a) == graph.texture(c) && graph.texture(b) != graph.texture(a)
+            && graph.transientBytes() * 3 == graph.unaliasedBytes() * 2;
+        report = graph.dump();
+        graph.release();
+        return ok;
+    }
+
+private:
+    struct Resource {
+        const char* name = "";
+        RGFormat format = RGFormat::RGBA8;
+        int width = 0, height = 0, samples = 0;
+        bool imported = false;
+        int firstUse = -1, lastUse = -1; // Indices into the compiled order
+        int physical = -1;
+        unsigned int readFbo = 0;
+    };
+
+    struct Pass {
+        const char* name = "";
+        int id = 0;
+        bool sideEffects = false;
+        int reads[maxAttachments] = {}, writes[maxAttachments] = {};
+        int readCount = 0, writeCount = 0;
+        unsigned int fbo = 0;
+        int width = 0, height = 0;
+    };
+
+    struct Physical {
+        RGFormat format = RGFormat::RGBA8;
+        int width = 0, height = 0, samples = 0;
+        unsigned int texture = 0;
+        int freeAfter = -1;
+    };
+
+    static int64_t bytes(RGFormat format, int width, int height, int samples) {
+        (void)format; // Both formats are 4 bytes per sample
+        return (int64_t)width * height * 4 * std::max(1, samples);
+    }
+
+    static bool matches(const Physical& phys, const Resource& res) {
+        return phys.format == res.format && phys.width == res.width && phys.height == res.height && phys.samples == res.samples;
+    }
+
+    bool reads(int pass, int resource) const {
+        for (int k = 0; k < passes[pass].readCount; ++k) if (passes[pass].reads[k] == resource) return true;
+        return false;
+    }
+    bool writes(int pass, int resource) const {
+        for (int k = 0; k < passes[pass].writeCount; ++k) if (passes[pass].writes[k] == resource) return true;
+        return false;
+    }
+
+    void touch(int resource, int index) {
+        Resource& r = resources[resource];
+        if (r.firstUse < 0) r.firstUse = index;
+        r.lastUse = index;
+    }
+
+    void allocate(Physical& phys) {
+        GLenum internalFormat = phys.format == RGFormat::RGBA8 ? GL_RGBA8 : GL_DEPTH24_STENCIL8;
+        glGenTextures(1, &phys.texture);
+        if (phys.samples > 0) {
+            glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, phys.texture);
+            glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, phys.samples, internalFormat, phys.width, phys.height, GL_TRUE);
+            glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+        }
+        else {
+            GLenum format = phys.format == RGFormat::RGBA8 ? GL_RGBA : GL_DEPTH_STENCIL;
+            GLenum type = phys.format == RGFormat::RGBA8 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_INT_24_8;
+            glState().bindTexture(0, phys.texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, phys.width, phys.height, 0, format, type, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        MemoryTracker::instance().setGpuObject(MemTag::RenderTarget, phys.texture, bytes(phys.format, phys.width, phys.height, phys.samples));
+    }
+
+    void destroy(Physical& phys) {
+        if (!phys.texture) return;
+        MemoryTracker::instance().releaseGpuObject(MemTag::RenderTarget, phys.texture);
+        glDeleteTextures(1, &phys.texture);
+        phys.texture = 0;
+    }
+
+    unsigned int createFramebuffer(const int* attachments, int count) {
+        unsigned int fbo;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        int colorCount = 0;
+        GLenum drawBuffers[maxAttachments];
+        for (int k = 0; k < count; ++k) {
+            const Resource& res = resources[attachments[k]];
+            GLenum target = res.samples > 0 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+            GLenum point = res.format == RGFormat::RGBA8 ? GL_COLOR_ATTACHMENT0 + colorCount : GL_DEPTH_STENCIL_ATTACHMENT;
+            if (res.format == RGFormat::RGBA8) drawBuffers[colorCount++] = point;
+            glFramebufferTexture2D(GL_FRAMEBUFFER, point, target, physicals[res.physical].texture, 0);
+        }
+        // Depth-only passes have no color buffer to draw to or read from
+        if (colorCount > 0) glDrawBuffers(colorCount, drawBuffers);
+        else { glDrawBuffer(GL_NONE); glReadBuffer(GL_NONE); }
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) EventLog::instance().error("Render graph framebuffer is incomplete");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        framebuffers.push_back(fbo);
+        return fbo;
+    }
+
+    static void overflow(const char* what, const char* name) {
+        char line[160];
+        snprintf(line, sizeof(line), "Render graph: no room for %s %s, left out", what, name);
+        EventLog::instance().error(line);
+    }
+
+    void buildDump() {
+        char line[160];
+        dumpText.clear();
+        snprintf(line, sizeof(line), "render graph: %d passes, %d culled, %d targets on %d textures, %.2f MB (%.2f MB unaliased)\n",
+            orderCount, culledPasses(), resourceCount, (int)physicals.size(), transientBytes() / 1048576.0, unaliasedBytes() / 1048576.0);
+        dumpText += line;
+        for (int i = 0; i < orderCount; ++i) {
+            const Pass& p = passes[order[i]];
+            snprintf(line, sizeof(line), "  %d %s%s\n", i, p.name, p.sideEffects ? " (side effects)" : "");
+            dumpText += line;
+        }
+        for (int p = 0; p < passCount; ++p) {
+            bool live = false;
+            for (int i = 0; i < orderCount; ++i) live |= order[i] == p;
+            if (live) continue;
+            snprintf(line, sizeof(line), "  culled %s\n", passes[p].name);
+            dumpText += line;
+        }
+        for (int r = 0; r < resourceCount; ++r) {
+            const Resource& res = resources[r];
+            if (res.imported) snprintf(line, sizeof(line), "  %s imported %dx%d\n", res.name, res.width, res.height);
+            else if (res.physical < 0) snprintf(line, sizeof(line), "  %s unused\n", res.name);
+            else snprintf(line, sizeof(line), "  %s %s %dx%d x%d passes %d-%d texture %d\n", res.name, res.format == RGFormat::RGBA8 ? "rgba8" : "d24s8",
+                res.width, res.height, std::max(1, res.samples), res.firstUse, res.lastUse, res.physical);
+            dumpText += line;
+        }
+    }
+
+    Pass passes[maxPasses];
+    Resource resources[maxResources];
+    int passCount = 0, resourceCount = 0;
+    int order[maxPasses] = {};
+    int orderCount = 0;
+    std::vector<Physical> physicals;
+    std::vector<unsigned int> framebuffers;
+    GLint maxSamples = 0;
+    std::string dumpText;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// --- Render statistics, reset every frame ---
+struct RenderStats {
+    int drawCalls = 0;
+    int triangles = 0;
+    int stateChanges = 0; // Program, VAO and texture binds that actually reached GL
+    int visible = 0;
+    int culled = 0;
+    int conditionalDraws = 0; // Submitted under an occlusion query; the GPU may skip them
+    float recordMs = 0.0f; // Culling and command recording for all scene partitions
+    float submitMs = 0.0f; // Turning the command lists into API calls
+};
+
+inline RenderStats& renderStats() {
+    static RenderStats stats;
+    return stats;
+}
+
+// --- GL state cache ---
+// Skips redundant binds. Anything that binds behind its back must go through it
+// (or call invalidate()) or the cache will be wrong.
+class GLStateCache {
+public:
+    static const int maxTextureUnits = 8;
+
+    void useProgram(unsigned int program) {
+        if (program == currentProgram) return;
+        glUseProgram(program);
+        currentProgram = program;
+        renderStats().stateChanges++;
+    }
+
+    void bindVertexArray(unsigned int vao) {
+        if (vao == currentVAO) return;
+        glBindVertexArray(vao);
+        currentVAO = vao;
+        renderStats().stateChanges++;
+    }
+
+    void bindTexture(int unit, unsigned int texture) {
+        if (boundTextures[unit] == texture) return;
+        if (activeUnit != unit) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            activeUnit = unit;
+        }
+        glBindTexture(GL_TEXTURE_2D, texture);
+        boundTextures[unit] = texture;
+        renderStats().stateChanges++;
+    }
+
+    void invalidate() {
+        currentProgram = currentVAO = invalidName;
+        activeUnit = -1;
+        for (int i = 0; i < maxTextureUnits; ++i) boundTextures[i] = invalidName;
+    }
+
+    GLStateCache() { invalidate(); }
+
+private:
+    static const unsigned int invalidName = 0xFFFFFFFFu;
+    unsigned int currentProgram, currentVAO;
+    int activeUnit;
+    unsigned int boundTextures[maxTextureUnits];
+};
+
+inline GLStateCache& glState() {
+    static GLStateCache cache;
+    return cache;
+}
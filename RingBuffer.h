@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// --- Bounded lock-free MPSC ring buffer ---
+// Any number of threads may push(), exactly one thread may pop().
+// Every cell carries a sequence number, so producers claim a slot with a single CAS
+// and never wait for each other; a full ring makes push() fail instead of blocking.
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+public:
+    MpscRing() {
+        for (size_t i = 0; i < Capacity; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(const T& item) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & (Capacity - 1)];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false; // Full: the consumer has not released this cell yet
+            }
+            else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T& item) {
+        Cell& cell = cells[tail & (Capacity - 1)];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(tail + 1) < 0) return false;
+        item = cell.data;
+        cell.sequence.store(tail + Capacity, std::memory_order_release);
+        ++tail;
+        return true;
+    }
+
+private:
+    Cell cells[Capacity];
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) size_t tail = 0;
+};
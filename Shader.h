@@ -0,0 +1,29 @@
+#pragma once
+
+#include "RenderDevice.h"
+#include "RenderState.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <string>
+
+// --- Shader class ---
+// A pipeline built by the render device, plus by-name uniform setters for per-frame values
+class Shader {
+public:
+    unsigned int ID;
+    int pipeline;
+    Shader(const char* vertexSource, const char* fragmentSource) {
+        pipeline = renderDevice().createPipeline(vertexSource, fragmentSource);
+        ID = renderDevice().pipelineProgram(pipeline);
+    }
+
+    void use() { glState().useProgram(ID); }
+    void setMat4(const std::string& name, const glm::mat4& mat) { glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat)); }
+    void setVec3(const std::string& name, const glm::vec3& vec) { glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(vec)); }
+    void setVec2(const std::string& name, const glm::vec2& vec) { glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &vec.x); }
+    void setFloat(const std::string& name, float value) { glUniform1f(glGetUniformLocation(ID, name.c_str()), value); }
+    void setInt(const std::string& name, int value) { glUniform1i(glGetUniformLocation(ID, name.c_str()), value); }
+};
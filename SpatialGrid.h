@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// --- Uniform grid over the XZ plane ---
+// Rebuilt from scratch with a counting sort (two passes, no per-cell allocations), then
+// queried by circle. Positions outside the bounds are clamped into the border cells.
+class SpatialGrid {
+public:
+    SpatialGrid(float worldMin, float worldMax, float cellSize)
+        : origin(worldMin), cellSize(cellSize), cellsPerSide((int)std::ceil((worldMax - worldMin) / cellSize)) {
+        cellStart.assign(cellsPerSide * cellsPerSide + 1, 0);
+    }
+
+    template <typename PositionOf>
+    void build(int count, PositionOf positionOf) {
+        cellOf.resize(count);
+        items.resize(count);
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+        for (int i = 0; i < count; ++i) {
+            glm::vec3 p = positionOf(i);
+            cellOf[i] = cellIndex(cellCoord(p.x), cellCoord(p.z));
+            cellStart[cellOf[i] + 1]++;
+        }
+        for (size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+        cursor.assign(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < count; ++i) items[cursor[cellOf[i]]++] = i;
+    }
+
+    // Visits every index whose cell overlaps the circle; callers do the exact distance test
+    template <typename Visit>
+    void query(const glm::vec3& center, float radius, Visit visit) const {
+        int x0 = cellCoord(center.x - radius), x1 = cellCoord(center.x + radius);
+        int z0 = cellCoord(center.z - radius), z1 = cellCoord(center.z + radius);
+        for (int z = z0; z <= z1; ++z)
+            for (int x = x0; x <= x1; ++x) {
+                int c = cellIndex(x, z);
+                for (int i = cellStart[c]; i < cellStart[c + 1]; ++i) visit(items[i]);
+            }
+    }
+
+private:
+    int cellCoord(float v) const {
+        int c = (int)std::floor((v - origin) / cellSize);
+        return c < 0 ? 0 : (c >= cellsPerSide ? cellsPerSide - 1 : c);
+    }
+    int cellIndex(int x, int z) const { return z * cellsPerSide + x; }
+
+    float origin, cellSize;
+    int cellsPerSide;
+    std::vector<int> cellStart, cursor, cellOf, items;
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "EventLog.h"
+#include "GameState.h"
+#include "MemoryTracker.h"
+#include "RenderState.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// --- Stress scene ---
+// --stress [file] fills the world with configurable numbers of houses, trees, ornaments,
+// parcels in flight and airships, flies the camera along a fixed path and reports how
+// the frame scaled. Everything is placed from the seed and the simulation advances by a
+// fixed step, so two runs with the same settings draw the same frames whatever the frame
+// rate; only the timings differ. File: one key=value per line, e.g. "houses=2000".
+struct StressSettings {
+    int houses = 2000;      // Upper bound; the village's spacing and terrain decide the rest
+    int trees = 32;
+    int ornaments = 12;     // Balls per tree, besides the star
+    int parcels = 200;      // Kept in flight: landed ones are dropped again
+    int airships = 256;     // Besides the player's
+    uint32_t seed = 7;
+    float seconds = 30.0f;  // Of flight, at the fixed step
+};
+
+inline bool loadStressSettings(const char* path, StressSettings& settings) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char key[32];
+    float value;
+    while (fscanf(f, " %31[^=]=%f", key, &value) == 2) {
+        std::string name(key);
+        if (name == "houses") settings.houses = (int)value;
+        else if (name == "trees") settings.trees = (int)value;
+        else if (name == "ornaments") settings.ornaments = (int)value;
+        else if (name == "parcels") settings.parcels = (int)value;
+        else if (name == "airships") settings.airships = (int)value;
+        else if (name == "seed") settings.seed = (uint32_t)value;
+        else if (name == "seconds") settings.seconds = value;
+        else EventLog::instance().warning("Unknown stress setting " + name);
+    }
+    fclose(f);
+    return true;
+}
+
+class StressScene {
+public:
+    static constexpr float step = 1.0f / 60.0f;
+    static const int maxTrees = 256;
+    static const int maxOrnaments = 64;
+    static const int warmupFrames = 30; // Shader and texture first use; left out of the report
+
+    explicit StressScene(const StressSettings& requested) : settings(requested) {
+        settings.houses = std::max(0, std::min(settings.houses, (int)GameState::maxTargets));
+        settings.trees = std::max(1, std::min(settings.trees, (int)maxTrees));
+        settings.ornaments = std::max(0, std::min(settings.ornaments, (int)maxOrnaments));
+        settings.parcels = std::max(0, std::min(settings.parcels, (int)GameState::maxParcels));
+        settings.airships = std::max(0, std::min(settings.airships, GameState::maxAirships - 1));
+        settings.seconds = std::max(1.0f, settings.seconds);
+        frameTimes.reserve(frames());
+        drawCalls.reserve(frames());
+        char line[200];
+        snprintf(line, sizeof(line), "Stress scene: %d houses, %d trees, %d ornaments each, %d parcels, %d airships, seed %u, %.0f s",
+            settings.houses, settings.trees, settings.ornaments, settings.parcels, settings.airships, settings.seed, settings.seconds);
+        EventLog::instance().info(line);
+    }
+
+    const StressSettings& config() const { return settings; }
+    int frames() const { return (int)(settings.seconds / step); }
+
+    // Village spacing that packs roughly the requested houses into the area
+    float houseSpacing(float halfExtent) const {
+        float area = 4.0f * halfExtent * halfExtent;
+        return std::max(8.0f, std::min(12.0f, std::sqrt(area / (std::max(1, settings.houses) * 1.6f))));
+    }
+
+    // The scene's own tree first, then the others on free ground away from the houses
+    template <typename HeightAt>
+    std::vector<glm::vec3> placeTrees(const glm::vec3& first, float halfExtent, const GameState& state, HeightAt heightAt) {
+        std::vector<glm::vec3> trees(1, first);
+        uint32_t rng = settings.seed ^ 0x7EE5u;
+        for (int attempt = 0; attempt < settings.trees * 30 && (int)trees.size() < settings.trees; ++attempt) {
+            glm::vec3 p((random(rng) * 2.0f - 1.0f) * halfExtent, 0.0f, (random(rng) * 2.0f - 1.0f) * halfExtent);
+            bool free = true;
+            for (int i = 0; i < state.targetCount && free; ++i)
+                free = glm::length(glm::vec2(p.x - state.targets[i].position.x, p.z - state.targets[i].position.z)) > 9.0f;
+            for (size_t i = 0; i < trees.size() && free; ++i)
+                free = glm::length(glm::vec2(p.x - trees[i].x, p.z - trees[i].z)) > 12.0f;
+            if (!free) continue;
+            p.y = heightAt(p.x, p.z);
+            trees.push_back(p);
+        }
+        treeCount = (int)trees.size();
+        return trees;
+    }
+
+    // Ornament positions relative to the tree base, on the three cones it is drawn with
+    // (bases at 5, 8 and 10.5 with radii 6, 5 and 4, each as tall as it is wide)
+    std::vector<glm::vec3> ornamentOffsets() const {
+        const float base[3] = { 5.0f, 8.0f, 10.5f }, radius[3] = { 6.0f, 5.0f, 4.0f };
+        std::vector<glm::vec3> offsets;
+        uint32_t rng = settings.seed ^ 0x0BA11u;
+        for (int i = 0; i < settings.ornaments; ++i) {
+            int cone = (int)(random(rng) * 3.0f) % 3;
+            float t = 0.1f + random(rng) * 0.6f, angle = random(rng) * 6.2831853f;
+            float r = radius[cone] * (1.0f - t) + 0.3f; // Just outside the surface
+            offsets.push_back(glm::vec3(std::cos(angle) * r, base[cone] + t * radius[cone], std::sin(angle) * r));
+        }
+        return offsets;
+    }
+
+    // Activates the extra airships; their paths follow from the seed alone
+    void populate(GameState& state, float halfExtent) {
+        uint32_t rng = settings.seed ^ 0xA125u;
+        circuits.assign(settings.airships, Circuit());
+        for (int i = 0; i < settings.airships; ++i) {
+            Circuit& c = circuits[i];
+            c.center = glm::vec3((random(rng) * 2.0f - 1.0f) * halfExtent * 0.8f, 25.0f + random(rng) * 30.0f, (random(rng) * 2.0f - 1.0f) * halfExtent * 0.8f);
+            c.radius = 5.0f + random(rng) * 30.0f;
+            c.speed = (random(rng) < 0.5f ? -1.0f : 1.0f) * (0.1f + random(rng) * 0.4f);
+            c.phase = random(rng) * 6.2831853f;
+            state.airships[i + 1].active = true;
+        }
+        extent = halfExtent;
+        parcelRng = settings.seed ^ 0x9A2Cu;
+    }
+
+    // Moves every airship, the player's along the camera flight, and drops parcels until
+    // the requested number is in the air
+    template <typename HeightAt>
+    void update(GameState& state, int frame, HeightAt heightAt) {
+        float t = frame * step;
+        for (size_t i = 0; i < circuits.size(); ++i) {
+            const Circuit& c = circuits[i];
+            float a = c.phase + c.speed * t;
+            state.airships[i + 1].position = c.center + glm::vec3(std::cos(a) * c.radius, 0.0f, std::sin(a) * c.radius);
+        }
+        // A figure of eight over most of the area, one loop per run
+        float u = 6.2831853f * t / settings.seconds;
+        glm::vec3& player = state.airships[0].position;
+        player.x = std::sin(u) * extent * 0.7f;
+        player.z = std::sin(2.0f * u) * extent * 0.5f;
+        player.y = heightAt(player.x, player.z) + 30.0f;
+        while (state.activeParcels() < settings.parcels) {
+            glm::vec3 p((random(parcelRng) * 2.0f - 1.0f) * extent, 0.0f, (random(parcelRng) * 2.0f - 1.0f) * extent);
+            p.y = heightAt(p.x, p.z) + 20.0f + random(parcelRng) * 40.0f;
+            if (!state.spawnParcel(p)) break;
+        }
+    }
+
+    // Call after each presented frame with its wall time
+    void frameDone(int frame, float frameMs, const RenderStats& stats) {
+        if (frame < warmupFrames) return;
+        frameTimes.push_back(frameMs);
+        drawCalls.push_back(stats.drawCalls);
+        triangleSum += stats.triangles;
+        stateChangeSum += stats.stateChanges;
+        recordMsSum += stats.recordMs;
+        submitMsSum += stats.submitMs;
+        peakBytes = std::max(peakBytes, MemoryTracker::instance().totalCurrentBytes());
+    }
+
+    // Frame time percentiles, draws and memory, to the event log and stdout
+    void report(int houses) const {
+        if (frameTimes.empty()) return;
+        std::vector<float> times(frameTimes);
+        std::sort(times.begin(), times.end());
+        std::vector<int> draws(drawCalls);
+        std::sort(draws.begin(), draws.end());
+        auto percentile = [](const std::vector<float>& sorted, float p) { return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))]; };
+        double total = 0.0;
+        for (float ms : times) total += ms;
+        size_t n = times.size();
+        char line[240];
+        std::string text[4];
+        snprintf(line, sizeof(line), "Stress: %d frames, %d houses, %d trees x %d ornaments, %d parcels, %d airships",
+            (int)n, houses, treeCount, settings.ornaments, settings.parcels, settings.airships);
+        text[0] = line;
+        snprintf(line, sizeof(line), "Stress: frame ms avg %.2f  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f",
+            total / n, percentile(times, 0.5f), percentile(times, 0.9f), percentile(times, 0.99f), times.back());
+        text[1] = line;
+        snprintf(line, sizeof(line), "Stress: draws p50 %d  max %d, %.0f triangles and %.0f state changes per frame, record %.2f ms, submit %.2f ms",
+            draws[n / 2], draws.back(), (double)triangleSum / n, (double)stateChangeSum / n, recordMsSum / n, submitMsSum / n);
+        text[2] = line;
+        snprintf(line, sizeof(line), "Stress: tracked memory %.1f MB at the end, %.1f MB peak",
+            MemoryTracker::instance().totalCurrentBytes() / 1048576.0, peakBytes / 1048576.0);
+        text[3] = line;
+        for (const std::string& t : text) {
+            EventLog::instance().info(t);
+            std::cout << t << std::endl;
+        }
+    }
+
+private:
+    struct Circuit {
+        glm::vec3 center;
+        float radius = 0.0f, speed = 0.0f, phase = 0.0f;
+    };
+
+    // xorshift32, uniform in [0, 1)
+    static float random(uint32_t& state) {
+        if (state == 0) state = 0x9E3779B9u;
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+
+    StressSettings settings;
+    std::vector<Circuit> circuits;
+    float extent = 96.0f;
+    int treeCount = 1;
+    uint32_t parcelRng = 1;
+    std::vector<float> frameTimes;
+    std::vector<int> drawCalls;
+    int64_t triangleSum = 0, stateChangeSum = 0, peakBytes = 0;
+    float recordMsSum = 0.0f, submitMsSum = 0.0f;
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "AmbientOcclusion.h"
+#include "CommandRecorder.h"
+#include "EventLog.h"
+#include "GameState.h"
+#include "ProceduralTerrain.h"
+#include "RenderDevice.h"
+
+#include <SFML/System.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// --- Procedural village ---
+// Houses are scattered by Poisson-disk sampling over square blocks, skipping ground that
+// is too steep, and each block becomes one merged mesh: one draw, one frustum test and
+// one occlusion object however many houses it holds. Blocks are sampled independently
+// (each with its own seeded generator, inset by half the spacing so neighbours never
+// crowd each other), which lets them run on the worker threads and still come out the
+// same on every peer. Houses are the gameplay targets, numbered block by block.
+//
+// A destroyed house is not cut out of the merged mesh: every house has a texel in a
+// visibility texture, and the vertex shader looks its house up from gl_VertexID (all
+// houses have the same vertex count) and collapses the vertices of one that is down.
+struct VillageSettings {
+    float halfExtent = 96.0f;   // Houses go in [-halfExtent, halfExtent] on both axes
+    float blockSize = 64.0f;    // Grown when needed to stay within maxBlocks
+    float spacing = 12.0f;      // Minimum distance between house centres
+    float maxSlope = 0.35f;     // Rise over run across a house's footprint
+    bool townMask = false;      // Clusters houses into towns with open country between them
+    uint32_t seed = 1;
+    glm::vec2 clearCenter = glm::vec2(0.0f);
+    float clearRadius = 0.0f;   // Kept free of houses, e.g. around the tree
+    int maxHouses = GameState::maxTargets;
+};
+
+struct VillageBlock {
+    int firstHouse = 0, houseCount = 0;
+    int standing = 0;           // Houses not destroyed; blocks without any are not drawn
+    glm::vec3 lo, hi;           // Bounds of every house in the block
+    MeshBuffers mesh;
+};
+
+class Village {
+public:
+    static const int maxBlocks = 256;
+    static const int visibilityWidth = 256;
+    static const int visibilityRows = GameState::maxTargets / visibilityWidth;
+
+    // Fills state.targets, which must be empty; heightAt(x, z) is called from several threads
+    template <typename HeightAt>
+    void generate(GameState& state, const VillageSettings& settings, HeightAt heightAt, CommandRecorder& workers) {
+        sf::Clock timer;
+        float extent = 2.0f * settings.halfExtent;
+        blocksPerSide = std::max(1, (int)std::ceil(extent / settings.blockSize));
+        if (blocksPerSide * blocksPerSide > maxBlocks) blocksPerSide = (int)std::sqrt((float)maxBlocks);
+        float blockSize = extent / blocksPerSide;
+
+        std::vector<std::vector<glm::vec3>> placed(blocksPerSide * blocksPerSide);
+        auto placeBlock = [&](int b) {
+            int bx = b % blocksPerSide, bz = b / blocksPerSide;
+            float inset = settings.spacing * 0.5f;
+            glm::vec2 origin(-settings.halfExtent + bx * blockSize + inset, -settings.halfExtent + bz * blockSize + inset);
+            sampleBlock(placed[b], origin, blockSize - 2.0f * inset, settings, heightAt,
+                terrain_noise::hash<uint32_t>((uint32_t)bx, (uint32_t)bz, settings.seed ^ 0x51ED27u));
+        };
+        workers.run(placeBlock, (int)placed.size());
+
+        // Numbered in block order, so the ids match however the jobs were scheduled
+        blocks.assign(placed.size(), VillageBlock());
+        for (size_t b = 0; b < placed.size(); ++b) {
+            VillageBlock& block = blocks[b];
+            block.firstHouse = state.targetCount;
+            block.lo = glm::vec3(1e30f); block.hi = glm::vec3(-1e30f);
+            for (const glm::vec3& p : placed[b]) {
+                if (state.targetCount >= settings.maxHouses || !state.addTarget(p)) break;
+                block.lo = glm::min(block.lo, p - glm::vec3(3.5f, 2.0f, 3.5f));
+                block.hi = glm::max(block.hi, p + glm::vec3(3.5f, 5.0f, 3.5f));
+            }
+            block.houseCount = block.standing = state.targetCount - block.firstHouse;
+        }
+        houses = state.targetCount;
+        placementMs = timer.getElapsedTime().asSeconds() * 1000.0f;
+
+        char line[160];
+        snprintf(line, sizeof(line), "Village: %d houses in %d blocks, placed in %.1f ms on %d threads",
+            houses, (int)blocks.size(), placementMs, workers.workerCount() + 1);
+        EventLog::instance().info(line);
+    }
+
+    // Merges each block into one mesh of houseVertices/houseIndices copies (scene vertex
+    // layout, one house centred on its target position) and creates the visibility texture.
+    // The merged vertices are kept on the CPU until bakeOcclusion().
+    void buildGeometry(RenderDevice& device, const std::vector<float>& houseVertices, const std::vector<unsigned int>& houseIndices,
+        const GameState& state, CommandRecorder& workers) {
+        sf::Clock timer;
+        houseVertexCount = (int)(houseVertices.size() / floatsPerVertex);
+        std::vector<std::vector<float>>& vertices = blockVertices;
+        std::vector<std::vector<unsigned int>>& indices = blockIndices;
+        vertices.assign(blocks.size(), std::vector<float>());
+        indices.assign(blocks.size(), std::vector<unsigned int>());
+        auto mergeBlock = [&](int b) {
+            const VillageBlock& block = blocks[b];
+            vertices[b].reserve((size_t)block.houseCount * houseVertices.size());
+            indices[b].reserve((size_t)block.houseCount * houseIndices.size());
+            for (int h = block.firstHouse; h < block.firstHouse + block.houseCount; ++h) {
+                // Yaw from the id alone, so it needs no room in the game state
+                float yaw = (terrain_noise::hash<uint32_t>((uint32_t)h, 0u, 0x9A7Eu) & 3) * 1.5707963f;
+                glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1.0f), state.targets[h].position), yaw, glm::vec3(0, 1, 0));
+                appendTransformed(vertices[b], indices[b], houseVertices.data(), houseVertices.size(), houseIndices.data(), houseIndices.size(), model);
+            }
+        };
+        workers.run(mergeBlock, (int)blocks.size());
+        for (size_t b = 0; b < blocks.size(); ++b)
+            if (blocks[b].houseCount > 0)
+                blocks[b].mesh = device.createMesh(vertices[b].data(), vertices[b].size(), indices[b].data(), indices[b].size());
+
+        texels.assign((size_t)visibilityWidth * visibilityRows * 4, 0);
+        for (int i = 0; i < houses; ++i) texels[(size_t)i * 4] = state.targets[i].active ? 255 : 0;
+        visibility = device.createTexture(visibilityWidth, visibilityRows, texels.data(), false);
+        geometryMs = timer.getElapsedTime().asSeconds() * 1000.0f;
+
+        char line[128];
+        snprintf(line, sizeof(line), "Village: %d block meshes of %d vertices per house, merged in %.1f ms", (int)blocks.size(), houseVertexCount, geometryMs);
+        EventLog::instance().info(line);
+    }
+
+    // Every house as an occluder; call before baker.build()
+    void addOccluders(OcclusionBaker& baker) const {
+        for (size_t b = 0; b < blockVertices.size(); ++b)
+            baker.addOccluder(blockVertices[b].data(), blockVertices[b].size(), blockIndices[b].data(), blockIndices[b].size(), glm::mat4(1.0f));
+    }
+
+    // Attaches baked occlusion to every block mesh and frees the CPU copies
+    void bakeOcclusion(OcclusionBaker& baker, RenderDevice& device, CommandRecorder& workers) {
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            if (blocks[b].houseCount == 0) continue;
+            std::vector<float> occlusion = baker.bakeMesh(blockVertices[b].data(), blockVertices[b].size(), glm::mat4(1.0f), workers);
+            device.attachOcclusion(blocks[b].mesh, occlusion.data(), occlusion.size());
+        }
+        std::vector<std::vector<float>>().swap(blockVertices);
+        std::vector<std::vector<unsigned int>>().swap(blockIndices);
+    }
+
+    // Uploads the rows of houses that fell or came back (rewind, quickload, the network)
+    void syncVisibility(const GameState& state, RenderDevice& device) {
+        if (!visibility) return;
+        int firstRow = visibilityRows, lastRow = -1;
+        for (VillageBlock& block : blocks) {
+            for (int i = block.firstHouse; i < block.firstHouse + block.houseCount; ++i) {
+                uint8_t value = state.targets[i].active ? 255 : 0;
+                uint8_t& texel = texels[(size_t)i * 4];
+                if (texel == value) continue;
+                block.standing += value ? 1 : -1;
+                texel = value;
+                firstRow = std::min(firstRow, i / visibilityWidth);
+                lastRow = std::max(lastRow, i / visibilityWidth);
+            }
+        }
+        if (lastRow >= firstRow)
+            device.updateTexture(visibility, 0, firstRow, visibilityWidth, lastRow - firstRow + 1, texels.data() + (size_t)firstRow * visibilityWidth * 4);
+    }
+
+    int blockCount() const { return (int)blocks.size(); }
+    const VillageBlock& block(int i) const { return blocks[i]; }
+    int houseCount() const { return houses; }
+    int verticesPerHouse() const { return houseVertexCount; }
+    unsigned int visibilityTexture() const { return visibility; }
+    float placementTimeMs() const { return placementMs; }
+    float geometryTimeMs() const { return geometryMs; }
+
+    // Appends a copy of a scene-layout mesh transformed by a rigid model matrix
+    static void appendTransformed(std::vector<float>& vertices, std::vector<unsigned int>& indices, const float* srcVertices, size_t floatCount,
+        const unsigned int* srcIndices, size_t indexCount, const glm::mat4& model) {
+        unsigned int base = (unsigned int)(vertices.size() / floatsPerVertex);
+        glm::mat3 rotation(model);
+        for (size_t v = 0; v + floatsPerVertex <= floatCount; v += floatsPerVertex) {
+            const float* src = srcVertices + v;
+            glm::vec3 p = glm::vec3(model * glm::vec4(src[0], src[1], src[2], 1.0f));
+            glm::vec3 n = rotation * glm::vec3(src[3], src[4], src[5]);
+            glm::vec3 t = rotation * glm::vec3(src[8], src[9], src[10]);
+            glm::vec3 bt = rotation * glm::vec3(src[11], src[12], src[13]);
+            float out[floatsPerVertex] = { p.x, p.y, p.z, n.x, n.y, n.z, src[6], src[7], t.x, t.y, t.z, bt.x, bt.y, bt.z };
+            vertices.insert(vertices.end(), out, out + floatsPerVertex);
+        }
+        for (size_t i = 0; i < indexCount; ++i) indices.push_back(base + srcIndices[i]);
+    }
+
+private:
+    static const int floatsPerVertex = 14;
+    static const int candidatesPerPoint = 30; // Bridson's k
+
+    // Small LCG rather than <random>, whose distributions differ between standard libraries
+    struct Rng {
+        uint32_t state;
+        float next() { state = state * 1664525u + 1013904223u; return (state >> 8) * (1.0f / 16777216.0f); }
+    };
+
+    // Bridson's algorithm inside one square, restarted from fresh random points so that
+    // patches cut off from each other by steep ground still get filled
+    template <typename HeightAt>
+    static void sampleBlock(std::vector<glm::vec3>& out, glm::vec2 origin, float size, const VillageSettings& settings, HeightAt& heightAt, uint32_t seed) {
+        if (size <= 0.0f) return;
+        Rng rng{ seed };
+        const float cell = settings.spacing / 1.41421356f; // At most one point per cell
+        const int cells = std::max(1, (int)std::ceil(size / cell));
+        std::vector<int> occupant((size_t)cells * cells, -1);
+        std::vector<glm::vec2> points;
+        std::vector<int> active;
+
+        auto cellOf = [&](float v) { return std::min(cells - 1, (int)(v / cell)); };
+        auto isFree = [&](glm::vec2 p) {
+            int cx = cellOf(p.x - origin.x), cz = cellOf(p.y - origin.y);
+            for (int z = std::max(0, cz - 2); z <= std::min(cells - 1, cz + 2); ++z)
+                for (int x = std::max(0, cx - 2); x <= std::min(cells - 1, cx + 2); ++x) {
+                    int o = occupant[(size_t)z * cells + x];
+                    if (o >= 0 && glm::distance(points[o], p) < settings.spacing) return false;
+                }
+            return true;
+        };
+        auto tryAdd = [&](glm::vec2 p) {
+            if (p.x < origin.x || p.y < origin.y || p.x >= origin.x + size || p.y >= origin.y + size) return false;
+            if (!isFree(p)) return false;
+            float ground;
+            if (!suitable(p, settings, heightAt, ground)) return false;
+            occupant[(size_t)cellOf(p.y - origin.y) * cells + cellOf(p.x - origin.x)] = (int)points.size();
+            active.push_back((int)points.size());
+            points.push_back(p);
+            out.push_back(glm::vec3(p.x, ground + 2.0f, p.y)); // Body is a 4-unit cube centred on the position
+            return true;
+        };
+
+        for (int restart = 0; restart < 16; ++restart) {
+            tryAdd(origin + glm::vec2(rng.next(), rng.next()) * size);
+            while (!active.empty()) {
+                int slot = (int)(rng.next() * active.size());
+                glm::vec2 center = points[active[slot]];
+                bool added = false;
+                for (int k = 0; k < candidatesPerPoint && !added; ++k) {
+                    float angle = rng.next() * 6.2831853f, radius = settings.spacing * (1.0f + rng.next());
+                    added = tryAdd(center + glm::vec2(std::cos(angle), std::sin(angle)) * radius);
+                }
+                if (!added) { active[slot] = active.back(); active.pop_back(); }
+            }
+        }
+    }
+
+    // Flat enough, outside the clearing and, with the town mask, inside a town. The house
+    // sits on the lowest corner sample, so on a slope it sinks in rather than floats.
+    template <typename HeightAt>
+    static bool suitable(glm::vec2 p, const VillageSettings& settings, HeightAt& heightAt, float& ground) {
+        if (settings.clearRadius > 0.0f && glm::distance(p, settings.clearCenter) < settings.clearRadius) return false;
+        if (settings.townMask && terrain_noise::fbm<float, uint32_t>(p.x * 0.004f, p.y * 0.004f, settings.seed + 53u, 2) < 0.0f) return false;
+        const float reach = 2.0f; // Half the body's width
+        float center = heightAt(p.x, p.y);
+        float east = heightAt(p.x + reach, p.y), west = heightAt(p.x - reach, p.y);
+        float north = heightAt(p.x, p.y + reach), south = heightAt(p.x, p.y - reach);
+        float slope = std::max(std::fabs(east - west), std::fabs(north - south)) / (2.0f * reach);
+        if (slope > settings.maxSlope) return false;
+        ground = std::min(std::min(center, std::min(east, west)), std::min(north, south));
+        return true;
+    }
+
+    std::vector<VillageBlock> blocks;
+    std::vector<uint8_t> texels;   // CPU copy of the visibility texture, red = standing
+    std::vector<std::vector<float>> blockVertices; // Merged meshes, kept until baked
+    std::vector<std::vector<unsigned int>> blockIndices;
+    unsigned int visibility = 0;
+    int blocksPerSide = 0;
+    int houses = 0;
+    int houseVertexCount = 0;
+    float placementMs = 0.0f, geometryMs = 0.0f;
+};
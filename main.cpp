@@ -5,140 +5,144 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "EventLog.h"
+#include "MemoryTracker.h"
+#include "MetricsServer.h"
+#include "RenderState.h"
+#include "RenderDevice.h"
+#include "MeshTopology.h"
+#include "CommandRecorder.h"
+#include "Shader.h"
+#include "Frustum.h"
+#include "Occlusion.h"
+#include "Overlay.h"
+#include "GameState.h"
+#include "Network.h"
+#include "AudioSystem.h"
+#include "FramePacing.h"
+#include "Quality.h"
+#include "RenderGraph.h"
+#include "ProceduralTerrain.h"
+#include "Village.h"
+#include "AabbTree.h"
+#include "AmbientOcclusion.h"
+#include "GLCapture.h"
+#include "StressScene.h"
+#include "LodController.h"
+#include "ControlServer.h"
+#include "AssetCooker.h"
+
 #include <vector>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <cmath>
 #include <random>
+#include <memory>
+#include <cstdlib>
 
 using namespace glm;
 
-// --- Shader class ---
-class Shader {
-public:
-    unsigned int ID;
-    Shader(const char* vertexSource, const char* fragmentSource) {
-        unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vertexSource, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-
-        unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fragmentSource, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-    }
-
-    void use() { glUseProgram(ID); }
-    void setMat4(const std::string& name, const mat4& mat) { glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, value_ptr(mat)); }
-    void setVec3(const std::string& name, const vec3& vec) { glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, value_ptr(vec)); }
-    void setFloat(const std::string& name, float value) { glUniform1f(glGetUniformLocation(ID, name.c_str()), value); }
-    void setInt(const std::string& name, int value) { glUniform1i(glGetUniformLocation(ID, name.c_str()), value); }
-
-private:
-    void checkCompileErrors(unsigned int shader, std::string type) {
-        int success;
-        char infoLog[1024];
-        if (type != "PROGRAM") {
-            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-            if (!success) {
-                glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-                std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n";
-            }
-        }
-        else {
-            glGetProgramiv(shader, GL_LINK_STATUS, &success);
-            if (!success) {
-                glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-                std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n";
-            }
-        }
+#ifdef _DEBUG
+// --- Debug heap hooks: count allocations made inside the frame loop ---
+void* operator new(size_t size) {
+    if (FrameAllocationGuard::active()) FrameAllocationGuard::count()++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+#endif
+
+void logMemoryUsage(EventLog& events) {
+    MemoryTracker& mem = MemoryTracker::instance();
+    for (int i = 0; i < (int)MemTag::Count; ++i)
+        events.memory(memTagName((MemTag)i), mem.currentBytes((MemTag)i), mem.peakBytes((MemTag)i));
+}
+
+// One record per line, since a record's text is cut short; for multi-line reports
+void logLines(EventLog& events, LogLevel level, const std::string& text) {
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos) end = text.size();
+        events.message(level, text.substr(begin, end - begin));
+        begin = end + 1;
     }
-};
+}
 
-// --- Texture loader ---
-unsigned int loadTexture(const char* path, bool repeat = true) {
-    sf::Image image;
-    if (!image.loadFromFile(path)) {
-        std::cout << "Failed to load texture: " << path << std::endl;
+// --- Texture loader: the cooked BC1 version of the JPEG, mips included ---
+unsigned int loadTexture(const char* path, bool repeat = true, CookedFormat format = CookedFormat::BC1) {
+    CookedTexture cooked;
+    if (!assetCooker().loadTexture(path, format, cooked)) {
+        EventLog::instance().error(std::string("Failed to load texture: ") + path);
         // Возвращаем 0, но программа продолжит работу, возможно с черной текстурой
         return 0;
     }
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.getSize().x, image.getSize().y, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.getPixelsPtr());
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    if (repeat) {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    }
-    else {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    }
-    return textureID;
+    return renderDevice().createTexture(cooked, repeat);
 }
 
 // --- Mesh Logic ---
 struct Mesh {
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
-    unsigned int VAO, VBO, EBO;
+    TrackedVector<float, MemTag::MeshCPU> vertices;
+    TrackedVector<unsigned int, MemTag::MeshCPU> indices;
+    MeshBuffers gpu;
     unsigned int texture, normalMap = 0;
+    PrimitiveTopology topology = PrimitiveTopology::Triangles;
+    vec3 boundsCenter; float boundsRadius = 0.0f; // Bounding sphere in model space
 
     void setup() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray(0); glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(1); glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(2); glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(3); glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(8 * sizeof(float)));
-        glEnableVertexAttribArray(4); glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
-    }
-
-    void draw(Shader& shader) const {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        shader.setInt("texture1", 0);
-        if (normalMap) {
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, normalMap);
-            shader.setInt("normalMap", 1);
-            shader.setInt("useNormalMap", 1);
-        }
-        else {
-            shader.setInt("useNormalMap", 0);
+        computeBounds();
+        gpu = renderDevice().createMesh(vertices.data(), vertices.size(), indices.data(), indices.size(), topology);
+    }
+
+    void computeBounds() {
+        vec3 lo(1e30f), hi(-1e30f);
+        for (size_t i = 0; i + 2 < vertices.size(); i += 14) {
+            vec3 p(vertices[i], vertices[i + 1], vertices[i + 2]);
+            lo = min(lo, p); hi = max(hi, p);
         }
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+        boundsCenter = (lo + hi) * 0.5f;
+        boundsRadius = length(hi - boundsCenter);
+    }
+
+    void record(CommandList& list, int pipeline, const mat4& model, unsigned int heightMap = 0, uint8_t flags = 0) const {
+        list.draw(pipeline, gpu, model, texture, normalMap, heightMap, flags);
     }
 };
 
+// Tests the mesh's bounding sphere (model must be rigid) against every view and records
+// it once for the views that see it
+bool recordMesh(CommandList& list, int pipeline, const Mesh& mesh, const mat4& model, const ViewSet& views) {
+    vec3 center = vec3(model * vec4(mesh.boundsCenter, 1.0f));
+    uint8_t mask = views.sphereMask(center, mesh.boundsRadius);
+    if (!mask) { list.culled++; return false; }
+    list.visible++;
+    list.beginViews(mask);
+    mesh.record(list, pipeline, model);
+    list.endViews();
+    return true;
+}
+
+// The generators below return the cooked mesh when these parameters were cooked before,
+// and otherwise build it and cook it (optimised orders) before it goes to the GPU
+bool loadCookedMesh(Mesh& mesh, uint64_t key, unsigned int tex, unsigned int normal = 0) {
+    if (!assetCooker().loadMesh(key, mesh.vertices, mesh.indices, mesh.topology)) return false;
+    mesh.texture = tex;
+    mesh.normalMap = normal;
+    mesh.setup();
+    return true;
+}
+
+void cookMesh(Mesh& mesh, uint64_t key) {
+    assetCooker().storeMesh(key, mesh.vertices, mesh.indices, mesh.topology);
+}
+
 Mesh generateCube(float size, unsigned int tex) {
     Mesh mesh;
+    uint64_t key = AssetCooker::meshKey("cube", { size });
+    if (loadCookedMesh(mesh, key, tex)) return mesh;
     float half = size / 2.0f;
     mesh.vertices = {
         // Front
@@ -176,6 +180,7 @@ Mesh generateCube(float size, unsigned int tex) {
         0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4, 8, 9, 10, 10, 11, 8,
         12, 13, 14, 14, 15, 12, 16, 17, 18, 18, 19, 16, 20, 21, 22, 22, 23, 20
     };
+    cookMesh(mesh, key);
     mesh.texture = tex;
     mesh.setup();
     return mesh;
@@ -183,6 +188,8 @@ Mesh generateCube(float size, unsigned int tex) {
 
 Mesh generateCone(float radius, float height, int segments, unsigned int tex) {
     Mesh mesh;
+    uint64_t key = AssetCooker::meshKey("cone", { radius, height, (float)segments });
+    if (loadCookedMesh(mesh, key, tex)) return mesh;
     float angleStep = 2.0f * 3.14159f / segments;
     // Base center
     mesh.vertices.insert(mesh.vertices.end(), { 0.0f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f,  0.5f, 0.5f,  1.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f });
@@ -209,6 +216,7 @@ Mesh generateCone(float radius, float height, int segments, unsigned int tex) {
     for (int i = 0; i < segments; ++i) {
         mesh.indices.push_back(1); mesh.indices.push_back(2 + ((i + 1) % segments) * 2 + 1); mesh.indices.push_back(2 + i * 2 + 1);
     }
+    cookMesh(mesh, key);
     mesh.texture = tex;
     mesh.setup();
     return mesh;
@@ -216,6 +224,8 @@ Mesh generateCone(float radius, float height, int segments, unsigned int tex) {
 
 Mesh generateCylinder(float radius, float height, int segments, unsigned int tex) {
     Mesh mesh;
+    uint64_t key = AssetCooker::meshKey("cylinder", { radius, height, (float)segments });
+    if (loadCookedMesh(mesh, key, tex)) return mesh;
     float angleStep = 2.0f * 3.14159f / segments;
     // Center points
     mesh.vertices.insert(mesh.vertices.end(), { 0.0f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f,  0.5f, 0.5f,  1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f });
@@ -249,13 +259,23 @@ Mesh generateCylinder(float radius, float height, int segments, unsigned int tex
         mesh.indices.push_back(bl); mesh.indices.push_back(tr); mesh.indices.push_back(tl);
         mesh.indices.push_back(bl); mesh.indices.push_back(br); mesh.indices.push_back(tr);
     }
+    cookMesh(mesh, key);
     mesh.texture = tex;
     mesh.setup();
     return mesh;
 }
 
-Mesh generateEllipsoid(float rx, float ry, float rz, int slices, int stacks, unsigned int tex, unsigned int normal = 0) {
+// Grid keys include the form gridIndices picks, so a new topology.cfg cooks them again
+float gridForm(GridTopology requested, int columns, int rows) {
+    bool strips = false;
+    bool measured = gridTopologyTable().lookup(columns, rows, strips);
+    return (float)requested * 4.0f + (measured ? 1.0f : 0.0f) + (strips ? 2.0f : 0.0f);
+}
+
+Mesh generateEllipsoid(float rx, float ry, float rz, int slices, int stacks, unsigned int tex, unsigned int normal = 0, GridTopology topology = GridTopology::Auto) {
     Mesh mesh;
+    uint64_t key = AssetCooker::meshKey("ellipsoid", { rx, ry, rz, (float)slices, (float)stacks, gridForm(topology, slices, stacks) });
+    if (loadCookedMesh(mesh, key, tex, normal)) return mesh;
     for (int i = 0; i <= stacks; ++i) {
         float phi = 3.14159f * i / stacks;
         for (int j = 0; j <= slices; ++j) {
@@ -271,21 +291,21 @@ Mesh generateEllipsoid(float rx, float ry, float rz, int slices, int stacks, uns
             mesh.vertices.insert(mesh.vertices.end(), { tangent.x, tangent.y, tangent.z, bitangent.x, bitangent.y, bitangent.z });
         }
     }
-    for (int i = 0; i < stacks; ++i) {
-        for (int j = 0; j < slices; ++j) {
-            int first = (i * (slices + 1)) + j; int second = first + slices + 1;
-            mesh.indices.push_back(first); mesh.indices.push_back(second); mesh.indices.push_back(first + 1);
-            mesh.indices.push_back(second); mesh.indices.push_back(second + 1); mesh.indices.push_back(first + 1);
-        }
-    }
+    // Stacks are the grid's rows: (i, j), (i + 1, j), (i, j + 1) per quad
+    std::vector<unsigned int> indices;
+    mesh.topology = gridIndices(topology, slices, stacks, indices);
+    mesh.indices.assign(indices.begin(), indices.end());
+    cookMesh(mesh, key);
     mesh.texture = tex;
     mesh.normalMap = normal;
     mesh.setup();
     return mesh;
 }
 
-Mesh generateTerrain(int width, int depth, unsigned int tex, unsigned int heightTex) {
+Mesh generateTerrain(int width, int depth, unsigned int tex, unsigned int heightTex, GridTopology topology = GridTopology::Auto) {
     Mesh mesh;
+    uint64_t key = AssetCooker::meshKey("terrain", { (float)width, (float)depth, gridForm(topology, width, depth) });
+    if (loadCookedMesh(mesh, key, tex)) return mesh;
     for (int z = 0; z <= depth; ++z) {
         for (int x = 0; x <= width; ++x) {
             float u = (float)x / width;
@@ -293,65 +313,516 @@ Mesh generateTerrain(int width, int depth, unsigned int tex, unsigned int height
             mesh.vertices.insert(mesh.vertices.end(), { (float)x - width / 2.0f, 0.0f, (float)z - depth / 2.0f, 0.0f, 1.0f, 0.0f, u * 10.0f, v * 10.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f });
         }
     }
-    for (int z = 0; z < depth; ++z) {
-        for (int x = 0; x < width; ++x) {
-            int topLeft = (z * (width + 1)) + x; int topRight = topLeft + 1; int bottomLeft = ((z + 1) * (width + 1)) + x; int bottomRight = bottomLeft + 1;
-            mesh.indices.push_back(topLeft); mesh.indices.push_back(bottomLeft); mesh.indices.push_back(topRight);
-            mesh.indices.push_back(topRight); mesh.indices.push_back(bottomLeft); mesh.indices.push_back(bottomRight);
-        }
-    }
+    std::vector<unsigned int> indices;
+    mesh.topology = gridIndices(topology, width, depth, indices);
+    mesh.indices.assign(indices.begin(), indices.end());
+    cookMesh(mesh, key);
     mesh.texture = tex;
     mesh.setup();
     return mesh;
 }
 
-struct Parcel {
-    vec3 position;
-    vec3 velocity = vec3(0, -9.8f, 0);
-    Mesh mesh;
-    float radius = 0.5f;
-    bool active = true;
-};
-
-struct Target {
-    vec3 position;
-    Mesh body;
-    Mesh roof;
-    float radius = 2.5f;
-    bool active = true;
-};
-
 // NEW: Decoration struct for tree ornaments
 struct Decoration {
     Mesh mesh;
     vec3 relativePos; // Position relative to the tree base
 };
 
-float getTerrainHeight(float worldX, float worldZ, const sf::Image& heightMap, float terrainScale, float terrainHeightScale) {
+float getTerrainHeight(float worldX, float worldZ, const CookedTexture& heightMap, float terrainScale, float terrainHeightScale) {
     float mapSize = 100.0f * terrainScale;
     float halfSize = mapSize / 2.0f;
     if (worldX < -halfSize || worldX > halfSize || worldZ < -halfSize || worldZ > halfSize) return 0.0f;
     float u = (worldX + halfSize) / mapSize;
     float v = (worldZ + halfSize) / mapSize;
-    unsigned int x = (unsigned int)(u * heightMap.getSize().x);
-    unsigned int y = (unsigned int)(v * heightMap.getSize().y);
-    if (x >= heightMap.getSize().x) x = heightMap.getSize().x - 1;
-    if (y >= heightMap.getSize().y) y = heightMap.getSize().y - 1;
-    sf::Color c = heightMap.getPixel(x, y);
-    return (c.r / 255.0f) * terrainHeightScale;
+    if (heightMap.levels.empty()) return 0.0f;
+    unsigned int x = (unsigned int)(u * heightMap.width);
+    unsigned int y = (unsigned int)(v * heightMap.height);
+    if (x >= (unsigned int)heightMap.width) x = heightMap.width - 1;
+    if (y >= (unsigned int)heightMap.height) y = heightMap.height - 1;
+    uint8_t r = heightMap.levels[0][(size_t)y * heightMap.width + x];
+    return (r / 255.0f) * terrainHeightScale;
 }
 
-int main() {
+// Gameplay height queries, from heightmap.jpg (cooked to R8) or from the procedural terrain
+struct TerrainSampler {
+    const CookedTexture* heightMap = nullptr;
+    const ProceduralTerrain* procedural = nullptr;
+    float scale = 2.0f, heightScale = 10.0f;
+
+    float height(float x, float z) const {
+        return procedural ? procedural->height(x, z) : getTerrainHeight(x, z, *heightMap, scale, heightScale);
+    }
+};
+
+// Authoritative parcel physics and parcel-vs-house hits, shared by single player and the host.
+// The entity tree is the broadphase; it is synced with the moved parcels before the hit tests.
+void updateParcels(GameState& state, float dt, const TerrainSampler& terrain, EntityTree& entities) {
+    for (int i = 0; i < state.parcelCount; ++i) {
+        Parcel& p = state.parcels[i];
+        if (!p.active) continue;
+        p.position += p.velocity * dt;
+        float terrainH = terrain.height(p.position.x, p.position.z);
+        if (p.position.y <= terrainH) { p.active = false; state.recordEvent(GameEventKind::ParcelLanded, p.position); }
+    }
+    entities.sync(state);
+    for (int i = 0; i < state.parcelCount; ++i) {
+        Parcel& p = state.parcels[i];
+        if (!p.active) continue;
+        vec3 lo, hi;
+        EntityTree::bounds(EntityKind::Parcel, p.position, lo, hi);
+        entities.housesNear(lo, hi, [&](int j) {
+            Target& t = state.targets[j];
+            if (!p.active || !t.active) return;
+            if (distance(p.position, t.position) < p.radius + t.radius) {
+                t.active = false; p.active = false; state.score++; EventLog::instance().score(state.score, t.position);
+                state.recordEvent(GameEventKind::ParcelLanded, p.position);
+                state.recordEvent(GameEventKind::TargetHit, t.position);
+            }
+        });
+    }
+}
+
+// A few blocks of houses on the heightmap, towns across the whole map on procedural terrain.
+// Every peer runs this and must get the same houses in the same order.
+// Half the width of the area houses (and the stress scene) go in
+float villageHalfExtent(const TerrainSampler& terrain) {
+    return terrain.procedural ? 480.0f : 96.0f; // The heightmap spans 100 units each way
+}
+
+void placeVillage(Village& village, GameState& state, const TerrainSampler& terrain, uint32_t terrainSeed, const vec3& treePos, CommandRecorder& workers,
+    const StressScene* stress = nullptr) {
+    VillageSettings settings;
+    settings.halfExtent = villageHalfExtent(terrain);
+    if (stress) {
+        settings.spacing = stress->houseSpacing(settings.halfExtent);
+        settings.maxHouses = stress->config().houses;
+        settings.seed = stress->config().seed;
+    }
+    settings.townMask = terrain.procedural != nullptr;
+    if (!stress) settings.seed = terrainSeed;
+    settings.clearCenter = vec2(treePos.x, treePos.z);
+    settings.clearRadius = 12.0f;
+    village.generate(state, settings, [&](float x, float z) { return terrain.height(x, z); }, workers);
+}
+
+// Headless server without a window. With simulatedClients > 0 it also runs that many
+// clients over loopback pressing random buttons, and reports the server's cost per client.
+// Peers must agree on the terrain: a procedural host needs clients with the same seed.
+int runDedicatedServer(unsigned short port, int simulatedClients, float durationSeconds, bool proceduralTerrain, uint32_t terrainSeed) {
+    EventLog& events = EventLog::instance();
+    CookedTexture heightMap;
+    if (!proceduralTerrain && !assetCooker().loadTexture("heightmap.jpg", CookedFormat::R8, heightMap)) events.error("Error loading heightmap image!");
+    assetCooker().finish(false);
+    ProceduralTerrain procedural(terrainSeed); // Not streamed; heights come straight from the noise
+    TerrainSampler terrain;
+    terrain.heightMap = &heightMap;
+    terrain.procedural = proceduralTerrain ? &procedural : nullptr;
+
+    GameState state;
+    CommandRecorder workers(CommandRecorder::defaultWorkerCount());
+    Village village;
+    placeVillage(village, state, terrain, terrainSeed, vec3(20.0f, 0.0f, 20.0f), workers); // Same clearing as the windowed game's tree
+    EntityTree entities;
+    NetServer server;
+    if (!server.start(port, false)) { events.error("Could not bind UDP port " + std::to_string(port)); return -1; }
+    events.info("Dedicated server on UDP port " + std::to_string(port) + (simulatedClients > 0 ? ", " + std::to_string(simulatedClients) + " simulated clients" : ""));
+
+    struct SimClient {
+        NetClient net;
+        GameState view;
+        uint8_t buttons = 0;
+    };
+    std::vector<std::unique_ptr<SimClient>> bots;
+    std::mt19937 rng(1234);
+    for (int i = 0; i < simulatedClients; ++i) {
+        bots.emplace_back(new SimClient());
+        if (!bots.back()->net.connect(sf::IpAddress::LocalHost, port)) { events.error("Could not open a UDP socket for a simulated client"); return -1; }
+    }
+
+    const float dt = 1.0f / 60.0f;
+    sf::Clock runClock;
+    float nextStep = 0.0f, nextReport = 1.0f;
+    while (durationSeconds <= 0.0f || nextStep < durationSeconds) {
+        float now = runClock.getElapsedTime().asSeconds();
+        if (now < nextStep) { sf::sleep(sf::seconds(nextStep - now)); continue; }
+        nextStep += dt;
+
+        for (size_t i = 0; i < bots.size(); ++i) {
+            SimClient* bot = bots[i].get();
+            // Drain the server as we go, or a burst of hundreds of inputs overflows its socket buffer
+            if (i % 64 == 63) server.receive(state, now);
+            if (rng() % 60 == 0) bot->buttons = (uint8_t)(rng() & (InputForward | InputBack | InputRight | InputLeft));
+            uint8_t buttons = bot->buttons | (rng() % 120 == 0 ? InputDrop : 0);
+            bot->net.receive(dt);
+            bot->net.sendInput(buttons, dt);
+            bot->net.apply(bot->view, dt);
+        }
+        server.receive(state, now);
+        updateParcels(state, dt, terrain, entities);
+        server.update(state, dt, now);
+
+        if (nextStep >= nextReport) {
+            nextReport += 1.0f;
+            char line[160];
+            snprintf(line, sizeof(line), "Server: %d clients, tick %.2f ms, %.1f us/client, %.1f KB/s/client, %d parcels",
+                server.clientCount(), server.lastTickMs(), server.cpuMicrosecondsPerClient(), server.sendBytesPerClient() / 1024.0f, state.activeParcels());
+            events.info(line);
+            std::cout << line << std::endl;
+        }
+    }
+    return 0;
+}
+
+// --bench-aabb: boxes drifting in random directions, kept in a DynamicAabbTree by
+// incremental moves, by batch refits and by rebuilding it every frame, each followed by
+// the frame's frustum query and a few thousand small box queries
+int runAabbTreeBenchmark() {
+    const int frames = 120;
+    const float dt = 1.0f / 60.0f;
+    mat4 viewProjection = perspective(radians(60.0f), 4.0f / 3.0f, 0.1f, 400.0f) * lookAt(vec3(0, 30, 0), vec3(0, 0, -100), vec3(0, 1, 0));
+    Frustum frustum(viewProjection);
+    const char* methods[3] = { "incremental", "batch refit", "rebuild" };
+    for (int count : { 10000, 30000, 100000 }) {
+        for (int method = 0; method < 3; ++method) {
+            std::mt19937 rng(42);
+            std::uniform_real_distribution<float> spread(-1000.0f, 1000.0f), speed(-20.0f, 20.0f);
+            std::vector<vec3> positions(count), velocities(count);
+            for (int i = 0; i < count; ++i) {
+                positions[i] = vec3(spread(rng), spread(rng) * 0.05f, spread(rng));
+                velocities[i] = vec3(speed(rng), speed(rng) * 0.2f, speed(rng));
+            }
+            DynamicAabbTree tree;
+            tree.reserve(count);
+            std::vector<int> proxies(count);
+            for (int i = 0; i < count; ++i) proxies[i] = tree.createProxy(positions[i] - vec3(1.0f), positions[i] + vec3(1.0f), i);
+            tree.takeReinsertions();
+
+            float updateMs = 0.0f, queryMs = 0.0f;
+            long long found = 0;
+            sf::Clock timer;
+            for (int f = 0; f < frames; ++f) {
+                timer.restart();
+                for (int i = 0; i < count; ++i) {
+                    vec3 step = velocities[i] * dt;
+                    positions[i] += step;
+                    vec3 lo = positions[i] - vec3(1.0f), hi = positions[i] + vec3(1.0f);
+                    if (method == 0) tree.moveProxy(proxies[i], lo, hi, step);
+                    else tree.setBounds(proxies[i], lo, hi, step);
+                }
+                if (method == 1) tree.refit();
+                if (method == 2) tree.rebuild();
+                updateMs += timer.restart().asMicroseconds() / 1000.0f;
+                tree.query(frustum, [&](int) { found++; });
+                for (int q = 0; q < 2000; ++q) {
+                    vec3 center = positions[(q * 7919) % count];
+                    tree.query(center - vec3(4.0f), center + vec3(4.0f), [&](int) { found++; });
+                }
+                queryMs += timer.getElapsedTime().asMicroseconds() / 1000.0f;
+            }
+            char line[200];
+            snprintf(line, sizeof(line), "AABB tree: %6d boxes, %-11s update %7.3f ms  queries %7.3f ms  height %2d  cost %.1f  reinserts/frame %d  (%lld hits)",
+                count, methods[method], updateMs / frames, queryMs / frames, tree.height(), tree.cost(), tree.takeReinsertions() / frames, found);
+            EventLog::instance().info(line);
+            std::cout << line << std::endl;
+        }
+    }
+    return 0;
+}
+
+// --bench-strips: draws every grid shape the scene builds as an optimised triangle list
+// and as restart-separated strips, with the rasterizer discarded so only index fetch,
+// vertex shading and primitive assembly are timed, and keeps the faster form per shape
+// in topology.cfg for the next launches. Run it on each driver, including a software
+// rasterizer such as Mesa's llvmpipe (LIBGL_ALWAYS_SOFTWARE=1).
+int runTopologyBenchmark(GLRenderDevice& device, Shader& shader, const char* path) {
+    const int drawsPerTrial = 40, trials = 8;
+    struct Shape { const char* name; int columns, rows; };
+    const Shape shapes[] = { { "terrain", 100, 100 }, { "terrain tile", ProceduralTerrain::tileQuads, ProceduralTerrain::tileQuads },
+        { "balloon", 32, 32 }, { "ornament", 24, 24 } };
+    EventLog::instance().info(std::string("Topology benchmark on ") + reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    shader.use();
+    shader.setMat4("view", mat4(1.0f));
+    shader.setMat4("projection", mat4(1.0f));
+    unsigned int query;
+    glGenQueries(1, &query);
+    glEnable(GL_RASTERIZER_DISCARD);
+    for (const Shape& shape : shapes) {
+        std::vector<float> vertices;
+        for (int r = 0; r <= shape.rows; ++r)
+            for (int c = 0; c <= shape.columns; ++c)
+                vertices.insert(vertices.end(), { (float)c, 0.0f, (float)r, 0.0f, 1.0f, 0.0f, (float)c / shape.columns, (float)r / shape.rows, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f });
+        MeshBuffers meshes[2];
+        int indexCounts[2];
+        float cacheMisses[2];
+        for (int form = 0; form < 2; ++form) {
+            std::vector<unsigned int> indices;
+            PrimitiveTopology topology = gridIndices(form ? GridTopology::Strips : GridTopology::Triangles, shape.columns, shape.rows, indices);
+            meshes[form] = device.createMesh(vertices.data(), vertices.size(), indices.data(), indices.size(), topology);
+            indexCounts[form] = (int)indices.size();
+            cacheMisses[form] = (float)mesh_topology::simulateTransforms(indices.data(), indices.size()) / meshes[form].triangleCount;
+        }
+        // Forms alternate within each trial so clock changes hit both; the first trial warms up
+        double best[2] = { 1e30, 1e30 };
+        CommandList list;
+        for (int trial = 0; trial < trials; ++trial) {
+            for (int form = 0; form < 2; ++form) {
+                list.clear();
+                for (int d = 0; d < drawsPerTrial; ++d) list.draw(shader.pipeline, meshes[form], mat4(1.0f), 0);
+                glBeginQuery(GL_TIME_ELAPSED, query);
+                device.submit(list);
+                glEndQuery(GL_TIME_ELAPSED);
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+                if (trial > 0) best[form] = std::min(best[form], (double)ns / ((double)drawsPerTrial * meshes[form].triangleCount));
+            }
+        }
+        bool strips = best[1] < best[0];
+        gridTopologyTable().set(shape.columns, shape.rows, strips);
+        char line[220];
+        snprintf(line, sizeof(line), "Topology: %-12s %3dx%-3d list %6.3f ns/tri (%5d indices, %.2f misses/tri)  strips %6.3f ns/tri (%5d indices, %.2f misses/tri)  -> %s",
+            shape.name, shape.columns, shape.rows, best[0], indexCounts[0], cacheMisses[0], best[1], indexCounts[1], cacheMisses[1], strips ? "strips" : "triangles");
+        EventLog::instance().info(line);
+        std::cout << line << std::endl;
+        device.destroyMesh(meshes[0]);
+        device.destroyMesh(meshes[1]);
+    }
+    glDisable(GL_RASTERIZER_DISCARD);
+    glDeleteQueries(1, &query);
+    gridTopologyTable().save(path);
+    return 0;
+}
+
+// --replay file [frames]: plays a frame written with --capture in this window with none
+// of the game around it (no simulation, culling or command recording, only its GL calls)
+// and reports the CPU time to submit it, the GPU time and the calls by type, so driver
+// paths can be compared on the same frame. The first playback is a warm-up.
+int runReplay(sf::Window& window, const char* path, int frames) {
+    EventLog& events = EventLog::instance();
+    GLReplay replay;
+    if (!replay.load(path)) { events.error(std::string("Could not read GL capture ") + path); return 1; }
+    window.setFramerateLimit(0);
+    window.setVerticalSyncEnabled(false);
+    window.setSize(sf::Vector2u((unsigned int)replay.width(), (unsigned int)replay.height()));
+    if (!replay.createResources()) return 1;
+    events.info(std::string("Replaying ") + path + " on " + reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    unsigned int query;
+    glGenQueries(1, &query);
+    int counts[(int)GLCaptureOp::Count] = {};
+    double cpuTotal = 0.0, gpuTotal = 0.0, cpuBest = 1e30, gpuBest = 1e30;
+    int timed = 0;
+    for (int frame = 0; frame < frames && window.isOpen(); ++frame) {
+        sf::Event event;
+        while (window.pollEvent(event)) if (event.type == sf::Event::Closed) window.close();
+        replay.runPrologue();
+        sf::Clock submitClock;
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        replay.runFrame(frame == 0 ? counts : nullptr);
+        glEndQuery(GL_TIME_ELAPSED);
+        double cpuMs = submitClock.getElapsedTime().asMicroseconds() / 1000.0;
+        window.display();
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        if (frame == 0) continue;
+        double gpuMs = ns / 1e6;
+        cpuTotal += cpuMs; gpuTotal += gpuMs; timed++;
+        cpuBest = std::min(cpuBest, cpuMs); gpuBest = std::min(gpuBest, gpuMs);
+    }
+    glDeleteQueries(1, &query);
+    char line[200];
+    snprintf(line, sizeof(line), "Replay: %d frames of %.1f KB, submit %.3f ms (best %.3f), GPU %.3f ms (best %.3f)",
+        timed, replay.frameBytes() / 1024.0f, timed ? cpuTotal / timed : 0.0, timed ? cpuBest : 0.0, timed ? gpuTotal / timed : 0.0, timed ? gpuBest : 0.0);
+    events.info(line);
+    std::cout << line << std::endl;
+    for (int op = 0; op < (int)GLCaptureOp::Count; ++op) {
+        if (!counts[op]) continue;
+        snprintf(line, sizeof(line), "  %-24s %6d", glCaptureOpName((GLCaptureOp)op), counts[op]);
+        std::cout << line << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
     sf::ContextSettings settings;
-    settings.depthBits = 24; settings.stencilBits = 8; settings.antialiasingLevel = 4;
+    settings.depthBits = 24; settings.stencilBits = 8; settings.antialiasingLevel = 0; // MSAA lives in the frame graph's scene targets
     settings.majorVersion = 3; settings.minorVersion = 3;
 
+    EventLog& events = EventLog::instance();
+    events.start("events.jsonl");
+
+    // --- Network mode: --host [port], --connect address[:port] or --dedicated [port] [--bench clients [seconds]] ---
+    // --bench on its own implies --dedicated
+    // --bench-aabb only runs the AABB tree benchmark; --bench-strips times grid topologies on this driver
+    // --stress [file] runs the stress scene (settings from the file, see StressScene.h) and exits with a report
+    // --capture [frame] records GL frames (that frame, and the next one whenever F7 is pressed); --replay file [frames] plays one back
+    // --control [port] accepts scripted commands on 127.0.0.1 (see ControlServer.h)
+    // --test-graph checks render graph target aliasing on this driver and exits
+    // --cook brings cooked/ up to date with the sources, removes stale outputs and exits (see AssetCooker.h)
+    NetMode netMode = NetMode::Offline;
+    std::string connectAddress;
+    unsigned short netPort = defaultNetPort;
+    bool dedicated = false;
+    bool nullAudio = false; // --null-audio for machines without an output device
+    bool lowLatency = false;
+    bool benchStrips = false;
+    bool stressMode = false;
+    StressSettings stressSettings;
+    bool captureGL = false;
+    int captureAtFrame = -1;
+    std::string replayPath;
+    int replayFrames = 100;
+    bool bench = false; int benchClients = 0; float benchSeconds = 0.0f;
+    unsigned short controlPort = 0;
+    bool cookOnly = false;
+    bool testGraph = false;
+    bool proceduralTerrain = false; // --procedural [seed]
+    uint32_t terrainSeed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--host" || arg == "--dedicated") {
+            netMode = NetMode::Host;
+            dedicated = arg == "--dedicated";
+            if (i + 1 < argc && argv[i + 1][0] != '-') netPort = (unsigned short)atoi(argv[++i]);
+        }
+        else if (arg == "--null-audio") {
+            nullAudio = true;
+        }
+        else if (arg == "--low-latency") {
+            lowLatency = true;
+        }
+        else if (arg == "--procedural") {
+            proceduralTerrain = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') terrainSeed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--bench-aabb") {
+            int result = runAabbTreeBenchmark();
+            events.stop();
+            return result;
+        }
+        else if (arg == "--bench-strips") {
+            benchStrips = true;
+        }
+        else if (arg == "--stress") {
+            stressMode = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-' && !loadStressSettings(argv[++i], stressSettings))
+                events.warning(std::string("Could not read ") + argv[i] + ", using the default stress scene");
+        }
+        else if (arg == "--capture") {
+            captureGL = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') captureAtFrame = atoi(argv[++i]);
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') replayFrames = std::max(2, atoi(argv[++i]));
+        }
+        else if (arg == "--control") {
+            controlPort = 9151;
+            if (i + 1 < argc && argv[i + 1][0] != '-') controlPort = (unsigned short)atoi(argv[++i]);
+        }
+        else if (arg == "--cook") {
+            cookOnly = true;
+        }
+        else if (arg == "--test-graph") {
+            testGraph = true;
+        }
+        else if (arg == "--bench" && i + 1 < argc) {
+            bench = true;
+            benchClients = atoi(argv[++i]);
+            benchSeconds = 30.0f;
+            if (i + 1 < argc && argv[i + 1][0] != '-') benchSeconds = (float)atof(argv[++i]);
+        }
+        else if (arg == "--connect" && i + 1 < argc) {
+            netMode = NetMode::Client;
+            std::string target = argv[++i];
+            size_t colon = target.find(':');
+            connectAddress = target.substr(0, colon);
+            if (colon != std::string::npos) netPort = (unsigned short)atoi(target.substr(colon + 1).c_str());
+        }
+    }
+    if (bench && !dedicated) {
+        // The bench only exists on the dedicated server, so ask for it rather than ignore the option
+        if (netMode == NetMode::Client || stressMode) {
+            events.error("--bench runs a dedicated server; it cannot be combined with --connect or --stress");
+            events.stop();
+            return -1;
+        }
+        events.info("--bench implies --dedicated");
+        netMode = NetMode::Host;
+        dedicated = true;
+    }
+    if (stressMode && netMode != NetMode::Offline) {
+        events.warning("The stress scene runs offline; ignoring the network options");
+        netMode = NetMode::Offline;
+        dedicated = false;
+    }
+    if (proceduralTerrain && netMode != NetMode::Offline)
+        events.warning("Networked games keep airships within " + std::to_string((int)netWorldHalfExtent) + " units of the origin; the procedural terrain is only unbounded offline");
+    if (dedicated) {
+        int result = runDedicatedServer(netPort, benchClients, benchSeconds, proceduralTerrain, terrainSeed);
+        events.stop();
+        return result;
+    }
+
+    // Soak-test metrics: curl http://127.0.0.1:9150/metrics
+    const unsigned short metricsPort = 9150;
+    MetricsServer metrics;
+    if (!metrics.start(metricsPort)) events.warning("Metrics endpoint could not bind 127.0.0.1:" + std::to_string(metricsPort));
+    ControlServer control;
+    if (controlPort && !control.start(controlPort)) events.warning("Control socket could not bind 127.0.0.1:" + std::to_string(controlPort));
+
     sf::Window window(sf::VideoMode(800, 600), "Christmas Delivery", sf::Style::Default, settings);
     window.setActive(true);
-    window.setFramerateLimit(60);
+    window.setFramerateLimit(lowLatency ? 0 : 60);
 
-    if (!gladLoadGL()) { std::cout << "Failed to initialize GLAD" << std::endl; return -1; }
+    if (!gladLoadGL()) { events.error("Failed to initialize GLAD"); events.stop(); return -1; }
+    if (!replayPath.empty()) {
+        int result = runReplay(window, replayPath.c_str(), replayFrames);
+        events.stop();
+        return result;
+    }
+    if (testGraph) {
+        std::string report;
+        bool ok = RenderGraph::aliasingSelfTest(report);
+        std::cout << report << (ok ? "Render graph aliasing: ok" : "Render graph aliasing: FAILED") << std::endl;
+        if (ok) events.info("Render graph aliasing self-test passed");
+        else { events.error("Render graph aliasing self-test failed:"); logLines(events, LogLevel::Error, report); }
+        events.stop();
+        return ok ? 0 : 1;
+    }
+    // Before anything creates GL objects, so the capture layer sees all of them
+    GLCapture& glCapture = GLCapture::instance();
+    if (captureGL) glCapture.install();
+    bool captureRequested = false;
+    int framesRendered = 0, capturesWritten = 0;
     glEnable(GL_DEPTH_TEST);
+    GLRenderDevice& device = renderDevice();
+    device.init();
+    device.loadPipelineCache("pipeline_cache.bin");
+
+    // --- Quality tier from quality.cfg; without one the first frames benchmark it. F4 cycles tiers ---
+    const char* qualityPath = "quality.cfg";
+    QualityTier qualityTier = QualityTier::High;
+    bool qualityConfigured = loadQualityTier(qualityPath, qualityTier);
+    QualitySettings quality = qualityPreset(qualityTier);
+    QualityBenchmark qualityBenchmark;
+    const vec3 fogColor(0.5f, 0.7f, 1.0f); // Also the clear color, so the cull boundary is invisible
+    device.setMaxTextureSize(quality.maxTextureSize);
+
+    AudioSystem audio;
+    audio.init(nullAudio);
+
+    OcclusionCuller occlusion;
+    occlusion.init();
+    const int treeOcclusionId = Village::maxBlocks; // Trees from here up; village blocks use their block index
+
+    // --- LOD budget: trades texture detail and small parts for the frame time target. F8 toggles ---
+    GpuFrameTimer gpuTimer;
+    gpuTimer.init();
+    LodController lod;
+    lod.setTarget(12.5f);
+
+    StatsOverlay overlay;
+    overlay.init();
+    bool showOverlay = true;
 
     // --- Shaders ---
     const char* vertexShaderSource = R"(
@@ -361,34 +832,65 @@ int main() {
         layout (location = 2) in vec2 aTexCoords;
         layout (location = 3) in vec3 aTangent;
         layout (location = 4) in vec3 aBitangent;
-        out vec3 FragPos; out vec3 Normal; out vec2 TexCoords; out mat3 TBN;
+        layout (location = 5) in float aOcclusion;
+        out vec3 FragPos; out vec3 Normal; out vec2 TexCoords; out mat3 TBN; out float Occlusion;
         uniform mat4 model; uniform mat4 view; uniform mat4 projection; uniform sampler2D heightMap; uniform bool isTerrain;
+        uniform ivec2 instanceMask; // First instance and vertices per instance; heightMap then holds one visibility texel each
         void main() {
             vec3 pos = aPos;
             if (isTerrain) { float height = texture(heightMap, aTexCoords / 10.0).r * 10.0; pos.y += height; }
-            FragPos = vec3(model * vec4(pos, 1.0)); Normal = mat3(transpose(inverse(model))) * aNormal; TexCoords = aTexCoords;
+            FragPos = vec3(model * vec4(pos, 1.0)); Normal = mat3(transpose(inverse(model))) * aNormal; TexCoords = aTexCoords; Occlusion = aOcclusion;
             vec3 T = normalize(vec3(model * vec4(aTangent, 0.0))); vec3 B = normalize(vec3(model * vec4(aBitangent, 0.0))); vec3 N = normalize(vec3(model * vec4(aNormal, 0.0)));
             TBN = mat3(T, B, N); gl_Position = projection * view * vec4(FragPos, 1.0);
+            if (instanceMask.y > 0) {
+                int instance = instanceMask.x + gl_VertexID / instanceMask.y;
+                // Outside the clip volume on every vertex, so the instance's triangles are all dropped
+                if (texelFetch(heightMap, ivec2(instance % 256, instance / 256), 0).r < 0.5) gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+            }
         }
     )";
     const char* fragmentShaderSource = R"(
         #version 330 core
         out vec4 FragColor;
-        in vec3 FragPos; in vec3 Normal; in vec2 TexCoords; in mat3 TBN;
+        in vec3 FragPos; in vec3 Normal; in vec2 TexCoords; in mat3 TBN; in float Occlusion;
         uniform sampler2D texture1; uniform sampler2D normalMap; uniform vec3 lightDir; uniform vec3 viewPos; uniform int useNormalMap;
+        uniform vec3 fogColor; uniform float fogDensity; uniform float lodBias;
         void main() {
             vec3 norm;
             if (useNormalMap == 1) { vec3 normal = texture(normalMap, TexCoords).rgb; normal = normal * 2.0 - 1.0; norm = normalize(TBN * normal); } else { norm = normalize(Normal); }
-            vec3 color = texture(texture1, TexCoords).rgb;
-            vec3 ambient = 0.3 * color; float diff = max(dot(norm, -lightDir), 0.0); vec3 diffuse = diff * color;
+            vec3 color = texture(texture1, TexCoords, lodBias).rgb;
+            // Baked occlusion darkens all of the ambient and half of the sun, as there are no shadow maps
+            vec3 ambient = 0.3 * color * Occlusion; float diff = max(dot(norm, -lightDir), 0.0); vec3 diffuse = diff * color * (0.5 + 0.5 * Occlusion);
             vec3 viewDir = normalize(viewPos - FragPos); vec3 halfwayDir = normalize(-lightDir + viewDir);
             float spec = pow(max(dot(norm, halfwayDir), 0.0), 32.0); vec3 specular = vec3(0.3) * spec;
-            FragColor = vec4(ambient + diffuse + specular, 1.0);
+            float fogAmount = fogDensity * length(viewPos - FragPos); float visibility = exp(-fogAmount * fogAmount);
+            FragColor = vec4(mix(fogColor, ambient + diffuse + specular, visibility), 1.0);
         }
     )";
     Shader shader(vertexShaderSource, fragmentShaderSource);
+    events.info("Pipeline cache: " + std::to_string(device.cacheHits()) + " hits, " + std::to_string(device.cacheMisses()) + " misses");
+
+    // --- Grid meshes as triangle lists or strips, per shape, from topology.cfg (written by --bench-strips) ---
+    const char* topologyPath = "topology.cfg";
+    if (benchStrips) {
+        int result = runTopologyBenchmark(device, shader, topologyPath);
+        events.stop();
+        return result;
+    }
+    gridTopologyTable().load(topologyPath);
+
+    // Worker threads: texture cooking and village generation at load, scene recording every frame
+    CommandRecorder recorder(CommandRecorder::defaultWorkerCount());
 
-    // --- Loading Textures ---
+    // --- Loading Textures: cooked on the workers first where the source changed ---
+    const AssetCooker::TextureSource sceneTextures[] = {
+        { "grass.jpg", CookedFormat::BC1 }, { "tree_bark.jpg", CookedFormat::BC1 }, { "tree_leaves.jpg", CookedFormat::BC1 },
+        { "airship_tex.jpg", CookedFormat::BC1 }, { "airship_normal.jpg", CookedFormat::BC1 }, { "house_tex.jpg", CookedFormat::BC1 },
+        { "parcel_tex.jpg", CookedFormat::BC1 }, { "heightmap.jpg", CookedFormat::R8 },
+        { "ball_tree1.jpg", CookedFormat::BC1 }, { "ball_tree2.jpg", CookedFormat::BC1 }, { "ball_tree3.jpg", CookedFormat::BC1 },
+        { "ball_tree4.jpg", CookedFormat::BC1 }, { "ball_tree5.jpg", CookedFormat::BC1 }, { "star.jpg", CookedFormat::BC1 },
+    };
+    assetCooker().cookTextures(sceneTextures, (int)(sizeof(sceneTextures) / sizeof(sceneTextures[0])), recorder);
     unsigned int grassTex = loadTexture("grass.jpg");
     unsigned int treeBarkTex = loadTexture("tree_bark.jpg");
     unsigned int treeLeavesTex = loadTexture("tree_leaves.jpg");
@@ -396,7 +898,9 @@ int main() {
     unsigned int airshipNormal = loadTexture("airship_normal.jpg", false);
     unsigned int houseTex = loadTexture("house_tex.jpg");
     unsigned int parcelTex = loadTexture("parcel_tex.jpg");
-    unsigned int heightMapTex = loadTexture("heightmap.jpg", false);
+    device.setMaxTextureSize(0); // Displacement must match the full-resolution image collisions use
+    unsigned int heightMapTex = loadTexture("heightmap.jpg", false, CookedFormat::R8);
+    device.setMaxTextureSize(quality.maxTextureSize);
 
     // NEW: Decoration Textures
     std::vector<unsigned int> ballTexs;
@@ -407,8 +911,8 @@ int main() {
     ballTexs.push_back(loadTexture("ball_tree5.jpg"));
     unsigned int starTex = loadTexture("star.jpg");
 
-    sf::Image heightMapImage;
-    if (!heightMapImage.loadFromFile("heightmap.jpg")) std::cout << "Error loading heightmap image!" << std::endl;
+    CookedTexture heightMap; // Full resolution, for collisions
+    if (!assetCooker().loadTexture("heightmap.jpg", CookedFormat::R8, heightMap)) events.error("Error loading heightmap image!");
 
     // --- Generate Models ---
     Mesh terrain = generateTerrain(100, 100, grassTex, heightMapTex);
@@ -419,11 +923,22 @@ int main() {
     Mesh balloon = generateEllipsoid(5.0f, 3.0f, 3.0f, 32, 32, airshipTex, airshipNormal);
     Mesh gondola = generateCube(2.0f, airshipTex);
     Mesh parcelMesh = generateCube(1.0f, parcelTex);
+    // Houses are only drawn merged per village block; these are just the template
     Mesh houseBody = generateCube(4.0f, houseTex);
     Mesh houseRoof = generateCone(3.5f, 3.0f, 4, houseTex);
+    std::vector<float> houseVertices(houseBody.vertices.begin(), houseBody.vertices.end());
+    std::vector<unsigned int> houseIndices(houseBody.indices.begin(), houseBody.indices.end());
+    mat4 roofModel = rotate(translate(mat4(1.0f), vec3(0, 2.0f, 0)), radians(45.0f), vec3(0, 1, 0));
+    Village::appendTransformed(houseVertices, houseIndices, houseRoof.vertices.data(), houseRoof.vertices.size(), houseRoof.indices.data(), houseRoof.indices.size(), roofModel);
+    device.destroyMesh(houseBody.gpu);
+    device.destroyMesh(houseRoof.gpu);
+
+    // --- Stress scene: more of everything, a fixed flight and a report (--stress) ---
+    std::unique_ptr<StressScene> stress;
+    if (stressMode) stress.reset(new StressScene(stressSettings));
 
     // NEW: Generate Decorations
-    std::vector<Decoration> treeDecorations;
+    TrackedVector<Decoration, MemTag::Scene> treeDecorations;
     // Star on top (sphere with star texture)
     Decoration starDeco;
     starDeco.mesh = generateEllipsoid(0.6f, 3.0f, 0.6f, 24, 24, starTex);
@@ -440,126 +955,630 @@ int main() {
         vec3(1.5f, 9.0f, 3.5f),   // Middle/Top area red_with_star
         vec3(-0.8f, 11.5f, 2.8f) // Top branch area white_ball
     };
-    for (int i = 0; i < 5; ++i) {
+    if (stress) ballPositions = stress->ornamentOffsets();
+    for (int i = 0; i < (int)ballPositions.size(); ++i) {
         Decoration ballDeco;
         // Small sphere for ball, cycling through textures
         ballDeco.mesh = generateEllipsoid(0.4f, 0.4f, 0.4f, 24, 24, ballTexs[i % ballTexs.size()]);
         ballDeco.relativePos = ballPositions[i];
         treeDecorations.push_back(ballDeco);
     }
+    if (cookOnly) {
+        assetCooker().finish(true);
+        events.stop();
+        return 0;
+    }
+    assetCooker().finish(false);
 
 
     // --- Setup Scene ---
-    vec3 airshipPos(0.0f, 30.0f, 0.0f);
+    GameState state;
+    state.airships[0].position = vec3(0.0f, 30.0f, 0.0f);
+    state.airships[0].active = netMode != NetMode::Client;
     vec3 treePos(20.0f, 0.0f, 20.0f);
-    float terrainScale = 2.0f; float terrainHeightScale = 10.0f;
-    treePos.y = getTerrainHeight(treePos.x, treePos.z, heightMapImage, terrainScale, terrainHeightScale);
+    // --- Terrain: heightmap.jpg, or infinite noise terrain streamed in by workers with --procedural ---
+    ProceduralTerrain procedural(terrainSeed);
+    if (proceduralTerrain) procedural.startStreaming(device, 2); // Mostly idle; two keep up far past top speed
+    TerrainSampler terrainHeights;
+    terrainHeights.heightMap = &heightMap;
+    terrainHeights.procedural = proceduralTerrain ? &procedural : nullptr;
+    treePos.y = terrainHeights.height(treePos.x, treePos.z);
+    Village village;
+    placeVillage(village, state, terrainHeights, terrainSeed, treePos, recorder, stress.get());
+    std::vector<vec3> trees(1, treePos); // The first is the one the village keeps clear and the one baked below
+    if (stress) {
+        float halfExtent = villageHalfExtent(terrainHeights);
+        trees = stress->placeTrees(treePos, halfExtent, state, [&terrainHeights](float x, float z) { return terrainHeights.height(x, z); });
+        stress->populate(state, halfExtent);
+    }
+    EntityTree entities; // Culling, the parcel broadphase and mouse picking; click to pick
+    entities.sync(state);
+    device.setMaxTextureSize(0); // One texel per house, never filtered down
+    village.buildGeometry(device, houseVertices, houseIndices, state, recorder);
+    device.setMaxTextureSize(quality.maxTextureSize);
+
+    // --- Baked ambient occlusion for the terrain, tree and houses; cached in ao_cache.bin ---
+    {
+        OcclusionBaker baker;
+        uint64_t groundKey = proceduralTerrain ? terrainSeed
+            : heightMap.levels.empty() ? 0 : OcclusionBaker::hashBytes(14695981039346656037ull, heightMap.levels[0].data(), heightMap.levels[0].size());
+        baker.setGround([&terrainHeights](float x, float z) { return terrainHeights.height(x, z); }, groundKey);
+        baker.loadCache("ao_cache.bin");
+        mat4 treeModels[4] = { translate(mat4(1.0f), treePos) };
+        treeModels[1] = translate(treeModels[0], vec3(0, 5.0f, 0)); // Same offsets the tree is drawn with
+        treeModels[2] = translate(treeModels[1], vec3(0, 3.0f, 0));
+        treeModels[3] = translate(treeModels[2], vec3(0, 2.5f, 0));
+        Mesh* treeParts[4] = { &trunk, &branch1, &branch2, &branch3 };
+        for (int i = 0; i < 4; ++i)
+            baker.addOccluder(treeParts[i]->vertices.data(), treeParts[i]->vertices.size(), treeParts[i]->indices.data(), treeParts[i]->indices.size(), treeModels[i]);
+        village.addOccluders(baker);
+        baker.build();
 
-    std::vector<Target> targets;
-    for (int i = 0; i < 5; ++i) {
-        Target t;
-        float tx = i * 15.0f - 30.0f; float tz = i * 10.0f - 20.0f;
-        float ty = getTerrainHeight(tx, tz, heightMapImage, terrainScale, terrainHeightScale);
-        t.position = vec3(tx, ty + 2.0f, tz); t.body = houseBody; t.roof = houseRoof; targets.push_back(t);
+        village.bakeOcclusion(baker, device, recorder);
+        for (int i = 0; i < 4; ++i) {
+            std::vector<float> occlusion = baker.bakeMesh(treeParts[i]->vertices.data(), treeParts[i]->vertices.size(), treeModels[i], recorder);
+            device.attachOcclusion(treeParts[i]->gpu, occlusion.data(), occlusion.size());
+        }
+        if (!proceduralTerrain) {
+            // Displaced on the GPU, so the points and slope normals come from the heights here
+            std::vector<vec3> positions, normals;
+            for (size_t v = 0; v + 14 <= terrain.vertices.size(); v += 14) {
+                float x = terrain.vertices[v] * terrainHeights.scale, z = terrain.vertices[v + 2] * terrainHeights.scale;
+                float step = terrainHeights.scale;
+                positions.push_back(vec3(x, terrainHeights.height(x, z), z));
+                normals.push_back(normalize(vec3(terrainHeights.height(x - step, z) - terrainHeights.height(x + step, z), 2.0f * step,
+                    terrainHeights.height(x, z - step) - terrainHeights.height(x, z + step))));
+            }
+            std::vector<float> occlusion = baker.bake(positions, normals, recorder);
+            device.attachOcclusion(terrain.gpu, occlusion.data(), occlusion.size());
+        }
+        baker.saveCache();
+        char line[160];
+        snprintf(line, sizeof(line), "Ambient occlusion: %d vertices baked in %.0f ms, %d from cache, %d occluder triangles",
+            baker.bakedVertices(), baker.bakeTimeMs(), baker.cachedVertices(), baker.triangleCount());
+        events.info(line);
     }
 
-    std::vector<Parcel> parcels;
+    // --- Snapshots: hold R to rewind, F5/F9 quicksave/quickload ---
+    SnapshotHistory history;
+    GameState quickSave = state;
+    const char* quickSavePath = "quicksave.bin";
+    MemoryTracker::instance().add(MemTag::GameState, sizeof(GameState) * 3); // Live state, quicksave, history's previous tick
+
+    NetServer server;
+    NetClient client;
+    if (netMode == NetMode::Host && !server.start(netPort)) {
+        events.error("Could not bind UDP port " + std::to_string(netPort) + ", running offline");
+        netMode = NetMode::Offline;
+    }
+    if (netMode == NetMode::Client && !client.connect(sf::IpAddress(connectAddress), netPort)) {
+        events.error("Could not open a UDP socket, running offline");
+        netMode = NetMode::Offline;
+        state.airships[0].active = true;
+    }
+    sf::Clock runClock;
+    // --- Latency: F3 toggles low-latency pacing (late input sampling, one frame in flight) ---
+    FramePacer pacer(runClock);
+    pacer.setTargetFps(60.0f);
+    LatencyTracker latency(runClock);
+    latency.start();
+    bool dropRequested = false;
+    bool pickRequested = false;
+    int pickX = 0, pickY = 0;
+    vec3 lastAirshipPos = state.airships[0].position;
     bool aimMode = false;
+    bool showInset = true; // V: the other camera in a corner, drawn from the main view's command lists
     vec3 cameraPos; vec3 cameraFront; vec3 cameraUp;
+    // Set over the control socket: held buttons, and a fixed camera instead of the chase/aim one
+    uint8_t controlButtons = 0;
+    bool fixedCamera = false;
+    vec3 fixedCameraPos, fixedCameraTarget;
+    MetricsSnapshot controlStats = {}; // Last finished frame, for stats queries
+    vec3 insetPos; vec3 insetFront; vec3 insetUp;
+    ViewSet views; // Main view, then the inset when shown
     vec3 lightDir = normalize(vec3(-0.5f, -1.0f, -0.5f));
-    int score = 0; sf::Clock clock;
+    sf::Clock clock;
+    int statFrames = 0; float statTime = 0.0f, statMaxDt = 0.0f;
+    uint64_t statFrameAllocs = 0;
+    unsigned long long totalFrames = 0, hitches = 0;
+    float avgFrameMs = 0.0f, lastSecondMaxMs = 0.0f;
+    const float hitchThresholdMs = 2.0f * 1000.0f / 60.0f; // Two missed frames at the 60 Hz limit
+    logMemoryUsage(events);
+
+    // --- Scene partitions, each recorded into its own command list; F2 toggles worker threads ---
+    enum ScenePartition { PartitionStatic, PartitionAirships, PartitionTargets, PartitionParcels, PartitionCount };
+    CommandList partitionLists[PartitionCount];
+    for (CommandList& list : partitionLists) list.reserve(1024);
+    bool parallelRecording = true;
+
+    // --- Frame graph: declared again when its shape changes, executed every frame; F6 dumps it ---
+    enum FramePass { PassScene, PassOcclusion, PassInset, PassResolve, PassInsetComposite, PassOverlay };
+    RenderGraph frameGraph;
+    int sceneColor = -1, insetColor = -1;
+    int graphWidth = 0, graphHeight = 0, graphSamples = -1, insetSize = 0;
+    bool graphOverlay = false, graphInset = false;
+    int insetDraws = 0; float insetSubmitMs = 0.0f;
+
+    // Landings and hits are heard from the state's event ring; on clients the server fills it
+    uint32_t eventsHeard = state.eventCount;
+
+    int stressFrame = 0;
+    sf::Clock stressClock;
+    if (stress) {
+        window.setFramerateLimit(0);
+        window.setVerticalSyncEnabled(false);
+        lod.setEnabled(false); // Reports raw scaling; F8 turns it back on to see the controller hold the target
+    }
+    else if (!qualityConfigured) {
+        // Frame times need the limiter off; texture size only follows from the next launch
+        events.info("No quality.cfg, benchmarking quality tiers");
+        qualityBenchmark.start(12.5f);
+        quality = qualityPreset(qualityBenchmark.currentTier());
+        window.setFramerateLimit(0);
+    }
 
     while (window.isOpen()) {
+        if (lowLatency) pacer.waitForFrameStart();
+        sf::Clock frameWorkClock;
+        // Scripted commands, applied here between ticks
+        control.poll([&](const ControlCommand& command, char* reply, size_t replySize) {
+            bool simulated = netMode != NetMode::Client && !stress; // Otherwise the host or the stress flight owns the state
+            vec3 at = netMode == NetMode::Host ? glm::clamp(command.position, -netWorldHalfExtent, netWorldHalfExtent) : command.position;
+            switch (command.op) {
+            case ControlOp::Hold: controlButtons = command.buttons; break;
+            case ControlOp::Drop: dropRequested = true; break;
+            case ControlOp::Spawn:
+                if (!simulated) snprintf(reply, replySize, "error the simulation is not local");
+                else if (state.spawnParcel(at)) events.spawn(state.parcelCount, state.activeParcels());
+                else snprintf(reply, replySize, "error parcel limit reached");
+                break;
+            case ControlOp::Aim: aimMode = command.aim < 0 ? !aimMode : command.aim == 1; break;
+            case ControlOp::Teleport:
+                if (!simulated) snprintf(reply, replySize, "error the simulation is not local");
+                else state.airships[0].position = lastAirshipPos = at;
+                break;
+            case ControlOp::Camera: fixedCamera = true; fixedCameraPos = command.position; fixedCameraTarget = command.target; break;
+            case ControlOp::CameraFollow: fixedCamera = false; break;
+            case ControlOp::Stats:
+                snprintf(reply, replySize, "frame %llu ms %.2f avg %.2f max %.2f draws %d tris %d parcels %d/%d targets %d/%d score %d latency %.1f",
+                    controlStats.frames, controlStats.frameMs, controlStats.avgFrameMs, controlStats.maxFrameMs, controlStats.drawCalls, controlStats.triangles,
+                    controlStats.parcelsActive, controlStats.parcelsTotal, controlStats.targetsActive, state.targetCount,
+                    controlStats.score, controlStats.inputLatencyMs);
+                break;
+            case ControlOp::Score:
+                snprintf(reply, replySize, "score %d targets %d/%d", state.score, state.activeTargets(), state.targetCount);
+                break;
+            }
+        });
+        FrameAllocationGuard::begin();
+        renderStats() = RenderStats();
+        if (glCapture.installed() && (captureRequested || framesRendered == captureAtFrame)) {
+            glCapture.beginFrame((int)window.getSize().x, (int)window.getSize().y);
+            captureRequested = false;
+        }
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) window.close();
+            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                pickRequested = true;
+                pickX = event.mouseButton.x; pickY = event.mouseButton.y;
+            }
             if (event.type == sf::Event::KeyPressed) {
                 if (event.key.code == sf::Keyboard::C) aimMode = !aimMode;
-                if (event.key.code == sf::Keyboard::P) {
-                    Parcel p; p.position = airshipPos + vec3(0, -4.0f, 0); p.mesh = parcelMesh; parcels.push_back(p);
+                if (event.key.code == sf::Keyboard::V) showInset = !showInset;
+                if (event.key.code == sf::Keyboard::F1) showOverlay = !showOverlay;
+                if (event.key.code == sf::Keyboard::F2) parallelRecording = !parallelRecording;
+                if (event.key.code == sf::Keyboard::F3) {
+                    lowLatency = !lowLatency;
+                    window.setFramerateLimit(lowLatency || qualityBenchmark.running() ? 0 : 60);
+                }
+                if (event.key.code == sf::Keyboard::F4 && !qualityBenchmark.running()) {
+                    qualityTier = (QualityTier)(((int)qualityTier + 1) % (int)QualityTier::Count);
+                    quality = qualityPreset(qualityTier);
+                    saveQualityTier(qualityPath, qualityTier);
+                    events.info(std::string("Quality: ") + quality.name);
+                    lod.reset();
+                }
+                if (event.key.code == sf::Keyboard::F8) {
+                    lod.setEnabled(!lod.isEnabled());
+                    events.info(lod.isEnabled() ? "LOD budget on" : "LOD budget off");
+                }
+                if (event.key.code == sf::Keyboard::F6) logLines(events, LogLevel::Info, frameGraph.dump());
+                if (event.key.code == sf::Keyboard::F7) {
+                    if (glCapture.installed()) captureRequested = true;
+                    else events.warning("Frame capture needs --capture at launch");
+                }
+                if (event.key.code == sf::Keyboard::P) dropRequested = true;
+                if (event.key.code == sf::Keyboard::F5 && netMode == NetMode::Offline) {
+                    quickSave = state;
+                    if (!quickSave.saveToFile(quickSavePath)) events.warning("Could not write " + std::string(quickSavePath));
+                }
+                if (event.key.code == sf::Keyboard::F9 && netMode == NetMode::Offline) {
+                    if (!state.loadFromFile(quickSavePath)) {
+                        events.warning(std::string("No usable quicksave in ") + quickSavePath + " (missing, damaged or from another build); using this session's");
+                        state = quickSave;
+                    }
+                    eventsHeard = state.eventCount; // Not the loaded past's sounds
                 }
             }
         }
-        float dt = clock.restart().asSeconds();
+        float frameSeconds = clock.restart().asSeconds();
+        float dt = frameSeconds;
+        if (stress) dt = StressScene::step; // A fixed step replays the same stress frames on every run
+
+        float now = runClock.getElapsedTime().asSeconds();
 
         // --- Controls ---
-        float speed = 15.0f;
-        vec3 forward = vec3(0, 0, -1); vec3 right = normalize(cross(forward, vec3(0, 1, 0)));
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) airshipPos += forward * speed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) airshipPos -= forward * speed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) airshipPos += right * speed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) airshipPos -= right * speed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) airshipPos.y += speed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) airshipPos.y -= speed * dt;
+        uint8_t buttons = 0;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) buttons |= InputForward;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) buttons |= InputBack;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) buttons |= InputRight;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) buttons |= InputLeft;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) buttons |= InputUp;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) buttons |= InputDown;
+        if (dropRequested) { buttons |= InputDrop; dropRequested = false; }
+        buttons |= controlButtons;
+        if (stress) buttons = 0;
+        latency.inputSampled();
 
         // --- Updates ---
-        for (auto& p : parcels) {
-            if (!p.active) continue;
-            p.position += p.velocity * dt;
-            float terrainH = getTerrainHeight(p.position.x, p.position.z, heightMapImage, terrainScale, terrainHeightScale);
-            if (p.position.y <= terrainH) { p.active = false; continue; }
-            for (auto& t : targets) {
-                if (!t.active) continue;
-                if (distance(p.position, t.position) < p.radius + t.radius) {
-                    t.active = false; p.active = false; score++; std::cout << "HIT! Score: " << score << std::endl; break;
-                }
-            }
+        bool rewinding = netMode == NetMode::Offline && !stress && sf::Keyboard::isKeyPressed(sf::Keyboard::R);
+        if (netMode == NetMode::Client) {
+            // The host owns the simulation; predict our airship and interpolate the rest
+            client.receive(dt);
+            client.sendInput(buttons, dt);
+            client.apply(state, dt);
         }
-
-        // --- Camera ---
-        if (aimMode) {
-            cameraPos = airshipPos + vec3(0, -6.0f, 0); cameraFront = vec3(0.0f, -1.0f, 0.0f); cameraUp = vec3(0.0f, 0.0f, -1.0f);
+        else if (rewinding) {
+            history.rewind(state);
         }
         else {
-            cameraPos = airshipPos + vec3(0, 10.0f, 20.0f); cameraFront = normalize(airshipPos - cameraPos); cameraUp = vec3(0.0f, 1.0f, 0.0f);
+            if (netMode == NetMode::Host) server.receive(state, now);
+            if (stress) stress->update(state, stressFrame, [&terrainHeights](float x, float z) { return terrainHeights.height(x, z); });
+            else moveAirship(state.airships[0].position, buttons, dt, netMode == NetMode::Host ? netWorldHalfExtent : 0.0f);
+            if (buttons & InputDrop) {
+                if (state.spawnParcel(state.airships[0].position + vec3(0, -4.0f, 0))) events.spawn(state.parcelCount, state.activeParcels());
+                else events.warning("Parcel limit reached");
+            }
+            updateParcels(state, dt, terrainHeights, entities);
+            if (netMode == NetMode::Host) server.update(state, dt, now);
+            else history.record(state);
+        }
+        int localPlayer = netMode == NetMode::Client ? client.localId() : 0;
+        vec3 airshipPos = state.airships[localPlayer].position;
+        vec3 airshipVelocity = dt > 0.0f ? (airshipPos - lastAirshipPos) / dt : vec3(0.0f);
+        lastAirshipPos = airshipPos;
+
+        // --- Camera: chase or aim (C) full screen, the other one in the inset ---
+        vec3 aimPos = airshipPos + vec3(0, -6.0f, 0), aimFront(0.0f, -1.0f, 0.0f), aimUp(0.0f, 0.0f, -1.0f);
+        vec3 chasePos = airshipPos + vec3(0, 10.0f, 20.0f), chaseFront = normalize(airshipPos - chasePos), chaseUp(0.0f, 1.0f, 0.0f);
+        cameraPos = aimMode ? aimPos : chasePos; cameraFront = aimMode ? aimFront : chaseFront; cameraUp = aimMode ? aimUp : chaseUp;
+        insetPos = aimMode ? chasePos : aimPos; insetFront = aimMode ? chaseFront : aimFront; insetUp = aimMode ? chaseUp : aimUp;
+        if (fixedCamera) {
+            cameraPos = fixedCameraPos; cameraFront = normalize(fixedCameraTarget - fixedCameraPos);
+            cameraUp = abs(cameraFront.y) > 0.99f ? vec3(0.0f, 0.0f, -1.0f) : vec3(0.0f, 1.0f, 0.0f);
         }
         mat4 view = lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-        mat4 projection = perspective(radians(60.0f), 800.0f / 600.0f, 0.1f, 1000.0f);
-        mat4 model;
 
-        glClearColor(0.5f, 0.7f, 1.0f, 1.0f); glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        shader.use(); shader.setMat4("view", view); shader.setMat4("projection", projection); shader.setVec3("lightDir", lightDir); shader.setVec3("viewPos", cameraPos);
+        // --- Audio ---
+        for (int i = 0; i < GameState::maxAirships; ++i)
+            if (state.airships[i].active) audio.loop(SoundId::EngineHum, i, state.airships[i].position);
+        for (int i = 0; i < state.parcelCount; ++i)
+            if (state.parcels[i].active) audio.loop(SoundId::ParcelWhoosh, state.parcels[i].id, state.parcels[i].position);
+        if (eventsHeard > state.eventCount) eventsHeard = state.eventCount; // Rewound
+        if (state.eventCount - eventsHeard > (uint32_t)GameState::maxEvents) eventsHeard = state.eventCount - GameState::maxEvents;
+        for (; eventsHeard < state.eventCount; ++eventsHeard) {
+            const GameEvent& e = state.events[eventsHeard % GameState::maxEvents];
+            if (e.sequence != eventsHeard) continue; // Never received
+            if (e.kind == GameEventKind::ParcelLanded) audio.play(SoundId::ImpactThud, e.position);
+            else if (e.kind == GameEventKind::TargetHit) audio.play(SoundId::HitChime, e.position);
+        }
+        village.syncVisibility(state, device);
+        entities.sync(state); // Airships moved and the state may have been replaced since the last tick
+        audio.update(cameraPos, cameraFront, dt);
+        // The far plane is the draw distance, so the frustum culls exactly where the fog turns opaque
+        int windowWidth = max(1, (int)window.getSize().x), windowHeight = max(1, (int)window.getSize().y);
+        mat4 projection = perspective(radians(60.0f), (float)windowWidth / windowHeight, 0.1f, quality.drawDistance);
+        // Both views are culled in one pass over the scene and share the command lists
+        mat4 insetView = lookAt(insetPos, insetPos + insetFront, insetUp);
+        mat4 insetProjection = perspective(radians(60.0f), 1.0f, 0.1f, quality.drawDistance);
+        views.clear();
+        views.add(Frustum(projection * view));
+        if (showInset) views.add(Frustum(insetProjection * insetView));
+        if (pickRequested) {
+            pickRequested = false;
+            vec2 ndc(2.0f * pickX / windowWidth - 1.0f, 1.0f - 2.0f * pickY / windowHeight);
+            mat4 inverseViewProjection = inverse(projection * view);
+            vec4 nearPoint = inverseViewProjection * vec4(ndc.x, ndc.y, -1.0f, 1.0f), farPoint = inverseViewProjection * vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+            vec3 rayStart = vec3(nearPoint) / nearPoint.w, rayEnd = vec3(farPoint) / farPoint.w;
+            EntityKind kind; int index; float pickDistance;
+            if (entities.pick(state, rayStart, normalize(rayEnd - rayStart), length(rayEnd - rayStart), kind, index, pickDistance)) {
+                const char* kindNames[] = { "airship", "parcel", "house" };
+                char line[96];
+                snprintf(line, sizeof(line), "Picked %s %d at %.1f units", kindNames[(int)kind], index, pickDistance);
+                events.info(line);
+            }
+        }
+        if (procedural.streaming()) procedural.update(cameraPos, airshipVelocity, quality.drawDistance);
 
-        // --- Drawing ---
-        // Terrain
-        model = mat4(1.0f); model = scale(model, vec3(terrainScale, 1.0f, terrainScale));
-        shader.setMat4("model", model); shader.setInt("isTerrain", 1);
-        glActiveTexture(GL_TEXTURE2); glBindTexture(GL_TEXTURE_2D, heightMapTex); shader.setInt("heightMap", 2);
-        terrain.draw(shader); shader.setInt("isTerrain", 0);
-
-        // Tree Base
-        model = translate(mat4(1.0f), treePos); shader.setMat4("model", model); trunk.draw(shader);
-        mat4 branchModel = translate(model, vec3(0, 5.0f, 0)); shader.setMat4("model", branchModel); branch1.draw(shader);
-        branchModel = translate(branchModel, vec3(0, 3.0f, 0)); shader.setMat4("model", branchModel); branch2.draw(shader);
-        branchModel = translate(branchModel, vec3(0, 2.5f, 0)); shader.setMat4("model", branchModel); branch3.draw(shader);
-
-        // NEW: Draw Decorations
-        for (const auto& deco : treeDecorations) {
-            // Position relative to tree base
-            model = translate(mat4(1.0f), treePos + deco.relativePos);
-            shader.setMat4("model", model);
-            deco.mesh.draw(shader);
-        }
-
-        // Airship
-        model = translate(mat4(1.0f), airshipPos); mat4 balloonModel = rotate(model, radians(90.0f), vec3(0, 1, 0));
-        shader.setMat4("model", balloonModel); balloon.draw(shader);
-        mat4 gondolaModel = translate(model, vec3(0, -3.0f, 0)); shader.setMat4("model", gondolaModel); gondola.draw(shader);
-
-        // Targets
-        for (const auto& t : targets) {
-            if (!t.active) continue;
-            model = translate(mat4(1.0f), t.position); shader.setMat4("model", model); t.body.draw(shader);
-            mat4 roofModel = translate(model, vec3(0, 2.0f, 0)); roofModel = rotate(roofModel, radians(45.0f), vec3(0, 1, 0));
-            shader.setMat4("model", roofModel); t.roof.draw(shader);
-        }
-        // Parcels
-        for (const auto& p : parcels) {
-            if (!p.active) continue;
-            model = translate(mat4(1.0f), p.position); shader.setMat4("model", model); p.mesh.draw(shader);
+        if (windowWidth != graphWidth || windowHeight != graphHeight || quality.msaaSamples != graphSamples || showOverlay != graphOverlay || showInset != graphInset) {
+            graphWidth = windowWidth; graphHeight = windowHeight; graphSamples = quality.msaaSamples; graphOverlay = showOverlay; graphInset = showInset;
+            insetSize = max(64, min(graphWidth, graphHeight) / 3);
+            frameGraph.clear();
+            // No two transients here can alias today: the scene and inset targets differ in size
+            // and the scene pair lives for the whole frame. --test-graph covers the aliasing path.
+            // MSAA is a property of the scene targets, so the tier can change it at runtime
+            sceneColor = frameGraph.createTexture("scene_color", RGFormat::RGBA8, graphWidth, graphHeight, graphSamples);
+            int sceneDepth = frameGraph.createTexture("scene_depth", RGFormat::Depth24Stencil8, graphWidth, graphHeight, graphSamples);
+            int backbuffer = frameGraph.importBackbuffer("backbuffer", graphWidth, graphHeight);
+            int scenePass = frameGraph.addPass("scene", PassScene);
+            frameGraph.write(scenePass, sceneColor); frameGraph.write(scenePass, sceneDepth);
+            int occlusionPass = frameGraph.addPass("occlusion_queries", PassOcclusion, true);
+            frameGraph.write(occlusionPass, sceneDepth);
+            // The inset is small, so it skips MSAA
+            if (showInset) {
+                insetColor = frameGraph.createTexture("inset_color", RGFormat::RGBA8, insetSize, insetSize, 0);
+                int insetDepth = frameGraph.createTexture("inset_depth", RGFormat::Depth24Stencil8, insetSize, insetSize, 0);
+                int insetPass = frameGraph.addPass("inset_view", PassInset);
+                frameGraph.write(insetPass, insetColor); frameGraph.write(insetPass, insetDepth);
+            }
+            int resolvePass = frameGraph.addPass("resolve", PassResolve);
+            frameGraph.read(resolvePass, sceneColor); frameGraph.write(resolvePass, backbuffer);
+            if (showInset) {
+                int compositePass = frameGraph.addPass("inset_composite", PassInsetComposite);
+                frameGraph.read(compositePass, insetColor); frameGraph.write(compositePass, backbuffer);
+            }
+            if (showOverlay) frameGraph.write(frameGraph.addPass("overlay", PassOverlay), backbuffer);
+            frameGraph.compile();
         }
+        shader.use(); shader.setMat4("view", view); shader.setMat4("projection", projection); shader.setVec3("lightDir", lightDir); shader.setVec3("viewPos", cameraPos);
+        shader.setVec3("fogColor", fogColor); shader.setFloat("fogDensity", fogDensityFor(quality.drawDistance)); shader.setFloat("lodBias", quality.lodBias + lod.extraBias());
+        const float detailDistance = lod.detailDistance(quality.drawDistance);
+
+        // --- Recording (read-only access to the scene) ---
+        const int pipeline = shader.pipeline;
+        occlusion.beginFrame();
+        auto recordPartition = [&](int partition) {
+            CommandList& list = partitionLists[partition];
+            list.clear();
+            mat4 model;
+            switch (partition) {
+            case PartitionStatic: {
+                // Terrain
+                if (procedural.streaming()) procedural.record(list, pipeline, grassTex, views);
+                else {
+                    model = scale(mat4(1.0f), vec3(terrainHeights.scale, 1.0f, terrainHeights.scale));
+                    terrain.record(list, pipeline, model, heightMapTex, DrawTerrain); list.visible++;
+                }
 
+                // Trees (the lowest cone is 6 wide, the star tops out near 15); the occlusion
+                // culler has room for the first few, the rest of a stress scene draws unconditionally
+                for (size_t t = 0; t < trees.size(); ++t) {
+                    const vec3& treePos = trees[t];
+                    vec3 treeLo = treePos + vec3(-6.0f, 0.0f, -6.0f), treeHi = treePos + vec3(6.0f, 15.5f, 6.0f);
+                    int occlusionId = treeOcclusionId + (int)t;
+                    if (occlusionId < OcclusionCuller::maxObjects && views.frustums[0].containsBox(treeLo, treeHi))
+                        list.beginCondition(occlusion.object(occlusionId, treeLo, treeHi, cameraPos));
+                    model = translate(mat4(1.0f), treePos); recordMesh(list, pipeline, trunk, model, views);
+                    mat4 branchModel = translate(model, vec3(0, 5.0f, 0)); recordMesh(list, pipeline, branch1, branchModel, views);
+                    branchModel = translate(branchModel, vec3(0, 3.0f, 0)); recordMesh(list, pipeline, branch2, branchModel, views);
+                    branchModel = translate(branchModel, vec3(0, 2.5f, 0)); recordMesh(list, pipeline, branch3, branchModel, views);
+
+                    // NEW: Draw Decorations
+                    if (length(treePos - cameraPos) <= detailDistance) for (const auto& deco : treeDecorations) {
+                        // Position relative to tree base
+                        model = translate(mat4(1.0f), treePos + deco.relativePos);
+                        recordMesh(list, pipeline, deco.mesh, model, views);
+                    }
+                    list.endCondition();
+                }
+                break;
+            }
+            case PartitionAirships:
+                entities.visible(views, EntityKind::Airship, [&](int i, uint8_t) {
+                    model = translate(mat4(1.0f), state.airships[i].position); mat4 balloonModel = rotate(model, radians(90.0f), vec3(0, 1, 0));
+                    recordMesh(list, pipeline, balloon, balloonModel, views);
+                    if (length(state.airships[i].position - cameraPos) > detailDistance) return;
+                    mat4 gondolaModel = translate(model, vec3(0, -3.0f, 0)); recordMesh(list, pipeline, gondola, gondolaModel, views);
+                });
+                break;
+            case PartitionTargets:
+                // One draw per village block; destroyed houses are masked out in the vertex shader
+                for (int b = 0; b < village.blockCount(); ++b) {
+                    const VillageBlock& block = village.block(b);
+                    if (block.standing == 0) continue;
+                    uint8_t mask = views.boxMask(block.lo, block.hi);
+                    if (!mask) { list.culled++; continue; }
+                    list.visible++;
+                    list.beginViews(mask);
+                    if (mask & 1) list.beginCondition(occlusion.object(b, block.lo, block.hi, cameraPos));
+                    list.drawMasked(pipeline, block.mesh, mat4(1.0f), houseTex, village.visibilityTexture(), block.firstHouse, village.verticesPerHouse());
+                    list.endCondition();
+                    list.endViews();
+                }
+                break;
+            case PartitionParcels:
+                entities.visible(views, EntityKind::Parcel, [&](int i, uint8_t) {
+                    model = translate(mat4(1.0f), state.parcels[i].position); recordMesh(list, pipeline, parcelMesh, model, views);
+                });
+                break;
+            }
+            list.sort();
+        };
+        sf::Clock renderClock;
+        recorder.run(recordPartition, PartitionCount, parallelRecording);
+        renderStats().recordMs = renderClock.restart().asMicroseconds() / 1000.0f;
+
+        // --- Submission (render thread only), pass by pass in frame graph order ---
+        int activeParcels = state.activeParcels(), activeTargets = state.activeTargets();
+        RenderStats sceneStats;
+        overlay.pushFrameTime(frameSeconds * 1000.0f);
+        auto runPass = [&](int pass) {
+            switch (pass) {
+            case PassScene:
+                glClearColor(fogColor.x, fogColor.y, fogColor.z, 1.0f); glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                for (const CommandList& list : partitionLists) device.submit(list);
+                break;
+            case PassOcclusion:
+                occlusion.issueQueries(projection * view);
+                renderStats().submitMs = renderClock.getElapsedTime().asMicroseconds() / 1000.0f;
+                sceneStats = renderStats(); // Captured before the overlay adds its own draw
+                break;
+            case PassInset: {
+                // Same sorted lists and per-draw data; only the camera uniforms change
+                sf::Clock insetClock;
+                int drawsBefore = renderStats().drawCalls;
+                shader.use(); shader.setMat4("view", insetView); shader.setMat4("projection", insetProjection); shader.setVec3("viewPos", insetPos);
+                glClearColor(fogColor.x, fogColor.y, fogColor.z, 1.0f); glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                for (const CommandList& list : partitionLists) device.submit(list, 1);
+                insetDraws = renderStats().drawCalls - drawsBefore;
+                insetSubmitMs = insetClock.getElapsedTime().asMicroseconds() / 1000.0f;
+                break;
+            }
+            case PassResolve:
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, frameGraph.readFramebuffer(sceneColor));
+                glBlitFramebuffer(0, 0, graphWidth, graphHeight, 0, 0, graphWidth, graphHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                break;
+            case PassInsetComposite: {
+                // Top right, clear of the stats overlay
+                int x1 = graphWidth - 10, y1 = graphHeight - 10;
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, frameGraph.readFramebuffer(insetColor));
+                glBlitFramebuffer(0, 0, insetSize, insetSize, x1 - insetSize, y1 - insetSize, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                break;
+            }
+            case PassOverlay: {
+                char line[96];
+                float x = 10.0f, y = 10.0f;
+                overlay.begin();
+                int lines = (netMode == NetMode::Offline ? 15 : 16) + (procedural.streaming() ? 1 : 0) + (showInset ? 1 : 0);
+                overlay.rect(0.0f, 0.0f, 290.0f, lines * StatsOverlay::lineHeight + 70.0f, 0x00000080);
+                snprintf(line, sizeof(line), "FPS %.0f  %.2f MS", avgFrameMs > 0.0f ? 1000.0f / avgFrameMs : 0.0f, avgFrameMs);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), "DRAWS %d", sceneStats.drawCalls);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), "TRIS %d", sceneStats.triangles);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), "STATE CHANGES %d", sceneStats.stateChanges);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), "VISIBLE %d  CULLED %d", sceneStats.visible, sceneStats.culled);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), "OCCL %d TESTS  %d HIDDEN  %d COND", occlusion.testsIssued(), occlusion.knownHidden(), sceneStats.conditionalDraws);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), "REC %.2f  SUBMIT %.2f MS %s", sceneStats.recordMs, sceneStats.submitMs, parallelRecording ? "MT" : "ST");
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                if (showInset) {
+                    snprintf(line, sizeof(line), "INSET %d DRAWS  SUBMIT %.2f MS", insetDraws, insetSubmitMs);
+                    overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                }
+                snprintf(line, sizeof(line), "AUDIO %d REAL %d VIRT %.2f MS", audio.realVoices(), audio.virtualVoices(), audio.updateMs());
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), "INPUT LAT %.1f MS  MAX %.1f%s", latency.averageMs(), latency.maxMs(), lowLatency ? "  LOW" : "");
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                if (qualityBenchmark.running()) snprintf(line, sizeof(line), "QUALITY BENCHMARK %s", quality.name);
+                else snprintf(line, sizeof(line), "QUALITY %s  DIST %.0f  MSAA %d", quality.name, quality.drawDistance, frameGraph.samples(sceneColor));
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                if (lod.isEnabled()) {
+                    snprintf(line, sizeof(line), "LOD +%.2f  DETAIL %.0f  CPU %.2f GPU %.2f MS", lod.extraBias(), detailDistance, lod.cpuMs(), lod.gpuMs());
+                    overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                }
+                snprintf(line, sizeof(line), "GRAPH %d PASSES  %d CULLED  %.1f MB", frameGraph.livePasses(), frameGraph.culledPasses(), frameGraph.transientBytes() / 1048576.0f);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                if (procedural.streaming()) {
+                    snprintf(line, sizeof(line), "TERRAIN %d TILES  %d MISSING  %.2f MS/TILE", procedural.residentTiles(), procedural.missingTiles(), procedural.generateMs());
+                    overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                }
+                snprintf(line, sizeof(line), "PARCELS %d / %d", activeParcels, state.parcelCount);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), "TARGETS %d / %d", activeTargets, state.targetCount);
+                overlay.text(x, y, line, 0xFFFFFFFF); y += StatsOverlay::lineHeight;
+                snprintf(line, sizeof(line), rewinding ? "SCORE %d  REWIND" : "SCORE %d", state.score);
+                overlay.text(x, y, line, 0xFFD040FF); y += StatsOverlay::lineHeight;
+                if (netMode == NetMode::Host) {
+                    snprintf(line, sizeof(line), "HOST %d CL  %.1f KB/S/CL  %.2f MS", server.clientCount(), server.sendBytesPerClient() / 1024.0f, server.lastTickMs());
+                    overlay.text(x, y, line, 0x80C0FFFF); y += StatsOverlay::lineHeight;
+                }
+                else if (netMode == NetMode::Client) {
+                    snprintf(line, sizeof(line), client.connected() ? "CLIENT ID %d  RX %.1f KB/S" : "CONNECTING...", client.localId(), client.receiveBytesPerSecond() / 1024.0f);
+                    overlay.text(x, y, line, 0x80C0FFFF); y += StatsOverlay::lineHeight;
+                }
+                overlay.text(x, y, "FRAME TIME (0-50 MS)", 0xC0C0C0FF); y += StatsOverlay::lineHeight;
+                overlay.frameGraph(x, y, 270.0f, 60.0f, 50.0f);
+                overlay.draw((int)window.getSize().x, (int)window.getSize().y);
+                break;
+            }
+            }
+        };
+        gpuTimer.begin();
+        frameGraph.execute(runPass);
+        gpuTimer.end();
+        // The benchmark measures tiers at full detail; the controller picks up from its choice
+        if (!qualityBenchmark.running())
+            lod.update(frameWorkClock.getElapsedTime().asMicroseconds() / 1000.0f, gpuTimer.poll(), sceneStats.drawCalls, sceneStats.triangles);
+
+        if (glCapture.capturingFrame()) {
+            char capturePath[64];
+            snprintf(capturePath, sizeof(capturePath), "capture_%d.glc", ++capturesWritten);
+            FrameAllocationGuard::Exempt exempt;
+            glCapture.endFrame(capturePath);
+        }
+        framesRendered++;
         window.display();
+        latency.framePresented();
+        if (stress) {
+            stress->frameDone(stressFrame, stressClock.restart().asMicroseconds() / 1000.0f, sceneStats);
+            if (++stressFrame >= stress->frames()) {
+                stress->report(state.targetCount);
+                window.close();
+            }
+        }
+        if (lowLatency) pacer.waitForGpu();
+        latency.poll();
+        if (qualityBenchmark.running()) {
+            glFinish(); // Count the GPU's share of the frame too
+            qualityBenchmark.frameDone(frameWorkClock.getElapsedTime().asMicroseconds() / 1000.0f);
+            if (qualityBenchmark.running()) quality = qualityPreset(qualityBenchmark.currentTier());
+            else {
+                qualityTier = qualityBenchmark.currentTier();
+                quality = qualityPreset(qualityTier);
+                saveQualityTier(qualityPath, qualityTier);
+                events.info(std::string("Quality: ") + quality.name + " selected by benchmark");
+                window.setFramerateLimit(lowLatency ? 0 : 60);
+            }
+        }
+        statFrameAllocs += FrameAllocationGuard::end();
+
+        // --- Metrics snapshot, published every frame ---
+        float frameMs = frameSeconds * 1000.0f;
+        totalFrames++;
+        if (frameMs > hitchThresholdMs && totalFrames > 1) hitches++;
+        avgFrameMs = totalFrames == 1 ? frameMs : mix(avgFrameMs, frameMs, 0.05f);
+        MetricsSnapshot& snap = metrics.snapshot();
+        snap.frames = totalFrames; snap.hitches = hitches;
+        snap.frameMs = frameMs; snap.avgFrameMs = avgFrameMs; snap.maxFrameMs = lastSecondMaxMs;
+        snap.drawCalls = sceneStats.drawCalls; snap.triangles = sceneStats.triangles;
+        snap.parcelsActive = activeParcels; snap.parcelsTotal = state.parcelCount;
+        snap.targetsActive = activeTargets; snap.score = state.score;
+        snap.inputLatencyMs = latency.averageMs(); snap.inputLatencyMaxMs = latency.maxMs();
+        snap.audioVoices = audio.realVoices(); snap.audioVirtualVoices = audio.virtualVoices(); snap.audioUpdateMs = audio.updateMs();
+        controlStats = snap;
+        metrics.publish();
+
+        // --- Frame stats, aggregated to one record per second ---
+        statFrames++; statTime += frameSeconds; statMaxDt = max(statMaxDt, frameSeconds);
+        if (statTime >= 1.0f) {
+            lastSecondMaxMs = statMaxDt * 1000.0f;
+            events.frameStats(statFrames, statTime * 1000.0f / statFrames, statMaxDt * 1000.0f, activeParcels, activeTargets);
+#ifdef _DEBUG
+            if (statFrameAllocs > 0) events.warning("Heap allocations in frame loop: " + std::to_string(statFrameAllocs) + " in " + std::to_string(statFrames) + " frames");
+#endif
+            statFrames = 0; statTime = 0.0f; statMaxDt = 0.0f; statFrameAllocs = 0;
+        }
     }
+    metrics.stop();
+    control.stop();
+    latency.stop();
+    device.savePipelineCache();
+    logMemoryUsage(events);
+    events.stop();
     return 0;
 }
\ No newline at end of file